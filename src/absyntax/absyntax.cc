@@ -41,6 +41,7 @@
 #include "absyntax.hh"
 //#include "../stage1_2/iec.hh" /* required for BOGUS_TOKEN_ID, etc... */
 #include "visitor.hh"
+#include "ast_preorder_index.hh"
 #include "../main.hh" // required for ERROR() and ERROR_MSG() macros.
 
 
@@ -66,7 +67,97 @@ symbol_c::symbol_c(
 
 
 
-token_c::token_c(const char *value, 
+/* The elementary and SAFE elementary data type classes, in the order of their bit in candidate_datatypes_c */
+static const matiec::ast_class_tag_t elementary_type_tags[] = {
+  matiec::ast_class_tag_t::time_type_name_c,     matiec::ast_class_tag_t::bool_type_name_c,
+  matiec::ast_class_tag_t::sint_type_name_c,     matiec::ast_class_tag_t::int_type_name_c,
+  matiec::ast_class_tag_t::dint_type_name_c,     matiec::ast_class_tag_t::lint_type_name_c,
+  matiec::ast_class_tag_t::usint_type_name_c,    matiec::ast_class_tag_t::uint_type_name_c,
+  matiec::ast_class_tag_t::udint_type_name_c,    matiec::ast_class_tag_t::ulint_type_name_c,
+  matiec::ast_class_tag_t::real_type_name_c,     matiec::ast_class_tag_t::lreal_type_name_c,
+  matiec::ast_class_tag_t::date_type_name_c,     matiec::ast_class_tag_t::tod_type_name_c,
+  matiec::ast_class_tag_t::dt_type_name_c,       matiec::ast_class_tag_t::byte_type_name_c,
+  matiec::ast_class_tag_t::word_type_name_c,     matiec::ast_class_tag_t::dword_type_name_c,
+  matiec::ast_class_tag_t::lword_type_name_c,    matiec::ast_class_tag_t::string_type_name_c,
+  matiec::ast_class_tag_t::wstring_type_name_c,
+  matiec::ast_class_tag_t::safetime_type_name_c, matiec::ast_class_tag_t::safebool_type_name_c,
+  matiec::ast_class_tag_t::safesint_type_name_c, matiec::ast_class_tag_t::safeint_type_name_c,
+  matiec::ast_class_tag_t::safedint_type_name_c, matiec::ast_class_tag_t::safelint_type_name_c,
+  matiec::ast_class_tag_t::safeusint_type_name_c,matiec::ast_class_tag_t::safeuint_type_name_c,
+  matiec::ast_class_tag_t::safeudint_type_name_c,matiec::ast_class_tag_t::safeulint_type_name_c,
+  matiec::ast_class_tag_t::safereal_type_name_c, matiec::ast_class_tag_t::safelreal_type_name_c,
+  matiec::ast_class_tag_t::safedate_type_name_c, matiec::ast_class_tag_t::safetod_type_name_c,
+  matiec::ast_class_tag_t::safedt_type_name_c,   matiec::ast_class_tag_t::safebyte_type_name_c,
+  matiec::ast_class_tag_t::safeword_type_name_c, matiec::ast_class_tag_t::safedword_type_name_c,
+  matiec::ast_class_tag_t::safelword_type_name_c,matiec::ast_class_tag_t::safestring_type_name_c,
+  matiec::ast_class_tag_t::safewstring_type_name_c,
+};
+
+static_assert(sizeof(elementary_type_tags) / sizeof(elementary_type_tags[0]) <= 8 * sizeof(candidate_datatypes_c::elementary_mask_t),
+              "too many elementary data types for candidate_datatypes_c::elementary_mask_t");
+
+
+int candidate_datatypes_c::elementary_bit(symbol_c *datatype) {
+  static const std::vector<int8_t> bit_of_tag = [] {
+    std::vector<int8_t> table(static_cast<size_t>(matiec::ast_class_tag_t::count_) + 1, -1);
+    for (size_t i = 0; i < sizeof(elementary_type_tags) / sizeof(elementary_type_tags[0]); i++)
+      table[static_cast<size_t>(elementary_type_tags[i])] = static_cast<int8_t>(i);
+    return table;
+  }();
+  /* NOTE: ast_class_tag(NULL) returns ast_class_tag_t::count_ */
+  return bit_of_tag[static_cast<size_t>(matiec::ast_class_tag(datatype))];
+}
+
+
+void candidate_datatypes_c::push_back(symbol_c *datatype) {
+  int bit = elementary_bit(datatype);
+  if (bit < 0) {
+    non_elementary_count_++;
+  } else {
+    if (has_elementary(bit)) repeated_elementary_ = true;
+    elementary_mask_ |= (elementary_mask_t)1 << bit;
+  }
+  list_.push_back(datatype);
+}
+
+
+candidate_datatypes_c::const_iterator candidate_datatypes_c::erase(const_iterator pos) {
+  int bit = elementary_bit(*pos);
+  const_iterator res = list_.erase(pos);
+  if (bit < 0)                   non_elementary_count_--;
+  else if (!repeated_elementary_) elementary_mask_ &= ~((elementary_mask_t)1 << bit);
+  else                           recompute_mask();
+  return res;
+}
+
+
+void candidate_datatypes_c::keep_elementary(elementary_mask_t mask) {
+  if (0 != non_elementary_count_) ERROR;
+  if ((elementary_mask_ & mask) == elementary_mask_) return; /* nothing to remove */
+  size_t kept = 0;
+  for (size_t i = 0; i < list_.size(); i++)
+    if ((mask >> elementary_bit(list_[i])) & 1)
+      list_[kept++] = list_[i];
+  list_.resize(kept);
+  elementary_mask_ &= mask;
+}
+
+
+void candidate_datatypes_c::recompute_mask(void) {
+  elementary_mask_ = 0;
+  non_elementary_count_ = 0;
+  repeated_elementary_ = false;
+  for (size_t i = 0; i < list_.size(); i++) {
+    int bit = elementary_bit(list_[i]);
+    if (bit < 0) {non_elementary_count_++; continue;}
+    if (has_elementary(bit)) repeated_elementary_ = true;
+    elementary_mask_ |= (elementary_mask_t)1 << bit;
+  }
+}
+
+
+
+token_c::token_c(const char *value,
                  int fl, int fc, const char *ffile, long int forder,
                  int ll, int lc, const char *lfile, long int lorder)
   :symbol_c(fl, fc, ffile, forder, ll, lc, lfile, lorder), value(value) {
@@ -158,7 +158,63 @@ class const_value_c {
 
     /* return true if at least one of the const values (int, real, ...) is a valid const value */
     bool is_const(void)
-      {return (m_int64.is_valid() || m_uint64.is_valid() || m_real64.is_valid() || m_bool.is_valid());}   
+      {return (m_int64.is_valid() || m_uint64.is_valid() || m_real64.is_valid() || m_bool.is_valid());}
+};
+
+
+
+/*** Data type analysis ***/
+/* The list of candidate data types of an expression/literal/etc., filled in during stage 3.
+ * The data types are kept in the order in which they were added, as that order is relevant
+ * to the datatype analysis algorithms (e.g. choice of overloaded function, error messages).
+ *
+ * In addition to the list itself, we keep a bit mask with one bit for each elementary and
+ * SAFE elementary data type class (int_type_name_c, safeint_type_name_c, ...) present in the
+ * list, and a count of all the other (i.e. derived, generic, ...) data types in the list.
+ * This allows the most common questions (Is INT a candidate? Do these two lists of
+ * elementary types intersect?) to be answered without comparing the data types one by one.
+ *
+ * Elements may only be added/removed through the methods below, so the mask remains valid.
+ */
+class candidate_datatypes_c {
+  public:
+    typedef std::vector<symbol_c *>::const_iterator const_iterator;
+    typedef const_iterator                          iterator;
+    typedef uint64_t                                elementary_mask_t;
+
+    /* The bit used for datatype (i.e. for its class), or -1 if it is not an elementary/SAFE elementary data type. */
+    static int elementary_bit(symbol_c *datatype);
+
+  private:
+    std::vector<symbol_c *> list_;
+    elementary_mask_t       elementary_mask_;
+    unsigned int            non_elementary_count_;
+    bool                    repeated_elementary_; /* has the same elementary class been added more than once? */
+
+    void recompute_mask(void);
+
+  public:
+    candidate_datatypes_c(void): elementary_mask_(0), non_elementary_count_(0), repeated_elementary_(false) {}
+
+    size_t         size    (void) const       {return list_.size();}
+    bool           empty   (void) const       {return list_.empty();}
+    size_t         capacity(void) const       {return list_.capacity();}
+    symbol_c      *operator[](size_t i) const {return list_[i];}
+    const_iterator begin   (void) const       {return list_.begin();}
+    const_iterator end     (void) const       {return list_.end();}
+
+    void           push_back(symbol_c *datatype);
+    const_iterator erase    (const_iterator pos);
+    void           clear    (void) {list_.clear(); elementary_mask_ = 0; non_elementary_count_ = 0; repeated_elementary_ = false;}
+
+    elementary_mask_t elementary_mask     (void) const {return elementary_mask_;}
+    unsigned int      non_elementary_count(void) const {return non_elementary_count_;}
+    bool              has_elementary(int bit)   const {return (bit >= 0) && ((elementary_mask_ >> bit) & 1);}
+
+    /* Keep only the elements whose elementary_bit() is set in mask.
+     * May only be called when the list contains only elementary data types.
+     */
+    void keep_elementary(elementary_mask_t mask);
 };
 
 namespace matiec {
@@ -182,6 +238,14 @@ public:
 
   bool is_null() const noexcept { return is_null_; }
 
+  /* Heap memory owned by the string (0 while it fits in the inline buffer). */
+  size_t heap_bytes() const noexcept {
+    const char* data = storage_.data();
+    const char* self = reinterpret_cast<const char*>(&storage_);
+    if (data >= self && data < self + sizeof(storage_)) return 0;
+    return storage_.capacity() + 1;
+  }
+
 private:
   void assign(const char* s) {
     if (!s) {
@@ -200,6 +264,7 @@ private:
 
 // A forward declaration
 class token_c;
+class ast_memory_accounting_c;
 
 /* The base class of all symbols */
 class symbol_c {
@@ -247,6 +312,7 @@ class symbol_c {
     }
 
   private:
+    friend class ast_memory_accounting_c;
     matiec::token_string first_file_storage_;
     matiec::token_string last_file_storage_;
 
@@ -256,7 +322,7 @@ class symbol_c {
      * Annotations produced during stage 3
      */    
     /*** Data type analysis ***/
-    std::vector <symbol_c *> candidate_datatypes; /* All possible data types the expression/literal/etc. may take. Filled in stage3 by fill_candidate_datatypes_c class */
+    candidate_datatypes_c candidate_datatypes; /* All possible data types the expression/literal/etc. may take. Filled in stage3 by fill_candidate_datatypes_c class */
     /* Data type of the expression/literal/etc. Filled in stage3 by narrow_candidate_datatypes_c 
      * If set to NULL, it means it has not yet been evaluated.
      * If it points to an object of type invalid_type_name_c, it means it is invalid.
@@ -270,14 +336,33 @@ class symbol_c {
      */
     symbol_c *scope;    
 
-    /* Modern annotations populated by stage3 bridges. */
-    std::vector<std::shared_ptr<const matiec::types::Type>> candidate_types;
-    std::shared_ptr<const matiec::types::Type> datatype_modern;
+    /* Modern annotations, i.e. the above data types as seen by the matiec::types type system.
+     * They are only derived (from candidate_datatypes, datatype and const_value) when first asked for,
+     * through the get_*_modern() methods below, and then cached. The types are ids of
+     * matiec::stage3::modern_type_registry() (kNoType if the symbol has no such type).
+     * NOTE: the get_*_modern() methods are defined in stage3/modern_semantic_annotations.cc, as they
+     *       need the datatype analysis of stage 3 to have been completed.
+     *       They are not thread safe, so do not query a symbol shared between concurrent traversals.
+     */
+    matiec::types::TypeId                     get_datatype_modern(void);
+    const std::vector<matiec::types::TypeId> &get_candidate_types_modern(void);
+    const matiec::types::TypedConstValue     &get_const_value_modern(void);
+    /* Drop the cached modern annotations, so that they get derived again on the next query. */
+    void reset_modern_annotations(void) {modern_annotations_valid = false;}
+    bool has_modern_annotations(void) const {return modern_annotations_valid;}
 
+  private:
+    /* Only accessed through the get_*_modern() methods, so that they are always derived before being read. */
+    void derive_modern_annotations(void);
+    bool modern_annotations_valid = false;
+    std::vector<matiec::types::TypeId> candidate_types;
+    matiec::types::TypeId datatype_modern = matiec::types::kNoType;
+    matiec::types::TypedConstValue const_value_modern;
+
+  public:
     /*** constant folding ***/
     /* If the symbol has a constant numerical value, this will be set to that value by constant_folding_c */
     const_value_c const_value;
-    matiec::types::TypedConstValue const_value_modern;
     
     /*** Enumeration datatype checking ***/    
     /* Not all symbols will contain the following anotations, which is why they are not declared here in symbol_c
@@ -340,6 +425,7 @@ class list_c: public symbol_c {
 
     int c,n; /* c: current reserved capacity; n: current number of elements */
   private:
+    friend class ast_memory_accounting_c;
 //     symbol_c **elements;
     typedef struct {
       matiec::token_string token_value;
@@ -399,6 +485,41 @@ namespace matiec {
   /* Delete all heap-allocated AST nodes reachable from one or more roots. */   
   void ast_delete(symbol_c* root) noexcept;
   void ast_delete(symbol_c* root1, symbol_c* root2) noexcept;
+
+  /* Memory usage of the AST, per concrete class (see ast_memory.cc).
+   *  bytes            : sizeof() of the nodes plus the heap memory they own
+   *                     (token strings, filenames, list element vectors, annotations).
+   *  annotation_bytes : the part of 'bytes' spent on stage 3/4 annotations
+   *                     (candidate datatypes, modern types, constant values, anotations_map, ...).
+   */
+  struct ast_class_memory_stats_t {
+    const char* cname;
+    size_t count;
+    size_t bytes;
+    size_t annotation_bytes;
+  };
+
+  struct ast_list_memory_stats_t {
+    const char* cname;
+    int n;
+    size_t bytes;
+    const char* first_file;
+    int first_line;
+  };
+
+  struct ast_memory_stats_t {
+    size_t node_count = 0;
+    size_t bytes = 0;
+    size_t annotation_bytes = 0;
+    std::vector<ast_class_memory_stats_t> classes;       /* sorted by bytes, largest first */
+    std::vector<ast_list_memory_stats_t>  largest_lists; /* sorted by n, largest first */
+  };
+
+  /* Walk the syntax tree(s) reachable from the roots (each node counted once) and
+   * collect the memory statistics. At most max_lists lists are kept in largest_lists. */
+  ast_memory_stats_t ast_memory_stats(symbol_c* root1, symbol_c* root2 = nullptr, size_t max_lists = 10);
+  /* Human readable report of the statistics, one line per class. */
+  std::string ast_memory_stats_report(const ast_memory_stats_t& stats);
 } // namespace matiec
 
 
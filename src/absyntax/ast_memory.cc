@@ -8,10 +8,15 @@
  */
 
 #include "absyntax.hh"
+#include "ast_preorder_index.hh"
 #include "visitor.hh"
+#include "matiec/format.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -25,8 +30,16 @@ std::unordered_set<void*>& heap_symbols() {
     return symbols;
 }
 
+// Guards heap_symbols() and pinned_symbols() while AST nodes may be created
+// from several threads (stage 4 may generate the code of the POUs in parallel).
+std::mutex& heap_symbols_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
 bool is_heap_symbol(const symbol_c* symbol) {
     if (!symbol) return false;
+    std::lock_guard<std::mutex> lock(heap_symbols_mutex());
     return heap_symbols().find(const_cast<symbol_c*>(symbol)) != heap_symbols().end();
 }
 
@@ -192,20 +205,77 @@ void ast_delete_impl(const std::vector<symbol_c*>& roots) noexcept {
     delete_tracked_symbols();
 }
 
+// sizeof() of each concrete AST class, indexed by matiec::ast_class_tag_t.
+const size_t ast_class_sizes[] = {
+#include "generated/ast_class_sizes.gen.inc"
+};
+
+size_t string_heap_bytes(const std::string& s) {
+    const char* data = s.data();
+    const char* self = reinterpret_cast<const char*>(&s);
+    if (data >= self && data < self + sizeof(s)) return 0; // small string buffer
+    return s.capacity() + 1;
+}
+
 } // namespace
 
+/* -------------------------------------------------------------------------- */
+/* AST memory accounting                                                      */
+/* -------------------------------------------------------------------------- */
+
+// Friend of symbol_c and list_c, so it may look at their private storage.
+class ast_memory_accounting_c {
+public:
+    // Heap memory owned by the syntax part of the node (token value, filenames, list elements).
+    static size_t owned_bytes(symbol_c* symbol) {
+        size_t bytes = symbol->first_file_storage_.heap_bytes() + symbol->last_file_storage_.heap_bytes();
+        if (auto* token = dynamic_cast<token_c*>(symbol)) {
+            bytes += token->value.heap_bytes();
+        }
+        if (auto* list = dynamic_cast<list_c*>(symbol)) {
+            bytes += list->elements.capacity() * sizeof(list_c::element_entry_t);
+            for (const auto& entry : list->elements) {
+                bytes += entry.token_value.heap_bytes();
+            }
+        }
+        return bytes;
+    }
+
+    // In-object size of the annotation members (already part of sizeof() of every node).
+    static constexpr size_t annotation_inline_bytes =
+        sizeof(symbol_c::candidate_datatypes) + sizeof(symbol_c::datatype) + sizeof(symbol_c::scope)
+      + sizeof(symbol_c::candidate_types) + sizeof(symbol_c::datatype_modern)
+      + sizeof(symbol_c::const_value) + sizeof(symbol_c::const_value_modern)
+      + sizeof(symbol_c::anotations_map);
+
+    // Heap memory owned by the annotation members.
+    static size_t annotation_heap_bytes(symbol_c* symbol) {
+        // Approximate size of a std::map node header (colour + parent/left/right pointers).
+        constexpr size_t map_node_overhead = 4 * sizeof(void*);
+
+        size_t bytes = symbol->candidate_datatypes.capacity() * sizeof(symbol_c*);
+        bytes += symbol->candidate_types.capacity() * sizeof(matiec::types::TypeId);
+        for (const auto& kv : symbol->anotations_map) {
+            bytes += map_node_overhead + sizeof(kv) + string_heap_bytes(kv.first);
+        }
+        return bytes;
+    }
+};
+
 /* -------------------------------------------------------------------------- */
 /* symbol_c heap tracking                                                     */
 /* -------------------------------------------------------------------------- */
 
 void* symbol_c::operator new(std::size_t size) {
     void* ptr = ::operator new(size);
+    std::lock_guard<std::mutex> lock(heap_symbols_mutex());
     heap_symbols().insert(ptr);
     return ptr;
 }
 
 void symbol_c::operator delete(void* ptr) noexcept {
     if (ptr) {
+        std::lock_guard<std::mutex> lock(heap_symbols_mutex());
         pinned_symbols().erase(ptr);
         heap_symbols().erase(ptr);
     }
@@ -279,6 +349,7 @@ void ast_pin(symbol_c* symbol) noexcept {
         }
 
         if (is_heap_symbol(node)) {
+            std::lock_guard<std::mutex> lock(heap_symbols_mutex());
             pinned_symbols().insert(node);
         }
 
@@ -295,4 +366,98 @@ void ast_delete(symbol_c* root1, symbol_c* root2) noexcept {
     ast_delete_impl({root1, root2});
 }
 
+ast_memory_stats_t ast_memory_stats(symbol_c* root1, symbol_c* root2, size_t max_lists) {
+    ast_memory_stats_t stats;
+
+    std::vector<symbol_c*> stack;
+    stack.reserve(1024);
+    if (root1) stack.push_back(root1);
+    if (root2) stack.push_back(root2);
+
+    std::unordered_set<symbol_c*> visited;
+    visited.reserve(4096);
+
+    // Keyed by absyntax_cname(), which returns a string literal (one per class).
+    std::unordered_map<const char*, size_t> class_pos;
+
+    child_pusher_visitor pusher(stack);
+
+    while (!stack.empty()) {
+        symbol_c* node = stack.back();
+        stack.pop_back();
+        if (!node) continue;
+
+        if (!visited.insert(node).second) {
+            continue;
+        }
+
+        const ast_class_tag_t tag = ast_class_tag(node);
+        const size_t node_size = (tag == ast_class_tag_t::count_)
+                                   ? sizeof(symbol_c)
+                                   : ast_class_sizes[static_cast<size_t>(tag)];
+        const size_t syntax_bytes = node_size + ast_memory_accounting_c::owned_bytes(node);
+        const size_t annotation_heap_bytes = ast_memory_accounting_c::annotation_heap_bytes(node);
+        const size_t bytes = syntax_bytes + annotation_heap_bytes;
+        const size_t annotation_bytes = ast_memory_accounting_c::annotation_inline_bytes + annotation_heap_bytes;
+
+        const char* cname = node->absyntax_cname();
+        auto it = class_pos.find(cname);
+        if (it == class_pos.end()) {
+            it = class_pos.emplace(cname, stats.classes.size()).first;
+            stats.classes.push_back({cname, 0, 0, 0});
+        }
+        ast_class_memory_stats_t& cls = stats.classes[it->second];
+        cls.count++;
+        cls.bytes += bytes;
+        cls.annotation_bytes += annotation_bytes;
+
+        stats.node_count++;
+        stats.bytes += bytes;
+        stats.annotation_bytes += annotation_bytes;
+
+        if (auto* list = dynamic_cast<list_c*>(node)) {
+            stats.largest_lists.push_back({cname, list->n, syntax_bytes, node->first_file, node->first_line});
+        }
+
+        node->accept(pusher); // pushes syntax children
+    }
+
+    std::sort(stats.classes.begin(), stats.classes.end(),
+              [](const ast_class_memory_stats_t& a, const ast_class_memory_stats_t& b) {
+                  if (a.bytes != b.bytes) return a.bytes > b.bytes;
+                  return std::strcmp(a.cname, b.cname) < 0;
+              });
+
+    auto larger = [](const ast_list_memory_stats_t& a, const ast_list_memory_stats_t& b) {
+        return a.n > b.n;
+    };
+    if (stats.largest_lists.size() > max_lists) {
+        std::partial_sort(stats.largest_lists.begin(), stats.largest_lists.begin() + max_lists,
+                          stats.largest_lists.end(), larger);
+        stats.largest_lists.resize(max_lists);
+    } else {
+        std::stable_sort(stats.largest_lists.begin(), stats.largest_lists.end(), larger);
+    }
+
+    return stats;
+}
+
+std::string ast_memory_stats_report(const ast_memory_stats_t& stats) {
+    std::string out = matiec::format("AST memory: %zu nodes, %zu bytes (%zu bytes in annotations)\n",
+                                     stats.node_count, stats.bytes, stats.annotation_bytes);
+    out += matiec::format("  %-48s %10s %12s %12s\n", "class", "count", "bytes", "annotations");
+    for (const auto& cls : stats.classes) {
+        out += matiec::format("  %-48s %10zu %12zu %12zu\n", cls.cname, cls.count, cls.bytes, cls.annotation_bytes);
+    }
+
+    if (!stats.largest_lists.empty()) {
+        out += "Largest lists:\n";
+        for (const auto& list : stats.largest_lists) {
+            out += matiec::format("  %-48s %10d %12zu   %s:%d\n", list.cname, list.n, list.bytes,
+                                  (list.first_file != nullptr) ? list.first_file : "<unknown>", list.first_line);
+        }
+    }
+    return out;
+}
+
 } // namespace matiec
@@ -0,0 +1,112 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Flattened preorder index over the abstract syntax tree.
+ */
+
+#include "ast_preorder_index.hh"
+#include "visitor.hh"
+
+#include <unordered_set>
+
+namespace matiec {
+
+namespace {
+
+// Records the tag of the concrete class of the visited symbol.
+class class_tag_visitor final : public visitor_c {
+public:
+    ast_class_tag_t tag_ = ast_class_tag_t::count_;
+
+#include "generated/ast_class_tag_visitor_methods.gen.inc"
+};
+
+// Collects the syntax children (SYM_REF*, SYM_LIST) of a symbol, in source order.
+class child_collector_visitor final : public visitor_c {
+public:
+    explicit child_collector_visitor(std::vector<symbol_c*>& children) : stack_(children) {}
+
+private:
+    std::vector<symbol_c*>& stack_;
+
+    void push(symbol_c* s) {
+        if (s) stack_.push_back(s);
+    }
+
+    void* visit_list(list_c* list) {
+        if (!list) return nullptr;
+        for (int i = 0; i < list->n; ++i) {
+            push(list->get_element(i));
+        }
+        return nullptr;
+    }
+
+public:
+#include "generated/ast_child_pusher_visitor_methods.gen.inc"
+};
+
+} // namespace
+
+
+ast_class_tag_t ast_class_tag(symbol_c* symbol) {
+    if (!symbol) return ast_class_tag_t::count_;
+    class_tag_visitor tagger;
+    symbol->accept(tagger);
+    return tagger.tag_;
+}
+
+
+void ast_preorder_index_c::clear(void) {
+    entries_.clear();
+    by_tag_.clear();
+}
+
+
+void ast_preorder_index_c::build(symbol_c* root) {
+    clear();
+    by_tag_.resize(static_cast<size_t>(ast_class_tag_t::count_));
+    if (!root) return;
+
+    class_tag_visitor tagger;
+    std::vector<symbol_c*> children;
+    child_collector_visitor collector(children);
+
+    // Explicit work stack of (node, parent position) pairs, so deep trees do not
+    // exhaust the call stack.
+    typedef struct {symbol_c* node; int32_t parent;} work_t;
+    std::vector<work_t> stack;
+    stack.reserve(1024);
+    stack.push_back({root, no_parent});
+
+    std::unordered_set<symbol_c*> visited;
+    visited.reserve(4096);
+    entries_.reserve(4096);
+
+    while (!stack.empty()) {
+        const work_t work = stack.back();
+        stack.pop_back();
+        if (!visited.insert(work.node).second) continue;
+
+        const int32_t pos = static_cast<int32_t>(entries_.size());
+        work.node->accept(tagger);
+        entries_.push_back({work.node, tagger.tag_, work.parent, pos + 1});
+        by_tag_[static_cast<size_t>(tagger.tag_)].push_back(pos);
+
+        // Push in reverse so that the first child is the next one popped.
+        children.clear();
+        work.node->accept(collector);
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            stack.push_back({*it, pos});
+        }
+    }
+
+    // In preorder every subtree is a contiguous range starting at its root, so
+    // a reverse sweep propagates each subtree's end up to its parent.
+    for (size_t i = entries_.size(); i-- > 1; ) {
+        entry_t& parent = entries_[entries_[i].parent];
+        if (parent.subtree_end < entries_[i].subtree_end)
+            parent.subtree_end = entries_[i].subtree_end;
+    }
+}
+
+} // namespace matiec
@@ -0,0 +1,88 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Flattened preorder index over the abstract syntax tree.
+ *
+ *  The semantic passes and code generators traverse the AST through recursive
+ *  accept()/visit() calls over nodes scattered across the heap. Passes that only
+ *  need to "look at every node of class X" may instead iterate this index, which
+ *  stores the whole tree as one contiguous array in preorder (i.e. in the same
+ *  order in which iterator_visitor_c would visit the nodes).
+ */
+
+#ifndef _AST_PREORDER_INDEX_HH
+#define _AST_PREORDER_INDEX_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absyntax.hh"
+
+
+namespace matiec {
+
+/* One tag per concrete AST class declared in absyntax.def */
+enum class ast_class_tag_t : uint16_t {
+#include "generated/ast_class_tags.gen.inc"
+  count_
+};
+
+/* Return the tag of the concrete class of symbol (one virtual call). */
+ast_class_tag_t ast_class_tag(symbol_c *symbol);
+
+
+class ast_preorder_index_c {
+  public:
+    static constexpr int32_t no_parent = -1;
+
+    typedef struct {
+      symbol_c        *node;
+      ast_class_tag_t  tag;
+      int32_t          parent;      /* index of the parent entry, or no_parent for the root */
+      int32_t          subtree_end; /* one past the last entry in this node's subtree */
+    } entry_t;
+
+    ast_preorder_index_c(void) = default;
+    explicit ast_preorder_index_c(symbol_c *root) {build(root);}
+
+    /* (Re)build the index for the tree rooted at root. Only syntax children
+     * (SYM_REF* and SYM_LIST elements) are followed, never annotations. A node
+     * reachable through more than one parent is indexed once only, at its first
+     * occurrence in preorder.
+     *
+     * NOTE: The index is a snapshot. Any pass that restructures the tree
+     *       (e.g. remove_forward_dependencies_c) invalidates it.
+     */
+    void build(symbol_c *root);
+    void clear(void);
+
+    bool           empty(void) const               {return entries_.empty();}
+    size_t         size (void) const               {return entries_.size();}
+    const entry_t &operator[](size_t pos) const    {return entries_[pos];}
+
+    const entry_t *begin(void) const               {return entries_.data();}
+    const entry_t *end  (void) const               {return entries_.data() + entries_.size();}
+
+    /* Positions (in preorder) of all entries of a given class. */
+    const std::vector<int32_t> &positions_of(ast_class_tag_t tag) const {
+      return by_tag_[static_cast<size_t>(tag)];
+    }
+
+    /* Call f(symbol) for every node of class node_t, in preorder. The tag must
+     * correspond to node_t (i.e. for_each<case_statement_c>(ast_class_tag_t::case_statement_c, ...)).
+     */
+    template<typename node_t, typename function_t>
+    void for_each(ast_class_tag_t tag, function_t f) const {
+      for (int32_t pos : positions_of(tag))
+        f(static_cast<node_t *>(entries_[pos].node));
+    }
+
+  private:
+    std::vector<entry_t>               entries_;
+    std::vector<std::vector<int32_t> > by_tag_;
+};
+
+} // namespace matiec
+
+#endif /* _AST_PREORDER_INDEX_HH */
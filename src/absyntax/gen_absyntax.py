@@ -498,9 +498,18 @@ def generate_nodes_source(entries: list[SymEntry]) -> str:
         if e.kind == "TOKEN":
             out.append(f"{e.class_name}::{e.class_name}(const char *value,\n")
             out.append(f"                           {LOCATION_DEF})\n")
-            out.append(
-                f"                        :token_c(value, fl, fc, ffile, forder, ll, lc, lfile, lorder) {{}}\n"
-            )
+            ptr_inits = _symbol_ptr_members(e.varargs)
+            if ptr_inits:
+                out.append(
+                    f"                        :token_c(value, fl, fc, ffile, forder, ll, lc, lfile, lorder) {{\n"
+                )
+                for name in ptr_inits:
+                    out.append(f"  this->{name} = NULL;\n")
+                out.append("}\n")
+            else:
+                out.append(
+                    f"                        :token_c(value, fl, fc, ffile, forder, ll, lc, lfile, lorder) {{}}\n"
+                )
             out.append(f"void *{e.class_name}::accept(visitor_c &visitor) {{return visitor.visit(this);}}\n\n")
             continue
 
@@ -641,6 +650,36 @@ def generate_child_pusher_methods(entries: list[SymEntry]) -> str:
     return "".join(out)
 
 
+def generate_class_tags(entries: list[SymEntry]) -> str:
+    out: list[str] = []
+    out.append("// Generated fragment. Do not edit manually.\n")
+    out.append("// Source: absyntax/absyntax.def (SYM_LIST/SYM_TOKEN/SYM_REF* entries)\n\n")
+    for e in entries:
+        out.append(f"    {e.class_name},\n")
+    return "".join(out)
+
+
+def generate_class_tag_methods(entries: list[SymEntry]) -> str:
+    out: list[str] = []
+    out.append("// Generated fragment. Do not edit manually.\n")
+    out.append("// Source: absyntax/absyntax.def (SYM_LIST/SYM_TOKEN/SYM_REF* entries)\n\n")
+    for e in entries:
+        out.append(
+            f"    void* visit({e.class_name}* /*symbol*/) override "
+            f"{{ tag_ = ast_class_tag_t::{e.class_name}; return nullptr; }}\n"
+        )
+    return "".join(out)
+
+
+def generate_class_sizes(entries: list[SymEntry]) -> str:
+    out: list[str] = []
+    out.append("// Generated fragment. Do not edit manually.\n")
+    out.append("// Source: absyntax/absyntax.def (SYM_LIST/SYM_TOKEN/SYM_REF* entries)\n\n")
+    for e in entries:
+        out.append(f"    sizeof({e.class_name}),\n")
+    return "".join(out)
+
+
 def generate_modern_forward_header(entries: list[SymEntry]) -> str:
     out: list[str] = []
     out.append("// Generated file. Do not edit manually.\n")
@@ -817,6 +856,16 @@ def main() -> int:
         generate_child_pusher_methods(entries), encoding="utf-8", newline="\n"
     )
 
+    (out_dir / "ast_class_tags.gen.inc").write_text(
+        generate_class_tags(entries), encoding="utf-8", newline="\n"
+    )
+    (out_dir / "ast_class_tag_visitor_methods.gen.inc").write_text(
+        generate_class_tag_methods(entries), encoding="utf-8", newline="\n"
+    )
+    (out_dir / "ast_class_sizes.gen.inc").write_text(
+        generate_class_sizes(entries), encoding="utf-8", newline="\n"
+    )
+
     if args.modern_out_dir:
         modern_dir: Path = args.modern_out_dir
         modern_dir.mkdir(parents=True, exist_ok=True)
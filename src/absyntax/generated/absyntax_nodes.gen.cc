@@ -48,13 +48,23 @@ void *identifier_c::accept(visitor_c &visitor) {return visitor.visit(this);}
 derived_datatype_identifier_c::derived_datatype_identifier_c(const char *value,
                            int fl, int fc, const char *ffile, long int forder,
                  int ll, int lc, const char *lfile, long int lorder)
-                        :token_c(value, fl, fc, ffile, forder, ll, lc, lfile, lorder) {}
+                        :token_c(value, fl, fc, ffile, forder, ll, lc, lfile, lorder) {
+  this->decl = NULL;
+  this->basetype_decl = NULL;
+  this->basetype_id = NULL;
+  this->equivtype_decl = NULL;
+}
 void *derived_datatype_identifier_c::accept(visitor_c &visitor) {return visitor.visit(this);}
 
 poutype_identifier_c::poutype_identifier_c(const char *value,
                            int fl, int fc, const char *ffile, long int forder,
                  int ll, int lc, const char *lfile, long int lorder)
-                        :token_c(value, fl, fc, ffile, forder, ll, lc, lfile, lorder) {}
+                        :token_c(value, fl, fc, ffile, forder, ll, lc, lfile, lorder) {
+  this->decl = NULL;
+  this->basetype_decl = NULL;
+  this->basetype_id = NULL;
+  this->equivtype_decl = NULL;
+}
 void *poutype_identifier_c::accept(visitor_c &visitor) {return visitor.visit(this);}
 
 ref_value_null_literal_c::ref_value_null_literal_c(
@@ -69,6 +69,7 @@ public:
 
 class derived_datatype_identifier_c: public token_c {
 public:
+  symbol_c *decl; symbol_c *basetype_decl; symbol_c *basetype_id; symbol_c *equivtype_decl;
 public:
   derived_datatype_identifier_c(const char *value,
                  int fl = 0, int fc = 0, const char *ffile = NULL /* filename */, long int forder=0,
@@ -79,6 +80,7 @@ public:
 
 class poutype_identifier_c: public token_c {
 public:
+  symbol_c *decl; symbol_c *basetype_decl; symbol_c *basetype_id; symbol_c *equivtype_decl;
 public:
   poutype_identifier_c(const char *value,
                  int fl = 0, int fc = 0, const char *ffile = NULL /* filename */, long int forder=0,
@@ -57,6 +57,10 @@
 #include "../util/symtable.hh"
 #include "../util/dsymtable.hh"
 #include "../absyntax/visitor.hh"
+#include "function_overload_index.hh"
+#include "search_var_instance_decl.hh"
+#include "search_varfb_instance_type.hh"
+#include "search_base_type.hh"
 #include "../main.hh" // required for ERROR() and ERROR_MSG() macros.
 
 
@@ -276,15 +280,50 @@ class populate_symtables_c: public iterator_visitor_c {
 
 
 
+/* Store on every derived_datatype_identifier_c and poutype_identifier_c a pointer to the declaration it references,
+ * so that later stages need not look up the same name in the symbol tables over and over again.
+ * Must be run after the symbol tables have been populated.
+ */
+class resolve_type_identifiers_c: public iterator_visitor_c {
+  public:
+  void *visit(derived_datatype_identifier_c *symbol) {
+    TRACE("derived_datatype_identifier_c");
+    symtable_c<symbol_c *>::iterator iter = type_symtable.find(symbol);
+    symbol->decl = (iter == type_symtable.end())? NULL : iter->second;
+    return NULL;
+  }
+
+  void *visit(poutype_identifier_c *symbol) {
+    TRACE("poutype_identifier_c");
+    symbol->decl = NULL;
+    symtable_c<function_block_declaration_c *>::iterator iter1 = function_block_type_symtable.find(symbol);
+    if (iter1 != function_block_type_symtable.end()) {symbol->decl = iter1->second; return NULL;}
+    symtable_c<program_declaration_c *>::iterator iter2 = program_type_symtable.find(symbol);
+    if (iter2 != program_type_symtable.end())        {symbol->decl = iter2->second; return NULL;}
+    return NULL;
+  }
+}; /* resolve_type_identifiers_c */
+
+
+
 
 void absyntax_utils_init(symbol_c *tree_root) {
   populate_symtables_c populate_symbols;
+  resolve_type_identifiers_c resolve_identifiers;
 
   tree_root->accept(populate_symbols);
+  tree_root->accept(resolve_identifiers);
+  search_base_type_c::cache_basetypes(tree_root);
+  function_overload_index.build();
+  search_var_instance_decl_c::build_index(tree_root);
+  search_varfb_instance_type_c::enable_field_cache();
 }
 
 void absyntax_utils_reset(void) {
   function_symtable.reset();
+  function_overload_index.reset();
+  search_var_instance_decl_c::reset_index();
+  search_varfb_instance_type_c::disable_field_cache();
 
   function_block_type_symtable.reset();
   program_type_symtable.reset();
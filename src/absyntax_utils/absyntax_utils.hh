@@ -101,6 +101,7 @@ extern  type_symtable_t type_symtable;
 #include "get_var_name.hh"
 #include "get_datatype_info.hh"
 #include "debug_ast.hh"
+#include "function_overload_index.hh"
 
 /***********************************************************************/
 /***********************************************************************/
@@ -111,6 +112,9 @@ extern  type_symtable_t type_symtable;
 
 
 
+/* Populate the global symbol tables, index the variable declarations of every POU, configuration
+ * and resource, and set the decl (and cache the base type) of every derived_datatype_identifier_c
+ * and poutype_identifier_c in the tree to the declaration it references. */
 void absyntax_utils_init(symbol_c *tree_root);
 
 /* Clear global symbol tables populated by absyntax_utils_init(). These tables
@@ -0,0 +1,152 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * An IEC 61131-3 compiler.
+ *
+ * Based on the
+ * FINAL DRAFT - IEC 61131-3, 2nd Ed. (2001-12-10)
+ *
+ */
+
+
+/*
+ *  Overload index over the function_symtable.
+ *  See function_overload_index.hh for details.
+ */
+
+
+#include "function_overload_index.hh"
+#include "absyntax_utils.hh"
+
+#include <algorithm>
+#include <typeinfo>
+
+
+function_overload_index_c function_overload_index;
+
+
+/* Determine the datatype of the first non-formal parameter (i.e. ignoring EN and ENO) of the
+ * function, and the maximum number of parameters that may be passed to it non-formally.
+ * This must follow exactly what fill_candidate_datatypes_c::match_nonformal_call() does.
+ */
+static symbol_c *first_param_datatype(function_declaration_c *f_decl, int &max_arity) {
+  function_param_iterator_c fp_iterator(f_decl);
+  symbol_c *first_datatype = NULL;
+  identifier_c *param_name;
+
+  max_arity = 0;
+  while ((param_name = fp_iterator.next()) != NULL) {
+    if (   (matiec::sv_or_empty(param_name->value) == "EN")
+        || (matiec::sv_or_empty(param_name->value) == "ENO"))
+      continue;
+    if (0 == max_arity++) {
+      symbol_c *param_type = fp_iterator.param_type();
+      if (NULL != param_type) first_datatype = search_base_type_c::get_basetype_decl(param_type);
+    }
+    /* function_param_iterator_c::next() returns the extensible parameter over and over again... */
+    if (fp_iterator.is_extensible_param()) {
+      max_arity = function_overload_index_c::unbounded_arity;
+      break;
+    }
+  }
+  return first_datatype;
+}
+
+
+
+const function_overload_index_c::name_entry_t *function_overload_index_c::find(const symbol_c *function_name) const {
+  const token_c *name = dynamic_cast<const token_c *>(function_name);
+  if (NULL == name) ERROR;
+  std::map<std::string, name_entry_t, nocasecmp_c>::const_iterator it = _index.find(matiec::sv_or_empty(name->value));
+  return (it == _index.end())? NULL : &(it->second);
+}
+
+
+
+void function_overload_index_c::reset(void) {
+  _index.clear();
+}
+
+
+
+void function_overload_index_c::build(void) {
+  reset();
+  for (function_symtable_t::iterator it = function_symtable.begin(); it != function_symtable.end(); it++) {
+    name_entry_t &entry = _index[it->first];
+    function_declaration_c *f_decl = function_symtable.get_value(it);
+    overload_t overload;
+    overload.f_decl = f_decl;
+    symbol_c *datatype = first_param_datatype(f_decl, overload.max_arity);
+
+    int pos = entry.overloads.size();
+    entry.overloads.push_back(overload);
+    /* Buckets are keyed by the class of the datatype, as that is what get_datatype_info_c::is_type_equal()
+     * compares when the parameter is of an elementary datatype. Everything else must always be checked.
+     */
+    if (   get_datatype_info_c::is_type_valid(datatype)
+        && !get_datatype_info_c::is_ANY_generic_type(datatype)
+        && get_datatype_info_c::is_ANY_ELEMENTARY_compatible(datatype))
+      entry.by_first_param[std::type_index(typeid(*datatype))].push_back(pos);
+    else
+      entry.wildcard.push_back(pos);
+  }
+}
+
+
+
+void function_overload_index_c::nonformal_candidates(symbol_c *function_name, symbol_c *first_param_value, int nf_param_count,
+                                                     std::vector<function_declaration_c *> &overloads) const {
+  const name_entry_t *entry = find(function_name);
+  if (NULL == entry) return;
+
+  std::vector<int> selected;
+  bool select_all = (NULL == first_param_value) || (nf_param_count == 0);
+  if (!select_all) {
+    selected = entry->wildcard;
+    const candidate_datatypes_c &candidate_datatypes = first_param_value->candidate_datatypes;
+    for (unsigned int i = 0; (i < candidate_datatypes.size()) && !select_all; i++) {
+      symbol_c *datatype = candidate_datatypes[i];
+      if (!get_datatype_info_c::is_type_valid(datatype)) continue;
+      /* a value of ANY datatype may be passed to any parameter... */
+      if (get_datatype_info_c::is_ANY_generic_type(datatype)) {select_all = true; break;}
+      std::map<std::type_index, std::vector<int> >::const_iterator bucket = entry->by_first_param.find(std::type_index(typeid(*datatype)));
+      if (bucket != entry->by_first_param.end())
+        selected.insert(selected.end(), bucket->second.begin(), bucket->second.end());
+    }
+    /* keep the function_symtable order */
+    std::sort(selected.begin(), selected.end());
+    selected.erase(std::unique(selected.begin(), selected.end()), selected.end());
+  }
+
+  if (select_all) {
+    for (unsigned int i = 0; i < entry->overloads.size(); i++)
+      if ((entry->overloads[i].max_arity == unbounded_arity) || (entry->overloads[i].max_arity >= nf_param_count))
+        overloads.push_back(entry->overloads[i].f_decl);
+    return;
+  }
+
+  for (unsigned int i = 0; i < selected.size(); i++) {
+    const overload_t &overload = entry->overloads[selected[i]];
+    if ((overload.max_arity == unbounded_arity) || (overload.max_arity >= nf_param_count))
+      overloads.push_back(overload.f_decl);
+  }
+}
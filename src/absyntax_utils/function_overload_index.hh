@@ -0,0 +1,107 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * An IEC 61131-3 compiler.
+ *
+ * Based on the
+ * FINAL DRAFT - IEC 61131-3, 2nd Ed. (2001-12-10)
+ *
+ */
+
+
+/*
+ *  Overload index over the function_symtable.
+ *
+ *  Standard functions such as ADD, MUL, GT, ... are declared once for every
+ *  elementary datatype they accept, so a single name may map to dozens of
+ *  function declarations. Instead of running a full parameter match on each of
+ *  them, the index allows a non-formal function invocation to only consider the
+ *  overloads that
+ *    - accept at least as many non-formal parameters as are being passed, and
+ *    - whose first (non EN/ENO) parameter may take one of the candidate datatypes
+ *      of the first value being passed.
+ *
+ *  The selected overloads are returned in the same order in which they are
+ *  stored in the function_symtable, so the result of any datatype analysis
+ *  does not depend on whether the index is used or not.
+ *
+ *  The index stores raw pointers into the AST. It is (re)built by
+ *  absyntax_utils_init() and cleared by absyntax_utils_reset().
+ */
+
+
+#ifndef _FUNCTION_OVERLOAD_INDEX_HH
+#define _FUNCTION_OVERLOAD_INDEX_HH
+
+#include <map>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "../absyntax/absyntax.hh"
+
+
+class function_overload_index_c {
+  public:
+    /* max_arity of functions with an extensible parameter (e.g. ADD(IN1, IN2, ...)) */
+    static const int unbounded_arity = -1;
+
+  private:
+    typedef struct {
+      function_declaration_c *f_decl;
+      int                     max_arity;   /* number of parameters that may be passed non-formally, or unbounded_arity */
+    } overload_t;
+
+    typedef struct {
+      std::vector<overload_t> overloads;   /* in function_symtable order */
+      /* Position (in overloads) of every overload, grouped by the class of the datatype of the first parameter.
+       * Overloads whose first parameter is not of an elementary datatype (e.g. ANY, a structure, an array, ...),
+       * or which have no parameters at all, go into the wildcard bucket, as they must always be checked.
+       */
+      std::map<std::type_index, std::vector<int> > by_first_param;
+      std::vector<int>                             wildcard;
+    } name_entry_t;
+
+    std::map<std::string, name_entry_t, nocasecmp_c> _index;
+
+    const name_entry_t *find(const symbol_c *function_name) const;
+
+  public:
+    /* (Re)build the index from the current contents of the function_symtable. */
+    void build(void);
+    void reset(void);
+
+    /* Append to overloads all the declarations of the function function_name that
+     * may be compatible with a non-formal invocation passing nf_param_count
+     * parameters, of which first_param_value is the first (NULL if nf_param_count == 0).
+     *
+     * The candidate_datatypes of first_param_value must already have been filled in.
+     */
+    void nonformal_candidates(symbol_c *function_name, symbol_c *first_param_value, int nf_param_count,
+                              std::vector<function_declaration_c *> &overloads) const;
+};
+
+
+extern function_overload_index_c function_overload_index;
+
+
+#endif /* _FUNCTION_OVERLOAD_INDEX_HH */
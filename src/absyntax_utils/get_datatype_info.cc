@@ -48,6 +48,9 @@
 
 
 #include <typeinfo>  // required for typeid
+#include <stdint.h>
+
+#include "../absyntax/ast_preorder_index.hh" // required for matiec::ast_class_tag()
 
 
 /**********************************************************/
@@ -70,7 +73,7 @@
 /****************************************************************************************************/
 class get_datatype_id_c: null_visitor_c {
   private:
-    static get_datatype_id_c *singleton;
+    static thread_local get_datatype_id_c *singleton;
     
   public:
     static symbol_c *get_id(symbol_c *symbol) {
@@ -165,7 +168,7 @@ class get_datatype_id_c: null_visitor_c {
     
 }; // get_datatype_id_c 
 
-get_datatype_id_c *get_datatype_id_c::singleton = NULL;
+thread_local get_datatype_id_c *get_datatype_id_c::singleton = NULL;
 
 
 
@@ -189,7 +192,7 @@ class get_datatype_id_str_c: public null_visitor_c {
 
   private:
     /* singleton class! */
-    static get_datatype_id_str_c *singleton;
+    static thread_local get_datatype_id_str_c *singleton;
 
   public:
     static const char *get_id_str(symbol_c *symbol) {
@@ -311,7 +314,7 @@ class get_datatype_id_str_c: public null_visitor_c {
     void *visit(       program_declaration_c  *symbol)  {return symbol->program_type_name->accept(*this);} 
 };
 
-get_datatype_id_str_c *get_datatype_id_str_c::singleton = NULL;
+thread_local get_datatype_id_str_c *get_datatype_id_str_c::singleton = NULL;
 
 
 
@@ -325,7 +328,7 @@ class get_struct_info_c : null_visitor_c {
   private:
     symbol_c *current_field;
     /* singleton class! */
-    static get_struct_info_c *singleton;
+    static thread_local get_struct_info_c *singleton;
 
   public:
     get_struct_info_c(void) {current_field = NULL;}
@@ -418,7 +421,150 @@ class get_struct_info_c : null_visitor_c {
       
 }; // get_struct_info_c
 
-get_struct_info_c *get_struct_info_c::singleton = NULL;
+thread_local get_struct_info_c *get_struct_info_c::singleton = NULL;
+
+
+
+
+
+/*****************************************************/
+/*****************************************************/
+/* The category bit mask of each datatype AST class */
+/*****************************************************/
+/*****************************************************/
+/* The is_*() predicates below are called over and over again for every candidate datatype of every
+ * expression, so instead of comparing the class of the datatype against each class in the category
+ * (with typeid), each AST class is given a 64 bit mask of the categories it belongs to, and each
+ * predicate becomes a single bit test on that mask.
+ *
+ * The first 8 bits are the categories of the elementary datatypes, and the next 8 bits the same
+ * categories for the SAFE datatypes (i.e. tc_SAFE(tc_BOOL) is SAFEBOOL).
+ */
+static const uint64_t tc_BOOL            = UINT64_C(1) <<  0;
+static const uint64_t tc_nBIT            = UINT64_C(1) <<  1;
+static const uint64_t tc_signed_INT      = UINT64_C(1) <<  2;
+static const uint64_t tc_unsigned_INT    = UINT64_C(1) <<  3;
+static const uint64_t tc_REAL            = UINT64_C(1) <<  4;
+static const uint64_t tc_TIME            = UINT64_C(1) <<  5;
+static const uint64_t tc_DATE            = UINT64_C(1) <<  6;
+static const uint64_t tc_STRING          = UINT64_C(1) <<  7;
+static inline uint64_t tc_SAFE      (uint64_t categories) {return categories << 8;}
+static inline uint64_t tc_compatible(uint64_t categories) {return categories | tc_SAFE(categories);}
+
+static const uint64_t tc_VOID            = UINT64_C(1) << 16;
+static const uint64_t tc_INT_literal     = UINT64_C(1) << 17;
+static const uint64_t tc_REAL_literal    = UINT64_C(1) << 18;
+static const uint64_t tc_generic_ANY     = UINT64_C(1) << 19;
+static const uint64_t tc_ref_to          = UINT64_C(1) << 20;
+static const uint64_t tc_function_block  = UINT64_C(1) << 21;
+static const uint64_t tc_sfc_initstep    = UINT64_C(1) << 22;
+static const uint64_t tc_sfc_step        = UINT64_C(1) << 23;
+static const uint64_t tc_subrange        = UINT64_C(1) << 24;
+static const uint64_t tc_enumerated      = UINT64_C(1) << 25;
+static const uint64_t tc_array           = UINT64_C(1) << 26;
+static const uint64_t tc_structure       = UINT64_C(1) << 27;
+static const uint64_t tc_invalid         = UINT64_C(1) << 28;
+/* helper symbols of a datatype declaration, that should never be taken for the datatype itself */
+static const uint64_t tc_datatype_part   = UINT64_C(1) << 29;
+
+static const uint64_t tc_ANY_INT            = tc_signed_INT | tc_unsigned_INT;
+static const uint64_t tc_ANY_NUM            = tc_ANY_INT | tc_REAL;
+static const uint64_t tc_ANY_signed_NUM     = tc_signed_INT | tc_REAL;
+static const uint64_t tc_ANY_MAGNITUDE      = tc_ANY_NUM | tc_TIME;
+static const uint64_t tc_ANY_signed_MAGNITUDE = tc_ANY_signed_NUM | tc_TIME;
+static const uint64_t tc_ANY_BIT            = tc_BOOL | tc_nBIT;
+static const uint64_t tc_ANY_ELEMENTARY     = tc_ANY_MAGNITUDE | tc_ANY_BIT | tc_DATE | tc_STRING;
+
+
+class type_category_table_c {
+  private:
+    uint64_t masks[(size_t)matiec::ast_class_tag_t::count_ + 1]; /* + 1, for NULL symbols */
+
+    void set(matiec::ast_class_tag_t tag, uint64_t mask) {masks[(size_t)tag] = mask;}
+
+  public:
+    type_category_table_c(void) {
+      typedef matiec::ast_class_tag_t t;
+      for (uint64_t &mask: masks) mask = 0;
+
+      set(t::bool_type_name_c,         tc_BOOL);           set(t::safebool_type_name_c,     tc_SAFE(tc_BOOL));
+      set(t::byte_type_name_c,         tc_nBIT);           set(t::safebyte_type_name_c,     tc_SAFE(tc_nBIT));
+      set(t::word_type_name_c,         tc_nBIT);           set(t::safeword_type_name_c,     tc_SAFE(tc_nBIT));
+      set(t::dword_type_name_c,        tc_nBIT);           set(t::safedword_type_name_c,    tc_SAFE(tc_nBIT));
+      set(t::lword_type_name_c,        tc_nBIT);           set(t::safelword_type_name_c,    tc_SAFE(tc_nBIT));
+      set(t::sint_type_name_c,         tc_signed_INT);     set(t::safesint_type_name_c,     tc_SAFE(tc_signed_INT));
+      set(t::int_type_name_c,          tc_signed_INT);     set(t::safeint_type_name_c,      tc_SAFE(tc_signed_INT));
+      set(t::dint_type_name_c,         tc_signed_INT);     set(t::safedint_type_name_c,     tc_SAFE(tc_signed_INT));
+      set(t::lint_type_name_c,         tc_signed_INT);     set(t::safelint_type_name_c,     tc_SAFE(tc_signed_INT));
+      set(t::usint_type_name_c,        tc_unsigned_INT);   set(t::safeusint_type_name_c,    tc_SAFE(tc_unsigned_INT));
+      set(t::uint_type_name_c,         tc_unsigned_INT);   set(t::safeuint_type_name_c,     tc_SAFE(tc_unsigned_INT));
+      set(t::udint_type_name_c,        tc_unsigned_INT);   set(t::safeudint_type_name_c,    tc_SAFE(tc_unsigned_INT));
+      set(t::ulint_type_name_c,        tc_unsigned_INT);   set(t::safeulint_type_name_c,    tc_SAFE(tc_unsigned_INT));
+      set(t::real_type_name_c,         tc_REAL);           set(t::safereal_type_name_c,     tc_SAFE(tc_REAL));
+      set(t::lreal_type_name_c,        tc_REAL);           set(t::safelreal_type_name_c,    tc_SAFE(tc_REAL));
+      set(t::time_type_name_c,         tc_TIME);           set(t::safetime_type_name_c,     tc_SAFE(tc_TIME));
+      set(t::date_type_name_c,         tc_DATE);           set(t::safedate_type_name_c,     tc_SAFE(tc_DATE));
+      set(t::tod_type_name_c,          tc_DATE);           set(t::safetod_type_name_c,      tc_SAFE(tc_DATE));
+      set(t::dt_type_name_c,           tc_DATE);           set(t::safedt_type_name_c,       tc_SAFE(tc_DATE));
+      set(t::string_type_name_c,       tc_STRING);         set(t::safestring_type_name_c,   tc_SAFE(tc_STRING));
+      set(t::wstring_type_name_c,      tc_STRING);         set(t::safewstring_type_name_c,  tc_SAFE(tc_STRING));
+
+      set(t::void_type_name_c,         tc_VOID);
+      set(t::invalid_type_name_c,      tc_invalid);
+      set(t::generic_type_any_c,       tc_generic_ANY);
+
+      set(t::integer_c,                tc_INT_literal);
+      set(t::neg_integer_c,            tc_INT_literal);
+      set(t::binary_integer_c,         tc_INT_literal);
+      set(t::octal_integer_c,          tc_INT_literal);
+      set(t::hex_integer_c,            tc_INT_literal);
+      set(t::real_c,                   tc_REAL_literal);
+      set(t::neg_real_c,               tc_REAL_literal);
+
+      set(t::ref_type_decl_c,          tc_ref_to);
+      set(t::ref_spec_init_c,          tc_ref_to);
+      set(t::ref_spec_c,               tc_ref_to);
+      set(t::function_block_declaration_c, tc_function_block);
+      set(t::initial_step_c,           tc_sfc_initstep);
+      set(t::step_c,                   tc_sfc_step);
+
+      set(t::subrange_type_declaration_c,          tc_subrange);
+      set(t::subrange_spec_init_c,                 tc_subrange);
+      set(t::subrange_specification_c,             tc_subrange);
+      set(t::subrange_c,                           tc_datatype_part);
+      set(t::enumerated_type_declaration_c,        tc_enumerated);
+      set(t::enumerated_spec_init_c,               tc_enumerated);
+      set(t::enumerated_value_list_c,              tc_enumerated);
+      set(t::enumerated_value_c,                   tc_datatype_part);
+      set(t::array_type_declaration_c,             tc_array);
+      set(t::array_spec_init_c,                    tc_array);
+      set(t::array_specification_c,                tc_array);
+      set(t::array_subrange_list_c,                tc_datatype_part);
+      set(t::array_initial_elements_list_c,        tc_datatype_part);
+      set(t::array_initial_elements_c,             tc_datatype_part);
+      set(t::structure_type_declaration_c,         tc_structure);
+      set(t::initialized_structure_c,              tc_structure);
+      set(t::structure_element_declaration_list_c, tc_structure);
+      set(t::structure_element_declaration_c,      tc_datatype_part);
+      set(t::structure_element_initialization_list_c, tc_datatype_part);
+      set(t::structure_element_initialization_c,   tc_datatype_part);
+    }
+
+    uint64_t get(symbol_c *symbol) const {return masks[(size_t)matiec::ast_class_tag(symbol)];}
+};
+
+
+/* The categories of the (class of the) symbol. Returns 0 for NULL. */
+static uint64_t type_categories(symbol_c *symbol) {
+  static const type_category_table_c table; /* initialised once, even when called from several threads */
+  return table.get(symbol);
+}
+
+
+/* The categories of the base datatype of type_symbol, for the predicates on derived datatypes */
+static uint64_t basetype_categories(symbol_c *type_symbol) {
+  return type_categories(search_base_type_c::get_basetype_decl(type_symbol));
+}
 
 
 
@@ -584,6 +730,9 @@ bool get_datatype_info_c::is_type_equal(symbol_c *first_type, symbol_c *second_t
   if (!is_type_valid( first_type))                                   {return false;}
   if (!is_type_valid(second_type))                                   {return false;}
 
+  /* the same datatype (typically the same elementary datatype object, shared by many expressions) */
+  if (first_type == second_type)                                     {return true;}
+
   /* GENERIC DATATYPES */
   /* For the moment, we only support the ANY generic datatype! */
   if ((is_ANY_generic_type( first_type)) ||
@@ -754,7 +903,7 @@ bool get_datatype_info_c::is_arraytype_equal_relaxed(symbol_c *first_type, symbo
 
 bool get_datatype_info_c::is_type_valid(symbol_c *type) {
   if (NULL == type)                                                  {return false;}
-  if (typeid(*type) == typeid(invalid_type_name_c))                  {return false;}
+  if (type_categories(type) & tc_invalid)                            {return false;}
   return true;
 }
 
@@ -784,618 +933,137 @@ symbol_c *get_datatype_info_c::get_ref_to(symbol_c *type_symbol) {
 
 
 bool get_datatype_info_c::is_ref_to(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_basetype_decl(type_symbol);
-  if (NULL == type_decl)                                                       {return false;}
-  
-  if (typeid(*type_decl) == typeid(ref_type_decl_c))                           {return true;}   /* identifier ':' ref_spec_init */
-  if (typeid(*type_decl) == typeid(ref_spec_init_c))                           {return true;}   /* ref_spec [ ASSIGN ref_initialization ]; */
-  if (typeid(*type_decl) == typeid(ref_spec_c))                                {return true;}   /* REF_TO (non_generic_type_name | function_block_type_name) */
-  return false;
+  return (basetype_categories(type_symbol) & tc_ref_to) != 0;    /* ref_type_decl_c, ref_spec_init_c or ref_spec_c */
 }
 
 
-
-
 bool get_datatype_info_c::is_sfc_initstep(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_basetype_decl(type_symbol); 
-  if (NULL == type_decl)                                             {return false;}
-  if (typeid(*type_decl) == typeid(initial_step_c))                  {return true;}   /* INITIAL_STEP step_name ':' action_association_list END_STEP */  /* A pseudo data type! */
-  return false;
+  return (basetype_categories(type_symbol) & tc_sfc_initstep) != 0;   /* A pseudo data type! */
 }
 
 
-
 bool get_datatype_info_c::is_sfc_step(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_basetype_decl(type_symbol); 
-  if (NULL == type_decl)                                             {return false;}
-  if (typeid(*type_decl) == typeid(initial_step_c))                  {return true;}   /* INITIAL_STEP step_name ':' action_association_list END_STEP */  /* A pseudo data type! */
-  if (typeid(*type_decl) == typeid(        step_c))                  {return true;}   /*         STEP step_name ':' action_association_list END_STEP */  /* A pseudo data type! */
-  return false;
+  return (basetype_categories(type_symbol) & (tc_sfc_initstep | tc_sfc_step)) != 0;   /* A pseudo data type! */
 }
 
 
-
-
 bool get_datatype_info_c::is_function_block(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_basetype_decl(type_symbol); 
-  if (NULL == type_decl)                                             {return false;}
-  if (typeid(*type_decl) == typeid(function_block_declaration_c))    {return true;}   /*  FUNCTION_BLOCK derived_function_block_name io_OR_other_var_declarations function_block_body END_FUNCTION_BLOCK */
-  return false;
+  return (basetype_categories(type_symbol) & tc_function_block) != 0;
 }
 
 
-
-
-
 bool get_datatype_info_c::is_subrange(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_equivtype_decl(type_symbol); /* NOTE: do NOT call search_base_type_c !! */
-  if (NULL == type_decl)                                             {return false;}
-  
-  if (typeid(*type_decl) == typeid(subrange_type_declaration_c))     {return true;}   /*  subrange_type_name ':' subrange_spec_init */
-  if (typeid(*type_decl) == typeid(subrange_spec_init_c))            {return true;}   /* subrange_specification ASSIGN signed_integer */
-  if (typeid(*type_decl) == typeid(subrange_specification_c))        {return true;}   /*  integer_type_name '(' subrange')' */
-    
-  if (typeid(*type_decl) == typeid(subrange_c))                      {ERROR;}         /*  signed_integer DOTDOT signed_integer */
+  uint64_t categories = type_categories(search_base_type_c::get_equivtype_decl(type_symbol)); /* NOTE: do NOT call search_base_type_c !! */
+  if (categories & tc_subrange)                                      {return true;}   /* subrange_type_declaration_c, subrange_spec_init_c or subrange_specification_c */
+  if (categories & tc_datatype_part)                                 {ERROR;}         /* subrange_c */
   return false;
 }
 
 
-
-
-
 bool get_datatype_info_c::is_enumerated(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_basetype_decl(type_symbol);
-  if (NULL == type_decl)                                             {return false;}
-  
-  if (typeid(*type_decl) == typeid(enumerated_type_declaration_c))   {return true;}   /*  enumerated_type_name ':' enumerated_spec_init */
-  if (typeid(*type_decl) == typeid(enumerated_spec_init_c))          {return true;}   /* enumerated_specification ASSIGN enumerated_value */
-  if (typeid(*type_decl) == typeid(enumerated_value_list_c))         {return true;}   /* enumerated_value_list ',' enumerated_value */        /* once we change the way we handle enums, this will probably become an ERROR! */
-  
-  if (typeid(*type_decl) == typeid(enumerated_value_c))              {ERROR;}         /* enumerated_type_name '#' identifier */
+  uint64_t categories = basetype_categories(type_symbol);
+  if (categories & tc_enumerated)                                    {return true;}   /* enumerated_type_declaration_c, enumerated_spec_init_c or enumerated_value_list_c */
+  if (categories & tc_datatype_part)                                 {ERROR;}         /* enumerated_value_c */
   return false;
 }
 
 
-
-
-
 bool get_datatype_info_c::is_array(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_basetype_decl(type_symbol);
-  if (NULL == type_decl)                                             {return false;}
-  
-  if (typeid(*type_decl) == typeid(array_type_declaration_c))        {return true;}   /*  identifier ':' array_spec_init */
-  if (typeid(*type_decl) == typeid(array_spec_init_c))               {return true;}   /* array_specification [ASSIGN array_initialization} */
-  if (typeid(*type_decl) == typeid(array_specification_c))           {return true;}   /* ARRAY '[' array_subrange_list ']' OF non_generic_type_name */
-  
-  if (typeid(*type_decl) == typeid(array_subrange_list_c))           {ERROR;}         /* array_subrange_list ',' subrange */
-  if (typeid(*type_decl) == typeid(array_initial_elements_list_c))   {ERROR;}         /* array_initialization:  '[' array_initial_elements_list ']' */  /* array_initial_elements_list ',' array_initial_elements */
-  if (typeid(*type_decl) == typeid(array_initial_elements_c))        {ERROR;}         /* integer '(' [array_initial_element] ')' */
+  uint64_t categories = basetype_categories(type_symbol);
+  if (categories & tc_array)                                         {return true;}   /* array_type_declaration_c, array_spec_init_c or array_specification_c */
+  if (categories & tc_datatype_part)                                 {ERROR;}         /* array_subrange_list_c, array_initial_elements_list_c or array_initial_elements_c */
   return false;
 }
 
 
-
-
-
 bool get_datatype_info_c::is_structure(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_basetype_decl(type_symbol);
-  if (NULL == type_decl)                                                       {return false;}
-  
-  if (typeid(*type_decl) == typeid(structure_type_declaration_c))              {return true;}   /*  structure_type_name ':' structure_specification */
-  if (typeid(*type_decl) == typeid(initialized_structure_c))                   {return true;}   /* structure_type_name ASSIGN structure_initialization */
-  if (typeid(*type_decl) == typeid(structure_element_declaration_list_c))      {return true;}   /* structure_declaration:  STRUCT structure_element_declaration_list END_STRUCT */ /* structure_element_declaration_list structure_element_declaration ';' */
-  
-  if (typeid(*type_decl) == typeid(structure_element_declaration_c))           {ERROR;}         /*  structure_element_name ':' *_spec_init */
-  if (typeid(*type_decl) == typeid(structure_element_initialization_list_c))   {ERROR;}         /* structure_initialization: '(' structure_element_initialization_list ')' */  /* structure_element_initialization_list ',' structure_element_initialization */
-  if (typeid(*type_decl) == typeid(structure_element_initialization_c))        {ERROR;}         /*  structure_element_name ASSIGN value */
+  uint64_t categories = basetype_categories(type_symbol);
+  if (categories & tc_structure)                                     {return true;}   /* structure_type_declaration_c, initialized_structure_c or structure_element_declaration_list_c */
+  if (categories & tc_datatype_part)                                 {ERROR;}         /* structure_element_declaration_c, structure_element_initialization_list_c or structure_element_initialization_c */
   return false;
 }
 
 
-
-
 bool get_datatype_info_c::is_ANY_generic_type(symbol_c *type_symbol) {
-  symbol_c *type_decl = search_base_type_c::get_basetype_decl(type_symbol);
-  if (NULL == type_decl)                                             {return false;}  
-  if (typeid(*type_decl) == typeid(generic_type_any_c))              {return true;}   /*  The ANY keyword! */
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_ELEMENTARY(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_MAGNITUDE(type_symbol))                           {return true;}
-  if (is_ANY_BIT      (type_symbol))                           {return true;}
-  if (is_ANY_STRING   (type_symbol))                           {return true;}
-  if (is_ANY_DATE     (type_symbol))                           {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFEELEMENTARY(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_SAFEMAGNITUDE(type_symbol))                       {return true;}
-  if (is_ANY_SAFEBIT      (type_symbol))                       {return true;}
-  if (is_ANY_SAFESTRING   (type_symbol))                       {return true;}
-  if (is_ANY_SAFEDATE     (type_symbol))                       {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_ELEMENTARY_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_ELEMENTARY    (type_symbol))                      {return true;}
-  if (is_ANY_SAFEELEMENTARY(type_symbol))                      {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_MAGNITUDE(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_TIME(type_symbol))                                    {return true;}
-  if (is_ANY_NUM(type_symbol))                                 {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFEMAGNITUDE(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_SAFETIME(type_symbol))                                {return true;}
-  if (is_ANY_SAFENUM(type_symbol))                             {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_MAGNITUDE_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_MAGNITUDE    (type_symbol))                       {return true;}
-  if (is_ANY_SAFEMAGNITUDE(type_symbol))                       {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_signed_MAGNITUDE(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(time_type_name_c))        {return true;}
-  if (is_ANY_signed_NUM(type_symbol))                          {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_signed_SAFEMAGNITUDE(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safetime_type_name_c))    {return true;}
-  return is_ANY_signed_SAFENUM(type_symbol);
-}
-
-
-bool get_datatype_info_c::is_ANY_signed_MAGNITUDE_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_signed_MAGNITUDE    (type_symbol))                {return true;}
-  if (is_ANY_signed_SAFEMAGNITUDE(type_symbol))                {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_NUM(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_REAL(type_symbol))                                {return true;}
-  if (is_ANY_INT (type_symbol))                                {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFENUM(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_SAFEREAL(type_symbol))                            {return true;}
-  if (is_ANY_SAFEINT (type_symbol))                            {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_NUM_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_NUM    (type_symbol))                             {return true;}
-  if (is_ANY_SAFENUM(type_symbol))                             {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_signed_NUM(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_REAL      (type_symbol))                          {return true;}
-  if (is_ANY_signed_INT(type_symbol))                          {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_signed_SAFENUM(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_SAFEREAL      (type_symbol))                      {return true;}
-  if (is_ANY_signed_SAFEINT(type_symbol))                      {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_signed_NUM_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_signed_NUM    (type_symbol))                      {return true;}
-  if (is_ANY_signed_SAFENUM(type_symbol))                      {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_INT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_signed_INT  (type_symbol))                        {return true;}
-  if (is_ANY_unsigned_INT(type_symbol))                        {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFEINT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_signed_SAFEINT  (type_symbol))                    {return true;}
-  if (is_ANY_unsigned_SAFEINT(type_symbol))                    {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_INT_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_INT    (type_symbol))                             {return true;}
-  if (is_ANY_SAFEINT(type_symbol))                             {return true;}
-  return false;
+  return (basetype_categories(type_symbol) & tc_generic_ANY) != 0;   /*  The ANY keyword! */
 }
 
 
 
+bool get_datatype_info_c::is_ANY_ELEMENTARY(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_ANY_ELEMENTARY) != 0;}
+bool get_datatype_info_c::is_ANY_SAFEELEMENTARY(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_ANY_ELEMENTARY)) != 0;}
+bool get_datatype_info_c::is_ANY_ELEMENTARY_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_ANY_ELEMENTARY)) != 0;}
 
+bool get_datatype_info_c::is_ANY_MAGNITUDE(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_ANY_MAGNITUDE) != 0;}
+bool get_datatype_info_c::is_ANY_SAFEMAGNITUDE(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_ANY_MAGNITUDE)) != 0;}
+bool get_datatype_info_c::is_ANY_MAGNITUDE_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_ANY_MAGNITUDE)) != 0;}
 
+bool get_datatype_info_c::is_ANY_signed_MAGNITUDE(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_ANY_signed_MAGNITUDE) != 0;}
+bool get_datatype_info_c::is_ANY_signed_SAFEMAGNITUDE(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_ANY_signed_MAGNITUDE)) != 0;}
+bool get_datatype_info_c::is_ANY_signed_MAGNITUDE_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_ANY_signed_MAGNITUDE)) != 0;}
 
-bool get_datatype_info_c::is_ANY_signed_INT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(sint_type_name_c))        {return true;}
-  if (typeid(*type_symbol) == typeid(int_type_name_c))         {return true;}
-  if (typeid(*type_symbol) == typeid(dint_type_name_c))        {return true;}
-  if (typeid(*type_symbol) == typeid(lint_type_name_c))        {return true;}
-  return false;
-}
+bool get_datatype_info_c::is_ANY_NUM(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_ANY_NUM) != 0;}
+bool get_datatype_info_c::is_ANY_SAFENUM(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_ANY_NUM)) != 0;}
+bool get_datatype_info_c::is_ANY_NUM_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_ANY_NUM)) != 0;}
 
+bool get_datatype_info_c::is_ANY_signed_NUM(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_ANY_signed_NUM) != 0;}
+bool get_datatype_info_c::is_ANY_signed_SAFENUM(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_ANY_signed_NUM)) != 0;}
+bool get_datatype_info_c::is_ANY_signed_NUM_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_ANY_signed_NUM)) != 0;}
 
-bool get_datatype_info_c::is_ANY_signed_SAFEINT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safesint_type_name_c))    {return true;}
-  if (typeid(*type_symbol) == typeid(safeint_type_name_c))     {return true;}
-  if (typeid(*type_symbol) == typeid(safedint_type_name_c))    {return true;}
-  if (typeid(*type_symbol) == typeid(safelint_type_name_c))    {return true;}
-  return false;
-}
+bool get_datatype_info_c::is_ANY_INT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_ANY_INT) != 0;}
+bool get_datatype_info_c::is_ANY_SAFEINT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_ANY_INT)) != 0;}
+bool get_datatype_info_c::is_ANY_INT_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_ANY_INT)) != 0;}
 
+bool get_datatype_info_c::is_ANY_signed_INT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_signed_INT) != 0;}
+bool get_datatype_info_c::is_ANY_signed_SAFEINT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_signed_INT)) != 0;}
+bool get_datatype_info_c::is_ANY_signed_INT_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_signed_INT)) != 0;}
 
-bool get_datatype_info_c::is_ANY_signed_INT_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_signed_INT    (type_symbol))                      {return true;}
-  if (is_ANY_signed_SAFEINT(type_symbol))                      {return true;}
-  return false;
-}
+bool get_datatype_info_c::is_ANY_unsigned_INT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_unsigned_INT) != 0;}
+bool get_datatype_info_c::is_ANY_unsigned_SAFEINT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_unsigned_INT)) != 0;}
+bool get_datatype_info_c::is_ANY_unsigned_INT_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_unsigned_INT)) != 0;}
 
+bool get_datatype_info_c::is_ANY_REAL(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_REAL) != 0;}
+bool get_datatype_info_c::is_ANY_SAFEREAL(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_REAL)) != 0;}
+bool get_datatype_info_c::is_ANY_REAL_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_REAL)) != 0;}
 
+bool get_datatype_info_c::is_ANY_nBIT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_nBIT) != 0;}
+bool get_datatype_info_c::is_ANY_SAFEnBIT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_nBIT)) != 0;}
+bool get_datatype_info_c::is_ANY_nBIT_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_nBIT)) != 0;}
 
+bool get_datatype_info_c::is_BOOL(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_BOOL) != 0;}
+bool get_datatype_info_c::is_SAFEBOOL(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_BOOL)) != 0;}
+bool get_datatype_info_c::is_BOOL_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_BOOL)) != 0;}
 
+bool get_datatype_info_c::is_ANY_BIT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_ANY_BIT) != 0;}
+bool get_datatype_info_c::is_ANY_SAFEBIT(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_ANY_BIT)) != 0;}
+bool get_datatype_info_c::is_ANY_BIT_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_ANY_BIT)) != 0;}
 
+bool get_datatype_info_c::is_TIME(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_TIME) != 0;}
+bool get_datatype_info_c::is_SAFETIME(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_TIME)) != 0;}
+bool get_datatype_info_c::is_TIME_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_TIME)) != 0;}
 
+bool get_datatype_info_c::is_ANY_DATE(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_DATE) != 0;}
+bool get_datatype_info_c::is_ANY_SAFEDATE(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_DATE)) != 0;}
+bool get_datatype_info_c::is_ANY_DATE_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_DATE)) != 0;}
 
+bool get_datatype_info_c::is_ANY_STRING(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_STRING) != 0;}
+bool get_datatype_info_c::is_ANY_SAFESTRING(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_SAFE(tc_STRING)) != 0;}
+bool get_datatype_info_c::is_ANY_STRING_compatible(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_compatible(tc_STRING)) != 0;}
 
-
-bool get_datatype_info_c::is_ANY_unsigned_INT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(usint_type_name_c))       {return true;}
-  if (typeid(*type_symbol) == typeid(uint_type_name_c))        {return true;}
-  if (typeid(*type_symbol) == typeid(udint_type_name_c))       {return true;}
-  if (typeid(*type_symbol) == typeid(ulint_type_name_c))       {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_unsigned_SAFEINT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safeusint_type_name_c))   {return true;}
-  if (typeid(*type_symbol) == typeid(safeuint_type_name_c))    {return true;}
-  if (typeid(*type_symbol) == typeid(safeudint_type_name_c))   {return true;}
-  if (typeid(*type_symbol) == typeid(safeulint_type_name_c))   {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_unsigned_INT_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_unsigned_INT    (type_symbol))                    {return true;}
-  if (is_ANY_unsigned_SAFEINT(type_symbol))                    {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_REAL(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(real_type_name_c))        {return true;}
-  if (typeid(*type_symbol) == typeid(lreal_type_name_c))       {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFEREAL(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safereal_type_name_c))    {return true;}
-  if (typeid(*type_symbol) == typeid(safelreal_type_name_c))   {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_REAL_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_REAL    (type_symbol))                            {return true;}
-  if (is_ANY_SAFEREAL(type_symbol))                            {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_nBIT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(byte_type_name_c))        {return true;}
-  if (typeid(*type_symbol) == typeid(word_type_name_c))        {return true;}
-  if (typeid(*type_symbol) == typeid(dword_type_name_c))       {return true;}
-  if (typeid(*type_symbol) == typeid(lword_type_name_c))       {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFEnBIT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safebyte_type_name_c))    {return true;}
-  if (typeid(*type_symbol) == typeid(safeword_type_name_c))    {return true;}
-  if (typeid(*type_symbol) == typeid(safedword_type_name_c))   {return true;}
-  if (typeid(*type_symbol) == typeid(safelword_type_name_c))   {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_nBIT_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_nBIT    (type_symbol))                            {return true;}
-  if (is_ANY_SAFEnBIT(type_symbol))                            {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_BOOL(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(bool_type_name_c))        {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_SAFEBOOL(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safebool_type_name_c))    {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_BOOL_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_BOOL    (type_symbol))                                {return true;}
-  if (is_SAFEBOOL(type_symbol))                                {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_BIT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_BOOL    (type_symbol))                                {return true;}
-  if (is_ANY_nBIT(type_symbol))                                {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFEBIT(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_SAFEBOOL    (type_symbol))                            {return true;}
-  if (is_ANY_SAFEnBIT(type_symbol))                            {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_BIT_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_BIT    (type_symbol))                             {return true;}
-  if (is_ANY_SAFEBIT(type_symbol))                             {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_TIME(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(time_type_name_c))        {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_SAFETIME(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safetime_type_name_c))    {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_TIME_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_TIME    (type_symbol))                                {return true;}
-  if (is_SAFETIME(type_symbol))                                {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_DATE(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(date_type_name_c))        {return true;}
-  if (typeid(*type_symbol) == typeid(tod_type_name_c))         {return true;}
-  if (typeid(*type_symbol) == typeid(dt_type_name_c))          {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFEDATE(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safedate_type_name_c))    {return true;}
-  if (typeid(*type_symbol) == typeid(safetod_type_name_c))     {return true;}
-  if (typeid(*type_symbol) == typeid(safedt_type_name_c))      {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_DATE_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_DATE    (type_symbol))                            {return true;}
-  if (is_ANY_SAFEDATE(type_symbol))                            {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_ANY_STRING(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(string_type_name_c))      {return true;}
-  if (typeid(*type_symbol) == typeid(wstring_type_name_c))     {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_SAFESTRING(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(safestring_type_name_c))  {return true;}
-  if (typeid(*type_symbol) == typeid(safewstring_type_name_c)) {return true;}
-  return false;
-}
-
-
-bool get_datatype_info_c::is_ANY_STRING_compatible(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (is_ANY_STRING    (type_symbol))                          {return true;}
-  if (is_ANY_SAFESTRING(type_symbol))                          {return true;}
-  return false;
-}
-
-
-
-
-
-
-
-
-bool get_datatype_info_c::is_VOID(symbol_c *type_symbol) {
-  if (type_symbol == NULL)                                     {return false;}
-  if (typeid(*type_symbol) == typeid(void_type_name_c))        {return true;}
-  return false;
-}
-
-
-
-
-
-
+bool get_datatype_info_c::is_VOID(symbol_c *type_symbol) {return (type_categories(type_symbol) & tc_VOID) != 0;}
 
 
 
 /* Can't we do away with this?? */
 bool get_datatype_info_c::is_ANY_REAL_literal(symbol_c *type_symbol) {
   if (type_symbol == NULL)                              {return true;} /* Please make sure things will work correctly before changing this to false!! */
-  if (typeid(*type_symbol) == typeid(real_c))           {return true;}
-  if (typeid(*type_symbol) == typeid(neg_real_c))       {return true;}
-  return false;
+  return (type_categories(type_symbol) & tc_REAL_literal) != 0;
 }
 
 /* Can't we do away with this?? */
 bool get_datatype_info_c::is_ANY_INT_literal(symbol_c *type_symbol) {
   if (type_symbol == NULL)                              {return true;} /* Please make sure things will work correctly before changing this to false!! */
-  if (typeid(*type_symbol) == typeid(integer_c))        {return true;}
-  if (typeid(*type_symbol) == typeid(neg_integer_c))    {return true;}
-  if (typeid(*type_symbol) == typeid(binary_integer_c)) {return true;}
-  if (typeid(*type_symbol) == typeid(octal_integer_c))  {return true;}
-  if (typeid(*type_symbol) == typeid(hex_integer_c))    {return true;}
-  return false;
+  return (type_categories(type_symbol) & tc_INT_literal) != 0;
 }
 
 
@@ -90,7 +90,7 @@
 /* This class is a singleton.
  * So we need a pointer to the singe instance...
  */
-get_sizeof_datatype_c *get_sizeof_datatype_c::singleton = NULL;
+thread_local get_sizeof_datatype_c *get_sizeof_datatype_c::singleton = NULL;
 
 
 #define _encode_int(value)   ((void *)(((char *)NULL) + value))
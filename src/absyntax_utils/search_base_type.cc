@@ -50,11 +50,11 @@
 
 
 /* pointer to singleton instance */
-search_base_type_c *search_base_type_c::search_base_type_singleton = NULL;
+thread_local search_base_type_c *search_base_type_c::search_base_type_singleton = NULL;
 
 
 
-search_base_type_c::search_base_type_c(void) {current_basetype_name = NULL; current_basetype = NULL; current_equivtype = NULL;}
+search_base_type_c::search_base_type_c(void) {current_basetype_name = NULL; current_basetype = NULL; current_equivtype = NULL; caching = false; unresolved = false;}
 
 /* static method! */
 void search_base_type_c::create_singleton(void) {
@@ -98,6 +98,48 @@ symbol_c *search_base_type_c::get_basetype_id  (symbol_c *symbol) {
 
 
 
+/* static method! */
+void search_base_type_c::cache_basetypes(symbol_c *tree_root) {
+  class cache_basetypes_c: public iterator_visitor_c {
+    private:
+      bool clear;
+
+      void cache(token_c *type_name, symbol_c *type_decl, symbol_c *&basetype_decl, symbol_c *&basetype_id, symbol_c *&equivtype_decl) {
+        basetype_decl = basetype_id = equivtype_decl = NULL;
+        if (clear || (NULL == type_decl)) return;
+        search_base_type_singleton->current_basetype_name = NULL;
+        search_base_type_singleton->current_basetype  = NULL;
+        search_base_type_singleton->current_equivtype = NULL;
+        search_base_type_singleton->unresolved = false;
+        symbol_c *basetype = (symbol_c *)search_base_type_singleton->handle_datatype_identifier(type_name, type_decl);
+        /* leave the identifiers whose chain of declarations is incomplete for stage3 to report */
+        if ((NULL == basetype) || search_base_type_singleton->unresolved) return;
+        basetype_id    = search_base_type_singleton->current_basetype_name;
+        equivtype_decl = search_base_type_singleton->current_equivtype;
+        basetype_decl  = basetype;
+      }
+
+    public:
+      cache_basetypes_c(bool clear_) {clear = clear_;}
+      void *visit(derived_datatype_identifier_c *symbol) {cache(symbol, symbol->decl, symbol->basetype_decl, symbol->basetype_id, symbol->equivtype_decl); return NULL;}
+      void *visit(         poutype_identifier_c *symbol) {cache(symbol, symbol->decl, symbol->basetype_decl, symbol->basetype_id, symbol->equivtype_decl); return NULL;}
+  };
+
+  create_singleton();
+  if (NULL == tree_root) return;
+  /* First drop whatever was cached by a previous call, as the identifiers met while resolving
+   * another identifier use their cached base type when they have one.
+   */
+  cache_basetypes_c clear_cache(true);
+  tree_root->accept(clear_cache);
+  search_base_type_singleton->caching = true;
+  cache_basetypes_c fill_cache(false);
+  tree_root->accept(fill_cache);
+  search_base_type_singleton->caching = false;
+}
+
+
+
 /*************************/
 /* B.1 - Common elements */
 /*************************/
@@ -106,14 +148,33 @@ symbol_c *search_base_type_c::get_basetype_id  (symbol_c *symbol) {
 /* B 1.1 - Letters, digits and identifiers */
 /*******************************************/
 
+/* Apply what resolving a type identifier (from a clean state) was found to do, as stored by cache_basetypes().
+ * All the visitors that may lead to a type identifier return whatever the identifier returns, so apart from the
+ * returned base type, resolving the identifier only leaves behind a new current_basetype_name and, possibly, a
+ * current_equivtype. The latter is always overwritten by a subrange_type_declaration_c, and otherwise only set
+ * when still NULL.
+ */
+void *search_base_type_c::handle_cached_basetype(symbol_c *basetype_decl, symbol_c *basetype_id, symbol_c *equivtype_decl) {
+  this->current_basetype_name = basetype_id;
+  this->current_basetype  = NULL; 
+  if ((NULL != equivtype_decl) && ((NULL == this->current_equivtype) || (NULL != dynamic_cast<subrange_type_declaration_c *>(equivtype_decl))))
+    this->current_equivtype = equivtype_decl;
+  return basetype_decl;
+}
+
+
 
-void *search_base_type_c::handle_datatype_identifier(token_c *type_name) {
+void *search_base_type_c::handle_datatype_identifier(token_c *type_name, symbol_c *type_decl) {
   this->current_basetype_name = type_name;
   /* if we have reached this point, it is because the current_basetype is not yet pointing to the base datatype we are looking for,
    * so we will be searching for the delcaration of the type named in type_name, which might be the base datatype (we search recursively!)
    */
   this->current_basetype  = NULL; 
   
+  /* use the declaration already resolved by absyntax_utils_init(), if available... */
+  if (NULL != type_decl)
+    return type_decl->accept(*this);
+
   /* look up the type declaration... */
   type_symtable_t::iterator iter1 = type_symtable.find(type_name);
   if (iter1 != type_symtable.end())
@@ -124,14 +185,22 @@ void *search_base_type_c::handle_datatype_identifier(token_c *type_name) {
     return iter2->second->accept(*this); // iter2->second is the type_decl 
   
   /* Type declaration not found!! */
+  if (caching) {unresolved = true; return NULL;}
   ERROR;
     
   return NULL;
 }
 
 void *search_base_type_c::visit(                 identifier_c *type_name) {return handle_datatype_identifier(type_name);}  
-void *search_base_type_c::visit(derived_datatype_identifier_c *type_name) {return handle_datatype_identifier(type_name);}  
-void *search_base_type_c::visit(         poutype_identifier_c *type_name) {return handle_datatype_identifier(type_name);}  
+void *search_base_type_c::visit(derived_datatype_identifier_c *type_name) {
+  if (NULL != type_name->basetype_decl) return handle_cached_basetype(type_name->basetype_decl, type_name->basetype_id, type_name->equivtype_decl);
+  return handle_datatype_identifier(type_name, type_name->decl);
+}
+
+void *search_base_type_c::visit(         poutype_identifier_c *type_name) {
+  if (NULL != type_name->basetype_decl) return handle_cached_basetype(type_name->basetype_decl, type_name->basetype_id, type_name->equivtype_decl);
+  return handle_datatype_identifier(type_name, type_name->decl);
+}
 
 
 /*********************/
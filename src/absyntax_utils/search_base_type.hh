@@ -70,11 +70,15 @@ class search_base_type_c: public null_visitor_c {
     symbol_c *current_basetype_name;
     symbol_c *current_basetype;
     symbol_c *current_equivtype;
-    static search_base_type_c *search_base_type_singleton; // Make this a singleton class!
+    /* set while cache_basetypes() is running, when a type identifier that has not been declared must not be an ERROR */
+    bool caching;
+    bool unresolved;
+    static thread_local search_base_type_c *search_base_type_singleton; // Make this a singleton class! (one per thread)
     
   private:  
     static void create_singleton(void);
-    void *handle_datatype_identifier(token_c *type_name);
+    void *handle_datatype_identifier(token_c *type_name, symbol_c *type_decl = NULL);
+    void *handle_cached_basetype(symbol_c *basetype_decl, symbol_c *basetype_id, symbol_c *equivtype_decl);
 
   public:
     search_base_type_c(void);
@@ -82,6 +86,13 @@ class search_base_type_c: public null_visitor_c {
     static symbol_c *get_basetype_decl (symbol_c *symbol);  /* get the Base       Type declaration */
     static symbol_c *get_basetype_id   (symbol_c *symbol);  /* get the Base       Type identifier  */
 
+    /* Resolve (and store in basetype_decl, basetype_id and equivtype_decl) the base type of every
+     * derived_datatype_identifier_c and poutype_identifier_c in the tree, so the above methods no longer
+     * need to walk the chain of type declarations each time they are given one of these identifiers.
+     * Called by absyntax_utils_init(), once the decl of each identifier has been set.
+     */
+    static void cache_basetypes(symbol_c *tree_root);
+
   public:
   /*************************/
   /* B.1 - Common elements */
@@ -40,12 +40,19 @@
  *     - instruction_list_c
  *
  * which is where all calls to search for a specific label will look for said label.
+ *
+ * Machine generated IL may have thousands of labels and jumps, so instead of walking
+ * through the IL list for every label being searched, the constructor walks through
+ * it once, building an index mapping the (upper case) name of each label to the
+ * il_instruction_c containing it.
  */
 
 
 
 #include "absyntax_utils.hh"
 
+#include <cctype>
+
 
 
 /* set to 1 to see debug info during execution */
@@ -53,23 +60,34 @@ static int debug = 0;
 
 search_il_label_c::search_il_label_c(symbol_c *search_scope) {
   this->search_scope = search_scope;
-  this->search_label = NULL;
+  this->building = true;
+  search_scope->accept(*this);
+  this->building = false;
 }
 
 search_il_label_c::~search_il_label_c(void) {
 }
 
 
+/* Labels are case insensitive, so the index is keyed by the upper case name. */
+static std::string index_key(std::string_view label) {
+  std::string key(label);
+  for (char &c : key) c = std::toupper(static_cast<unsigned char>(c));
+  return key;
+}
+
+
 il_instruction_c *search_il_label_c::find_label(const char *label) {
-  return find_label(new identifier_c(label));
+  std::unordered_map<std::string, il_instruction_c *>::const_iterator entry = label_index.find(index_key(matiec::sv_or_empty(label)));
+  return (entry == label_index.end())? NULL : entry->second;
 }
 
 
 il_instruction_c *search_il_label_c::find_label(symbol_c *label) {
-  search_label = label;
-  il_instruction_c *res = (il_instruction_c *)search_scope->accept(*this);
-  search_label = NULL;
-  return res;
+  token_c *name = dynamic_cast<token_c *>(label);
+  if (NULL == name) return NULL;
+  std::unordered_map<std::string, il_instruction_c *>::const_iterator entry = label_index.find(index_key(matiec::sv_or_empty(name->value)));
+  return (entry == label_index.end())? NULL : entry->second;
 }
 
 
@@ -84,14 +102,13 @@ il_instruction_c *search_il_label_c::find_label(symbol_c *label) {
 // SYM_REF2(il_instruction_c, label, il_instruction)
 // void *visit(instruction_list_c *symbol);
 void *search_il_label_c::visit(il_instruction_c *symbol) {
-// printf("search_il_label_c::visit(il_instruction_c *symbol): searching for %s\n", ((identifier_c *)search_label)->value);
-	if (NULL != symbol->label)
-		if (compare_identifiers(search_label, symbol->label) == 0)
-			return symbol;
+	/* While building the index, the first il_instruction_c with each label is kept (just like the
+	 * walk that searched for a single label used to do), and NULL is always returned so the walk
+	 * continues through all the IL instructions.
+	 */
+	token_c *label = dynamic_cast<token_c *>(symbol->label);
+	if (building && (NULL != label))
+		label_index.emplace(index_key(matiec::sv_or_empty(label->value)), symbol);
 
 	return NULL;
 }
-
-
-
-
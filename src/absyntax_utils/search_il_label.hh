@@ -41,11 +41,18 @@
  *     - instruction_list_c
  *
  * which is where all calls to search for a specific label will look for said label.
+ *
+ * Machine generated IL may have thousands of labels and jumps, so instead of walking
+ * through the IL list for every label being searched, the constructor walks through
+ * it once, building an index mapping the (upper case) name of each label to the
+ * il_instruction_c containing it.
  */
 
 
 
 #include "../absyntax_utils/absyntax_utils.hh"
+#include <string>
+#include <unordered_map>
 
 
 class search_il_label_c: public search_visitor_c {
@@ -53,7 +60,10 @@ class search_il_label_c: public search_visitor_c {
   private:
     search_varfb_instance_type_c *search_varfb_instance_type;
     symbol_c *search_scope;
-    symbol_c *search_label;
+    /* the label index of search_scope */
+    std::unordered_map<std::string, il_instruction_c *> label_index;
+    /* true while the constructor is building the label index */
+    bool building;
 
   public:
     search_il_label_c(symbol_c *search_scope);
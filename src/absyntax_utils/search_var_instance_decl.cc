@@ -89,24 +89,67 @@
 
 #include "absyntax_utils.hh"
 
+#include <cctype>
 
 
 
 
+
+std::unordered_map<const symbol_c *, search_var_instance_decl_c::scope_index_t> search_var_instance_decl_c::scope_indexes;
+
+
 search_var_instance_decl_c::search_var_instance_decl_c(symbol_c *search_scope) {
   this->current_vartype = none_vt;
   this->search_scope = search_scope;
   this->search_name = NULL;
   this->current_type_decl = NULL;
   this->current_option = none_opt;
+  this->building = NULL;
+  this->index = NULL;
+  std::unordered_map<const symbol_c *, scope_index_t>::const_iterator it = scope_indexes.find(search_scope);
+  if (it != scope_indexes.end())
+    this->index = &(it->second);
 }
 
-symbol_c *search_var_instance_decl_c::get_decl(symbol_c *variable) {
+/* Identifiers are case insensitive, so the index is keyed by the upper case name. */
+static std::string index_key(token_c *name) {
+  std::string key(matiec::sv_or_empty(name->value));
+  for (char &c : key) c = std::toupper(static_cast<unsigned char>(c));
+  return key;
+}
+
+symbol_c *search_var_instance_decl_c::search(symbol_c *variable) {
   this->current_vartype = none_vt;
   this->current_option  = none_opt;
   this->search_name = get_var_name_c::get_name(variable);
+  if (NULL == index) 
+    return (symbol_c *)search_scope->accept(*this);
+
+  token_c *name = dynamic_cast<token_c *>(search_name);
+  if (NULL == name) return NULL;
+  scope_index_t::const_iterator entry = index->find(index_key(name));
+  if (entry == index->end()) return NULL;
+  this->current_vartype = entry->second.vartype;
+  this->current_option  = entry->second.option;
+  return entry->second.decl;
+}
+
+void *search_var_instance_decl_c::found(symbol_c *name, symbol_c *decl) {
+  if (NULL == building)
+    return (compare_identifiers(name, search_name) == 0)? decl : NULL;
+
+  token_c *token = dynamic_cast<token_c *>(name);
+  /* the search would carry on looking for another declaration of the same name when decl is NULL,
+   * and would stop at the first one found otherwise.
+   */
+  if ((NULL != token) && (NULL != decl))
+    building->emplace(index_key(token), index_entry_t{decl, current_vartype, current_option});
+  return NULL;
+}
+
+symbol_c *search_var_instance_decl_c::get_decl(symbol_c *variable) {
   if (NULL == search_scope) return NULL; // NOTE: This is not an ERROR! declaration_check_c, for e.g., relies on this returning NULL!
-  return (symbol_c *)search_scope->accept(*this);
+  return search(variable);
 }
 
 symbol_c *search_var_instance_decl_c::get_basetype_decl(symbol_c *variable) {
@@ -114,25 +157,58 @@ symbol_c *search_var_instance_decl_c::get_basetype_decl(symbol_c *variable) {
 }
 
 search_var_instance_decl_c::vt_t search_var_instance_decl_c::get_vartype(symbol_c *variable) {
-  this->current_vartype = none_vt;
-  this->current_option  = none_opt;
-  this->search_name = get_var_name_c::get_name(variable);
   if (NULL == search_scope) ERROR;
-  search_scope->accept(*this);
+  search(variable);
   return this->current_vartype;
 }
 
 search_var_instance_decl_c::opt_t search_var_instance_decl_c::get_option(symbol_c *variable) {
-  this->current_vartype = none_vt;
-  this->current_option  = none_opt;
-  this->search_name = get_var_name_c::get_name(variable);
   if (NULL == search_scope) ERROR;
-  search_scope->accept(*this);
+  search(variable);
   return this->current_option;
 }
 
 
 
+/* static method! */
+void search_var_instance_decl_c::index_scope(symbol_c *scope) {
+  search_var_instance_decl_c search_decl(scope);
+  scope_index_t &index = scope_indexes[scope];
+  search_decl.building = &index;
+  search_decl.search_name = NULL;
+  scope->accept(search_decl);
+}
+
+/* static method! */
+void search_var_instance_decl_c::build_index(symbol_c *tree_root) {
+  reset_index();
+  library_c *library = dynamic_cast<library_c *>(tree_root);
+  if (NULL == library) return;
+
+  for (int i = 0; i < library->n; i++) {
+    symbol_c *element = library->get_element(i);
+    if (   (NULL != dynamic_cast<function_declaration_c       *>(element))
+        || (NULL != dynamic_cast<function_block_declaration_c *>(element))
+        || (NULL != dynamic_cast<program_declaration_c        *>(element)))
+      index_scope(element);
+
+    configuration_declaration_c *configuration = dynamic_cast<configuration_declaration_c *>(element);
+    if (NULL == configuration) continue;
+    index_scope(configuration);
+    list_c *resources = dynamic_cast<list_c *>(configuration->resource_declarations);
+    for (int j = 0; (NULL != resources) && (j < resources->n); j++)
+      if (NULL != dynamic_cast<resource_declaration_c *>(resources->get_element(j)))
+        index_scope(resources->get_element(j));
+  }
+}
+
+/* static method! */
+void search_var_instance_decl_c::reset_index(void) {
+  scope_indexes.clear();
+}
+
+
+
 
 /***************************/
 /* B 0 - Programming Model */
@@ -209,16 +285,12 @@ void *search_var_instance_decl_c::visit(input_output_declarations_c *symbol) {
 
 /* ENO : BOOL */
 void *search_var_instance_decl_c::visit(eno_param_declaration_c *symbol) {
-  if (compare_identifiers(symbol->name, search_name) == 0)
-    return symbol->type;
-  return NULL;
+  return found(symbol->name, symbol->type);
 }
 
 /* EN : BOOL */
 void *search_var_instance_decl_c::visit(en_param_declaration_c *symbol) {
-  if (compare_identifiers(symbol->name, search_name) == 0)
-    return symbol->type_decl;
-  return NULL;
+  return found(symbol->name, symbol->type_decl);
 }
 
 /* VAR [CONSTANT] var_init_decl_list END_VAR */
@@ -313,7 +385,7 @@ void *search_var_instance_decl_c::visit(var1_init_decl_c *symbol) {
 void *search_var_instance_decl_c::visit(var1_list_c *symbol) {
   list_c *list = symbol;
   for(int i = 0; i < list->n; i++) {
-    if (compare_identifiers(list->get_element(i), search_name) == 0)
+    if (found(list->get_element(i), current_type_decl) != NULL)
    /* by now, current_type_decl should be != NULL */
       return current_type_decl;
   }
@@ -335,7 +407,7 @@ void *search_var_instance_decl_c::visit(fb_name_decl_c *symbol) {
 void *search_var_instance_decl_c::visit(fb_name_list_c *symbol) {
   list_c *list = symbol;
   for(int i = 0; i < list->n; i++) {
-    if (compare_identifiers(list->get_element(i), search_name) == 0)
+    if (found(list->get_element(i), current_type_decl) != NULL)
     /* by now, current_fb_declaration should be != NULL */
       return current_type_decl;
   }
@@ -378,9 +450,7 @@ void *search_var_instance_decl_c::visit(structured_var_declaration_c *symbol) {
 /*  global_var_name ':' (simple_specification|subrange_specification|enumerated_specification|array_specification|prev_declared_structure_type_name|function_block_type_name */
 // SYM_REF2(external_declaration_c, global_var_name, specification)
 void *search_var_instance_decl_c::visit(external_declaration_c *symbol) {
-  if (compare_identifiers(symbol->global_var_name, search_name) == 0)
-      return symbol->specification;
-  return NULL;
+  return found(symbol->global_var_name, symbol->specification);
 }
 
 /*| global_var_spec ':' [located_var_spec_init|function_block_type_name] */
@@ -398,7 +468,7 @@ void *search_var_instance_decl_c::visit(global_var_decl_c *symbol) {
 /*| global_var_name location */
 //SYM_REF2(global_var_spec_c, global_var_name, location)
 void *search_var_instance_decl_c::visit(global_var_spec_c *symbol) {
-  if (symbol->global_var_name != NULL && compare_identifiers(symbol->global_var_name, search_name) == 0)
+  if (symbol->global_var_name != NULL && found(symbol->global_var_name, current_type_decl) != NULL)
       return current_type_decl;
   else
     return symbol->location->accept(*this);
@@ -409,7 +479,7 @@ void *search_var_instance_decl_c::visit(global_var_spec_c *symbol) {
 void *search_var_instance_decl_c::visit(global_var_list_c *symbol) {
   list_c *list = symbol;
   for(int i = 0; i < list->n; i++) {
-    if (compare_identifiers(list->get_element(i), search_name) == 0)
+    if (found(list->get_element(i), current_type_decl) != NULL)
       /* by now, current_type_decl should be != NULL */
       return current_type_decl;
   }
@@ -420,7 +490,7 @@ void *search_var_instance_decl_c::visit(global_var_list_c *symbol) {
 /* variable_name -> may be NULL ! */
 //SYM_REF4(located_var_decl_c, variable_name, location, located_var_spec_init, unused)
 void *search_var_instance_decl_c::visit(located_var_decl_c *symbol) {
-  if (symbol->variable_name != NULL && compare_identifiers(symbol->variable_name, search_name) == 0)
+  if (symbol->variable_name != NULL && found(symbol->variable_name, symbol->located_var_spec_init) != NULL)
     return symbol->located_var_spec_init;
   else {
     current_type_decl = symbol->located_var_spec_init;
@@ -436,10 +506,7 @@ void *search_var_instance_decl_c::visit(located_var_decl_c *symbol) {
 /*  AT direct_variable */
 // SYM_REF2(location_c, direct_variable, unused)
 void *search_var_instance_decl_c::visit(location_c *symbol) {
-  if (compare_identifiers(symbol->direct_variable, search_name) == 0)
-    return current_type_decl;
-  else
-    return NULL;
+  return found(symbol->direct_variable, current_type_decl);
 }
         
 /*| global_var_list ',' global_var_name */
@@ -492,7 +559,7 @@ void *search_var_instance_decl_c::visit(function_declaration_c *symbol) {
   /* functions have a variable named after themselves, to store
    * the variable that will be returned!!
    */
-  if (compare_identifiers(symbol->derived_function_name, search_name) == 0)
+  if (found(symbol->derived_function_name, symbol->type_name) != NULL)
       return symbol->type_name;
 
   /* no need to search through all the body, so we only
@@ -513,6 +580,7 @@ void *search_var_instance_decl_c::visit(function_block_declaration_c *symbol) {
     return res;
   
   /* not yet found, so we look into the body, to see if it is an SFC step! */
+  if (NULL == symbol->fblock_body) return NULL;
   return symbol->fblock_body->accept(*this);
 }
 
@@ -528,6 +596,7 @@ void *search_var_instance_decl_c::visit(program_declaration_c *symbol) {
     return res;
   
   /* not yet found, so we look into the body, to see if it is an SFC step! */
+  if (NULL == symbol->function_block_body) return NULL;
   return symbol->function_block_body->accept(*this);
 }
 
@@ -549,17 +618,13 @@ void *search_var_instance_decl_c::visit(program_declaration_c *symbol) {
 /* INITIAL_STEP step_name ':' action_association_list END_STEP */
 // SYM_REF2(initial_step_c, step_name, action_association_list)
 void *search_var_instance_decl_c::visit(initial_step_c *symbol) {
-  if (compare_identifiers(symbol->step_name, search_name) == 0)
-      return symbol;
-  return NULL;
+  return found(symbol->step_name, symbol);
 }
 
 /* STEP step_name ':' action_association_list END_STEP */
 // SYM_REF2(step_c, step_name, action_association_list)
 void *search_var_instance_decl_c::visit(step_c *symbol) {
-  if (compare_identifiers(symbol->step_name, search_name) == 0)
-      return symbol;
-  return NULL;
+  return found(symbol->step_name, symbol);
 }
 
 
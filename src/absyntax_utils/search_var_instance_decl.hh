@@ -87,6 +87,21 @@
  * we return a reference to the declaration!!
  */
 
+/* Note:
+ *  Searching a scope by walking through all its VAR* END_VAR blocks is linear in the
+ * number of variables declared in the scope, and is done for every variable reference.
+ * absyntax_utils_init() therefore builds, once for every POU, configuration and resource
+ * in the library, an index mapping the (upper case) name of each variable declared in it
+ * to what the walk would find. Every search_var_instance_decl_c object searching one of these
+ * scopes then uses the index instead of walking the declarations.
+ * The index is built before (and only read during) stage3 and stage4, so it may be shared
+ * by several threads.
+ */
+
+
+#include <string>
+#include <unordered_map>
+
 
 class search_var_instance_decl_c: public search_visitor_c {
 
@@ -135,6 +150,34 @@ class search_var_instance_decl_c: public search_visitor_c {
     vt_t      get_vartype       (symbol_c *variable_instance_name);
     opt_t     get_option        (symbol_c *variable_instance_name);
 
+    /* (Re)build the index of the declarations of every POU, configuration and resource in the library. */
+    static void build_index(symbol_c *tree_root);
+    static void reset_index(void);
+
+  private:
+    typedef struct {
+      symbol_c *decl;
+      vt_t      vartype;
+      opt_t     option;
+    } index_entry_t;
+    typedef std::unordered_map<std::string, index_entry_t> scope_index_t;
+
+    /* the index of each scope, keyed by the scope symbol */
+    static std::unordered_map<const symbol_c *, scope_index_t> scope_indexes;
+
+    static void index_scope(symbol_c *scope);
+
+    /* the index of search_scope, or NULL if search_scope has not been indexed. */
+    const scope_index_t *index;
+    /* the index being built, while index_scope() walks through the declarations of a scope. */
+    scope_index_t *building;
+
+    symbol_c *search(symbol_c *variable_instance_name);
+    /* Returns decl if name is the name being searched for.
+     * While building an index, adds name to the index instead, and always returns NULL so the walk visits all the declarations.
+     */
+    void *found(symbol_c *name, symbol_c *decl);
+
   private:
     symbol_c *search_scope;
     symbol_c *search_name;
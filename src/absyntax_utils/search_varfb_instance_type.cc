@@ -87,6 +87,76 @@
 
 #include "absyntax_utils.hh"
 
+#include <cctype>
+#include <mutex>
+
+
+search_varfb_instance_type_c::field_cache_t search_varfb_instance_type_c::field_cache;
+bool                                        search_varfb_instance_type_c::field_cache_enabled = false;
+std::shared_mutex                           search_varfb_instance_type_c::field_cache_mutex;
+
+
+/* static method! */
+void search_varfb_instance_type_c::enable_field_cache(void) {
+  std::unique_lock<std::shared_mutex> lock(field_cache_mutex);
+  field_cache.clear();
+  field_cache_enabled = true;
+}
+
+/* static method! */
+void search_varfb_instance_type_c::disable_field_cache(void) {
+  std::unique_lock<std::shared_mutex> lock(field_cache_mutex);
+  field_cache.clear();
+  field_cache_enabled = false;
+}
+
+
+/* Only the fields of structures and of function blocks are cached, as only the search through
+ * these declarations does not depend on the search scope.
+ * Returns the key of the field, or an empty string if the field may not be cached.
+ */
+static std::string field_key(symbol_c *record_decl, symbol_c *field_selector) {
+  if (   (NULL == dynamic_cast<structure_element_declaration_list_c *>(record_decl))
+      && (NULL == dynamic_cast<function_block_declaration_c         *>(record_decl)))
+    return std::string();
+  token_c *field_name = dynamic_cast<token_c *>(field_selector);
+  if (NULL == field_name) return std::string();
+  /* identifiers are case insensitive... */
+  std::string key(matiec::sv_or_empty(field_name->value));
+  for (char &c : key) c = std::toupper(static_cast<unsigned char>(c));
+  /* ...and never empty, so the empty string may be used to signal a field that may not be cached. */
+  key.insert(0, 1, '.');
+  return key;
+}
+
+
+bool search_varfb_instance_type_c::lookup_field(symbol_c *record_decl, symbol_c *field_selector) {
+  std::string key = field_key(record_decl, field_selector);
+  if (key.empty()) return false;
+
+  std::shared_lock<std::shared_mutex> lock(field_cache_mutex);
+  if (!field_cache_enabled) return false;
+  field_cache_t::const_iterator record = field_cache.find(record_decl);
+  if (record == field_cache.end()) return false;
+  std::unordered_map<std::string, field_t>::const_iterator field = record->second.find(key);
+  if (field == record->second.end()) return false;
+  current_type_id       = field->second.type_id;
+  current_basetype_decl = field->second.basetype_decl;
+  current_basetype_id   = field->second.basetype_id;
+  return true;
+}
+
+
+void search_varfb_instance_type_c::remember_field(symbol_c *record_decl, symbol_c *field_selector) {
+  std::string key = field_key(record_decl, field_selector);
+  if (key.empty()) return;
+
+  std::unique_lock<std::shared_mutex> lock(field_cache_mutex);
+  if (!field_cache_enabled) return;
+  field_t field = {current_type_id, current_basetype_decl, current_basetype_id};
+  field_cache[record_decl].emplace(key, field);
+}
+
 
 void search_varfb_instance_type_c::init(void) {
   this->current_type_id        = NULL;
@@ -337,10 +407,11 @@ void *search_varfb_instance_type_c::visit(structured_variable_c *symbol) {
   this->init(); /* set all current_*** pointers to NULL ! */
   
   /* Now we search for the data type of the field... But only if we were able to determine the data type of the variable */
-  if (NULL != basetype_decl) {
+  if ((NULL != basetype_decl) && !lookup_field(basetype_decl, symbol->field_selector)) {
     current_field_selector = symbol->field_selector;
     basetype_decl->accept(*this);
     current_field_selector = NULL;
+    remember_field(basetype_decl, symbol->field_selector);
   }
   
   return NULL;
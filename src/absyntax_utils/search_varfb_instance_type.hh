@@ -85,6 +85,23 @@
  *   get_type_decl()      ---> returns 1B 
  */ 
 
+/* Note:
+ *   The type of a field of a structure or of a function block only depends on the
+ * declaration of the structure (or function block) and on the name of the field, and
+ * not on the scope in which the structured variable is declared. Every field resolved
+ * through a structured_variable_c (e.g. each step of motor[i].drive.status.word) is therefore
+ * remembered, and later searches of the same field of the same declaration, by any
+ * search_varfb_instance_type_c object, no longer search through the declaration.
+ *
+ *   This field cache stores raw pointers into the AST. It is only used between
+ * absyntax_utils_init() and absyntax_utils_reset(), which clear it, and may be used by
+ * several threads at the same time.
+ */
+
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
 class search_varfb_instance_type_c : null_visitor_c {
 
   private:
@@ -100,6 +117,28 @@ class search_varfb_instance_type_c : null_visitor_c {
     /* sets all the above variables to NULL, or false */
     void init(void);
 
+  private:
+    typedef struct {
+      symbol_c *type_id;
+      symbol_c *basetype_decl;
+      symbol_c *basetype_id;
+    } field_t;
+    /* the fields of each declaration, keyed by the (upper case) field name */
+    typedef std::unordered_map<const symbol_c *, std::unordered_map<std::string, field_t> > field_cache_t;
+
+    static field_cache_t     field_cache;
+    static bool              field_cache_enabled;
+    static std::shared_mutex field_cache_mutex;
+
+    /* Set the current_*** pointers to the cached type of the field of record_decl. Returns false if it is not cached. */
+    bool lookup_field  (symbol_c *record_decl, symbol_c *field_selector);
+    void remember_field(symbol_c *record_decl, symbol_c *field_selector);
+
+  public:
+    /* Enable (and clear) / disable (and clear) the field cache. */
+    static void enable_field_cache (void);
+    static void disable_field_cache(void);
+
   public:
     search_varfb_instance_type_c(symbol_c *search_scope );
     symbol_c *get_basetype_decl (symbol_c *variable_name);
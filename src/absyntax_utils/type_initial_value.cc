@@ -56,6 +56,8 @@
  */
 
 
+#include <mutex>
+
 #include "absyntax_utils.hh"
 
 //#define DEBUG
@@ -66,10 +68,16 @@
 #endif
 
 
+/* NOTE: Stage 4 may generate the code of several POUs in parallel, so the singleton is created only once
+ *       (by whichever thread gets here first). The visitor itself keeps no state.
+ */
 type_initial_value_c *type_initial_value_c::instance(void) {
-  if (_instance != NULL)
-    return _instance;
+  static std::once_flag created;
+  std::call_once(created, create_instance);
+  return _instance;
+}
 
+void type_initial_value_c::create_instance(void) {
   _instance = new type_initial_value_c;
 
   null_literal = new ref_value_null_literal_c();
@@ -107,8 +115,6 @@ type_initial_value_c *type_initial_value_c::instance(void) {
   matiec::ast_pin(dt_0);
   matiec::ast_pin(string_0);
   matiec::ast_pin(wstring_0);
-
-  return _instance;
 }
 
 type_initial_value_c::type_initial_value_c(void) {}
@@ -148,7 +154,11 @@ void *type_initial_value_c::handle_type_name(symbol_c *type_name) {
 /* AST using either poutype_identifier_c or derived_datatype_identifier_c. In principe, the following should not be necesasry  */
 void *type_initial_value_c::visit(                 identifier_c *symbol) {return handle_type_name(symbol);} /* should never occur */
 void *type_initial_value_c::visit(         poutype_identifier_c *symbol) {return handle_type_name(symbol);} /* in practice it might never get called, as FB, Functions and Programs do not have initial value  */
-void *type_initial_value_c::visit(derived_datatype_identifier_c *symbol) {return handle_type_name(symbol);}
+void *type_initial_value_c::visit(derived_datatype_identifier_c *symbol) {
+  /* use the declaration already resolved by absyntax_utils_init(), if available... */
+  if (NULL != symbol->decl) return symbol->decl->accept(*this);
+  return handle_type_name(symbol);
+}
 
 /***********************************/
 /* B 1.3.1 - Elementary Data Types */
@@ -134,9 +134,13 @@ typedef struct {
 
     /* Error reporting */
     bool full_token_location;          /**< Full token location in errors (-f) */
+    int max_errors;                    /**< Stop after reporting this many errors, 0 for no limit (--max-errors) */
 
-    /* Reserved for future use */
-    void *reserved[8];
+    /* Output dependencies */
+    const char *dependency_file;       /**< Write a Makefile style dependency file, NULL for none (--dep-file) */
+
+    /* Reserved for future use (max_errors and dependency_file took the space of two of these) */
+    void *reserved[6];
 } matiec_options_t;
 
 /**
@@ -216,6 +220,88 @@ MATIEC_API matiec_error_t matiec_compile_string(
     matiec_result_t *result
 );
 
+/**
+ * @brief Check an IEC 61131-3 source file, without generating any code
+ *
+ * Runs the parser and the semantic analysis only (no output files are
+ * written), for tools that just want the diagnostics, e.g. an editor
+ * checking the source as it is being typed. The diagnostics are reported
+ * through the error callback (see matiec_set_error_callback()) as each
+ * analysis pass completes over the whole source (the passes that are run
+ * together on each POU report once they have all completed), and the first
+ * error is stored in result.
+ *
+ * When pou_name names a POU (or configuration) of the source, only that
+ * POU is analysed: the other POUs are still parsed, and calls to them are
+ * checked against their declarations, but their bodies are not analysed
+ * and none of their diagnostics are reported. When pou_name is NULL, or
+ * names no POU of the source, the whole source is analysed.
+ *
+ * @param input_file    Path to input file (.st, .il, etc.)
+ * @param pou_name      Name of the POU to analyse (NULL for all of them)
+ * @param opts          Compiler options (NULL for defaults)
+ * @param result        Output result structure
+ * @return              MATIEC_OK if no errors were found, error code otherwise
+ */
+MATIEC_API matiec_error_t matiec_check_file(
+    const char *input_file,
+    const char *pou_name,
+    const matiec_options_t *opts,
+    matiec_result_t *result
+);
+
+/**
+ * @brief Check IEC 61131-3 source code from a string, without generating any code
+ *
+ * Same as matiec_check_file(), for source code held in memory.
+ *
+ * @param source        Source code string
+ * @param source_len    Length of source string (0 for null-terminated)
+ * @param source_name   Virtual filename for error messages
+ * @param pou_name      Name of the POU to analyse (NULL for all of them)
+ * @param opts          Compiler options (NULL for defaults)
+ * @param result        Output result structure
+ * @return              MATIEC_OK if no errors were found, error code otherwise
+ */
+MATIEC_API matiec_error_t matiec_check_string(
+    const char *source,
+    size_t source_len,
+    const char *source_name,
+    const char *pou_name,
+    const matiec_options_t *opts,
+    matiec_result_t *result
+);
+
+/**
+ * @brief Report the memory used by the abstract syntax tree of a source file
+ *
+ * Diagnostic run: parses and semantically checks the file (no code is
+ * generated), then reports, per AST node class, the number of instances,
+ * the bytes they use (including owned strings and vectors) and how much of
+ * that is spent on semantic annotations, followed by the largest lists.
+ * Same report as `iec2c --ast-stats`.
+ *
+ * @param input_file    Path to input file (.st, .il, etc.)
+ * @param opts          Compiler options (NULL for defaults)
+ * @param result        Output result structure
+ * @param report        Receives the report text (NULL if the file could not be
+ *                      parsed). Free with matiec_string_free().
+ * @return              MATIEC_OK on success, error code otherwise
+ */
+MATIEC_API matiec_error_t matiec_ast_stats_file(
+    const char *input_file,
+    const matiec_options_t *opts,
+    matiec_result_t *result,
+    char **report
+);
+
+/**
+ * @brief Free a string returned by the library
+ *
+ * @param str       String to free (NULL is ignored)
+ */
+MATIEC_API void matiec_string_free(char *str);
+
 /**
  * @brief Free resources allocated in a result structure
  *
@@ -14,6 +14,12 @@
 
 namespace matiec::types {
 
+/* Handle of a type interned in a TypeRegistry (see TypeRegistry::intern()).
+ * Only meaningful together with the registry that handed it out.
+ */
+using TypeId = uint32_t;
+inline constexpr TypeId kNoType = 0;
+
 enum class TypeCategory : uint8_t {
     Bool,
     Byte,
@@ -5,16 +5,24 @@
 #ifndef MATIEC_TYPES_TYPE_REGISTRY_HPP
 #define MATIEC_TYPES_TYPE_REGISTRY_HPP
 
-#include <cctype>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "matiec/types/type.hpp"
 
 namespace matiec::types {
 
+/* Types are interned: each distinct Type object is stored once, and is
+ * addressed by a 32 bit TypeId, so that annotations may keep the id instead
+ * of a shared_ptr. Name lookups are case-insensitive, and hash the name as
+ * it is folded to upper case, without building a normalized copy of it.
+ *
+ * Lookups are const and may run concurrently; registering types may not.
+ */
 class TypeRegistry {
 public:
     TypeRegistry();
@@ -27,6 +35,15 @@ public:
     [[nodiscard]] std::shared_ptr<const Type> getTime() const noexcept { return time_type_; }
 
     [[nodiscard]] std::shared_ptr<const Type> findType(std::string_view name) const;
+    /* kNoType if no type is registered with that name */
+    [[nodiscard]] TypeId findTypeId(std::string_view name) const noexcept;
+
+    /* The type interned with that id (NULL for kNoType, or an unknown id) */
+    [[nodiscard]] const Type* type(TypeId id) const noexcept;
+    /* The id of an interned type (kNoType if it was never interned) */
+    [[nodiscard]] TypeId idOf(const Type* type) const noexcept;
+    /* Intern a type, returning the id it already had if it was interned before */
+    TypeId intern(std::shared_ptr<const Type> type);
 
     void registerType(std::string name, std::shared_ptr<const Type> type);
 
@@ -43,9 +60,22 @@ public:
         std::vector<EnumType::Enumerator> enumerators);
 
 private:
-    static std::string normalize(std::string_view name);
+    struct NameEntry {
+        std::string name;
+        TypeId id;
+    };
 
-    std::unordered_map<std::string, std::shared_ptr<const Type>> types_;
+    static constexpr char fold(char ch) noexcept {
+        return (ch >= 'a' && ch <= 'z') ? static_cast<char>(ch - 'a' + 'A') : ch;
+    }
+    static size_t foldedHash(std::string_view name) noexcept;
+    static bool foldedEqual(std::string_view a, std::string_view b) noexcept;
+
+    /* indexed by TypeId, entry 0 (kNoType) is always empty */
+    std::vector<std::shared_ptr<const Type>> interned_;
+    std::unordered_map<const Type*, TypeId> ids_;
+    /* keyed by foldedHash() of the name */
+    std::unordered_multimap<size_t, NameEntry> names_;
     std::shared_ptr<const Type> bool_type_;
     std::shared_ptr<const Type> int_type_;
     std::shared_ptr<const Type> dint_type_;
@@ -54,16 +84,29 @@ private:
     std::shared_ptr<const Type> time_type_;
 };
 
-inline std::string TypeRegistry::normalize(std::string_view name) {
-    std::string out;
-    out.reserve(name.size());
+/* FNV-1a, on the upper case version of the name */
+inline size_t TypeRegistry::foldedHash(std::string_view name) noexcept {
+    uint64_t hash = 14695981039346656037ull;
     for (char ch : name) {
-        out.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(ch))));
+        hash ^= static_cast<unsigned char>(fold(ch));
+        hash *= 1099511628211ull;
     }
-    return out;
+    return static_cast<size_t>(hash);
 }
 
-inline TypeRegistry::TypeRegistry() {
+inline bool TypeRegistry::foldedEqual(std::string_view a, std::string_view b) noexcept {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (fold(a[i]) != fold(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline TypeRegistry::TypeRegistry() : interned_(1) {
     bool_type_ = std::make_shared<ElementaryType>(TypeCategory::Bool);
     int_type_ = std::make_shared<ElementaryType>(TypeCategory::Int);
     dint_type_ = std::make_shared<ElementaryType>(TypeCategory::DInt);
@@ -71,53 +114,96 @@ inline TypeRegistry::TypeRegistry() {
     string_type_ = std::make_shared<ElementaryType>(TypeCategory::String);
     time_type_ = std::make_shared<ElementaryType>(TypeCategory::Time);
 
-    types_.emplace(normalize("BOOL"), bool_type_);
-    types_.emplace(normalize("BYTE"), std::make_shared<ElementaryType>(TypeCategory::Byte));
-    types_.emplace(normalize("WORD"), std::make_shared<ElementaryType>(TypeCategory::Word));
-    types_.emplace(normalize("DWORD"), std::make_shared<ElementaryType>(TypeCategory::DWord));
-    types_.emplace(normalize("LWORD"), std::make_shared<ElementaryType>(TypeCategory::LWord));
-    types_.emplace(normalize("SINT"), std::make_shared<ElementaryType>(TypeCategory::SInt));
-    types_.emplace(normalize("INT"), int_type_);
-    types_.emplace(normalize("DINT"), dint_type_);
-    types_.emplace(normalize("LINT"), std::make_shared<ElementaryType>(TypeCategory::LInt));
-    types_.emplace(normalize("USINT"), std::make_shared<ElementaryType>(TypeCategory::USInt));
-    types_.emplace(normalize("UINT"), std::make_shared<ElementaryType>(TypeCategory::UInt));
-    types_.emplace(normalize("UDINT"), std::make_shared<ElementaryType>(TypeCategory::UDInt));
-    types_.emplace(normalize("ULINT"), std::make_shared<ElementaryType>(TypeCategory::ULInt));
-    types_.emplace(normalize("REAL"), real_type_);
-    types_.emplace(normalize("LREAL"), std::make_shared<ElementaryType>(TypeCategory::LReal));
-    types_.emplace(normalize("TIME"), time_type_);
-    types_.emplace(normalize("DATE"), std::make_shared<ElementaryType>(TypeCategory::Date));
+    registerType("BOOL", bool_type_);
+    registerType("BYTE", std::make_shared<ElementaryType>(TypeCategory::Byte));
+    registerType("WORD", std::make_shared<ElementaryType>(TypeCategory::Word));
+    registerType("DWORD", std::make_shared<ElementaryType>(TypeCategory::DWord));
+    registerType("LWORD", std::make_shared<ElementaryType>(TypeCategory::LWord));
+    registerType("SINT", std::make_shared<ElementaryType>(TypeCategory::SInt));
+    registerType("INT", int_type_);
+    registerType("DINT", dint_type_);
+    registerType("LINT", std::make_shared<ElementaryType>(TypeCategory::LInt));
+    registerType("USINT", std::make_shared<ElementaryType>(TypeCategory::USInt));
+    registerType("UINT", std::make_shared<ElementaryType>(TypeCategory::UInt));
+    registerType("UDINT", std::make_shared<ElementaryType>(TypeCategory::UDInt));
+    registerType("ULINT", std::make_shared<ElementaryType>(TypeCategory::ULInt));
+    registerType("REAL", real_type_);
+    registerType("LREAL", std::make_shared<ElementaryType>(TypeCategory::LReal));
+    registerType("TIME", time_type_);
+    registerType("DATE", std::make_shared<ElementaryType>(TypeCategory::Date));
     {
         auto tod_type = std::make_shared<ElementaryType>(TypeCategory::TimeOfDay);
-        types_.emplace(normalize("TIME_OF_DAY"), tod_type);
-        types_.emplace(normalize("TOD"), tod_type);
+        registerType("TIME_OF_DAY", tod_type);
+        registerType("TOD", tod_type);
     }
     {
         auto dt_type = std::make_shared<ElementaryType>(TypeCategory::DateAndTime);
-        types_.emplace(normalize("DATE_AND_TIME"), dt_type);
-        types_.emplace(normalize("DT"), dt_type);
+        registerType("DATE_AND_TIME", dt_type);
+        registerType("DT", dt_type);
     }
-    types_.emplace(normalize("STRING"), string_type_);
-    types_.emplace(normalize("WSTRING"), std::make_shared<ElementaryType>(TypeCategory::WString));
-    types_.emplace(normalize("ANY"), std::make_shared<ElementaryType>(TypeCategory::Any));
-    types_.emplace(normalize("INVALID"), std::make_shared<ElementaryType>(TypeCategory::Invalid));
+    registerType("STRING", string_type_);
+    registerType("WSTRING", std::make_shared<ElementaryType>(TypeCategory::WString));
+    registerType("ANY", std::make_shared<ElementaryType>(TypeCategory::Any));
+    registerType("INVALID", std::make_shared<ElementaryType>(TypeCategory::Invalid));
 }
 
 inline std::shared_ptr<const Type> TypeRegistry::findType(std::string_view name) const {
-    const auto key = normalize(name);
-    const auto it = types_.find(key);
-    if (it == types_.end()) {
-        return {};
+    return interned_[findTypeId(name)];
+}
+
+inline TypeId TypeRegistry::findTypeId(std::string_view name) const noexcept {
+    const auto range = names_.equal_range(foldedHash(name));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (foldedEqual(it->second.name, name)) {
+            return it->second.id;
+        }
+    }
+    return kNoType;
+}
+
+inline const Type* TypeRegistry::type(TypeId id) const noexcept {
+    if (id >= interned_.size()) {
+        return nullptr;
+    }
+    return interned_[id].get();
+}
+
+inline TypeId TypeRegistry::idOf(const Type* type) const noexcept {
+    const auto it = ids_.find(type);
+    if (it == ids_.end()) {
+        return kNoType;
     }
     return it->second;
 }
 
+inline TypeId TypeRegistry::intern(std::shared_ptr<const Type> type) {
+    if (!type) {
+        return kNoType;
+    }
+    const auto it = ids_.find(type.get());
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<TypeId>(interned_.size());
+    ids_.emplace(type.get(), id);
+    interned_.push_back(std::move(type));
+    return id;
+}
+
 inline void TypeRegistry::registerType(std::string name, std::shared_ptr<const Type> type) {
     if (!type) {
         return;
     }
-    types_[normalize(name)] = std::move(type);
+    const TypeId id = intern(std::move(type));
+    const size_t hash = foldedHash(name);
+    const auto range = names_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (foldedEqual(it->second.name, name)) {
+            it->second.id = id;
+            return;
+        }
+    }
+    names_.emplace(hash, NameEntry{std::move(name), id});
 }
 
 inline std::shared_ptr<const ArrayType> TypeRegistry::createArrayType(
@@ -6,7 +6,6 @@
 #define MATIEC_TYPES_TYPED_CONST_VALUE_HPP
 
 #include <cstdint>
-#include <memory>
 #include <variant>
 
 #include "matiec/types/type.hpp"
@@ -22,7 +21,7 @@ enum class ConstValueStatus : uint8_t {
 
 struct TypedConstValue {
     ConstValueStatus status = ConstValueStatus::Undefined;
-    std::shared_ptr<const Type> type;
+    TypeId type = kNoType;
     std::variant<std::monostate, int64_t, uint64_t, double, bool> value;
 
     [[nodiscard]] bool isValid() const noexcept {
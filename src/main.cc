@@ -124,6 +124,10 @@ static void printusage(const char *cmd) {
   printf(" -b : allow functions returning VOID                 (a non-standard extension!)\n");
   printf(" -e : disable generation of implicit EN and ENO parameters.\n");
   printf(" -c : create conversion functions for enumerated data types\n");
+  printf(" -j : number of threads used for the semantic analysis of the POUs, and for generating their C files with -O p (default: 1)\n");
+  printf(" --max-errors <n> : stop the compilation after reporting <n> errors (default: 0, no limit)\n");
+  printf(" --dep-file <file> : write a Makefile style dependency file (generated files: source and included files)\n");
+  printf(" --ast-stats : print AST memory usage per node class after semantic analysis, and stop\n");
   printf(" -O : options for output (code generation) stage. Available options for %s are...\n", cmd);
   runtime_options.allow_missing_var_in    = false; /* disable: allow definition and invocation of POUs with no input, output and in_out parameters! */
   stage4_print_options();
@@ -138,11 +142,28 @@ static void printusage(const char *cmd) {
 runtime_options_t runtime_options;
 
 
+/* Values returned by getopt_long() for options that only have a long form. */
+enum {
+  OPT_AST_STATS = 256,
+  OPT_MAX_ERRORS,
+  OPT_DEP_FILE
+};
+
+static const struct option long_options[] = {
+  {"ast-stats", no_argument,       NULL, OPT_AST_STATS},
+  {"dep-file",  required_argument, NULL, OPT_DEP_FILE},
+  {"jobs",      required_argument, NULL, 'j'},
+  {"max-errors", required_argument, NULL, OPT_MAX_ERRORS},
+  {NULL,        0,                 NULL, 0}
+};
+
+
 int main(int argc, char **argv) {
   symbol_c *tree_root = nullptr, *ordered_tree_root = nullptr;
   char * builddir = NULL;
   int optres, errflg = 0;
   size_t path_len = 0;
+  bool ast_stats = false;
 
   /* Default values for the command line options... */
   runtime_options.allow_void_datatype     = false; /* disable: allow declaration of functions returning VOID  */
@@ -157,14 +178,17 @@ int main(int argc, char **argv) {
   runtime_options.ref_nonstand_extensions = false; /* disable: Allow the use of non-standard extensions to REF_TO datatypes: REF_TO ANY, and REF_TO in struct elements! */
   runtime_options.nonliteral_in_array_size= false; /* disable: Allow the use of constant non-literals when specifying size of arrays (ARRAY [1..max] OF INT) */
   runtime_options.includedir              = NULL;  /* Include directory, where included files will be searched for... */
+  runtime_options.dependency_file         = NULL;  /* do not write a dependency file */
 
   /* Default values for the command line options... */
   runtime_options.relaxed_datatype_model    = false; /* by default use the strict datatype equivalence model */
+  runtime_options.jobs                      = 1;     /* by default analyse the POUs sequentially */
+  runtime_options.max_errors                = 0;     /* by default report all the errors found */
   
   /******************************************/
   /*   Parse command line options...        */
   /******************************************/
-  while ((optres = getopt(argc, argv, ":nehvfplsrRabicI:T:O:")) != -1) {
+  while ((optres = getopt_long(argc, argv, ":nehvfplsrRabicI:T:O:j:", long_options, NULL)) != -1) {
     switch(optres) {
     case 'h':
       printusage(argv[0]);
@@ -204,7 +228,47 @@ int main(int argc, char **argv) {
     case 'O':
       if (stage4_parse_options(optarg) < 0) errflg++;
       break;
-    case ':':       /* -I, -T, or -O without operand */
+    case 'j':
+      {
+        char *end = NULL;
+        long jobs = strtol(optarg, &end, 10);
+        if ((end == optarg) || (*end != '\0') || (jobs < 1) || (jobs > 1024)) {
+          std::string msg = matiec::format("Invalid number of jobs: %s", optarg);
+          matiec::globalErrorReporter().report(
+              matiec::ErrorSeverity::Error,
+              matiec::ErrorCategory::IO,
+              msg);
+          fprintf(stderr, "%s\n", msg.c_str());
+          errflg++;
+          break;
+        }
+        runtime_options.jobs = (unsigned int)jobs;
+      }
+      break;
+    case OPT_MAX_ERRORS:
+      {
+        char *end = NULL;
+        long max_errors = strtol(optarg, &end, 10);
+        if ((end == optarg) || (*end != '\0') || (max_errors < 0) || (max_errors > 1000000)) {
+          std::string msg = matiec::format("Invalid maximum number of errors: %s", optarg);
+          matiec::globalErrorReporter().report(
+              matiec::ErrorSeverity::Error,
+              matiec::ErrorCategory::IO,
+              msg);
+          fprintf(stderr, "%s\n", msg.c_str());
+          errflg++;
+          break;
+        }
+        runtime_options.max_errors = (unsigned int)max_errors;
+      }
+      break;
+    case OPT_AST_STATS:
+      ast_stats = true;
+      break;
+    case OPT_DEP_FILE:
+      runtime_options.dependency_file = optarg;
+      break;
+    case ':':       /* -I, -T, -O or -j without operand */
       {
         std::string msg = matiec::format("Option -%c requires an operand", optopt);
         matiec::globalErrorReporter().report(
@@ -217,7 +281,8 @@ int main(int argc, char **argv) {
       break;
     case '?':
       {
-        std::string msg = matiec::format("Unrecognized option: -%c", optopt);
+        std::string msg = (optopt != 0) ? matiec::format("Unrecognized option: -%c", optopt)
+                                        : matiec::format("Unrecognized option: %s", argv[optind - 1]);
         matiec::globalErrorReporter().report(
             matiec::ErrorSeverity::Error,
             matiec::ErrorCategory::IO,
@@ -263,6 +328,9 @@ int main(int argc, char **argv) {
   // Ensure compilation resources are released even on early returns/exceptions.
   matiec::internal::compilation_cleanup_guard cleanup;
 
+  /* Every stage stops early once this many errors have been reported */
+  matiec::globalErrorReporter().setMaxErrors(runtime_options.max_errors);
+
 
   /***************************/
   /*   Run the compiler...   */
@@ -283,12 +351,18 @@ int main(int argc, char **argv) {
   //add_en_eno_param_decl_c::add_to(tree_root);
 
   /* Do semantic verification of code */
-  if (stage3(tree_root, &ordered_tree_root) < 0) {
-    cleanup.tree_root_owner().get_deleter().ordered_root = ordered_tree_root;
-    return EXIT_FAILURE;
-  }
+  int stage3_result = stage3(tree_root, &ordered_tree_root);
   cleanup.tree_root_owner().get_deleter().ordered_root = ordered_tree_root;
 
+  if (ast_stats) {
+    /* Diagnostic mode: report the memory used by the (annotated) AST instead of generating code */
+    fputs(matiec::ast_memory_stats_report(matiec::ast_memory_stats(tree_root, ordered_tree_root)).c_str(), stdout);
+    return (stage3_result < 0) ? EXIT_FAILURE : 0;
+  }
+
+  if (stage3_result < 0)
+    return EXIT_FAILURE;
+
   /* 3rd Pass */
   if (stage4(ordered_tree_root, builddir) < 0)
     return EXIT_FAILURE;
@@ -55,6 +55,13 @@ typedef struct {
 	
    /* options specific to stage3 */
 	bool relaxed_datatype_model;   /* Use the relaxed datatype equivalence model, instead of the default strict equivalence model */
+
+   /* options specific to stage4 */
+	const char *dependency_file;   /* Write a Makefile style dependency file, listing the source files the generated files depend on (NULL: none) */
+
+   /* options common to all stages */
+	unsigned int jobs;             /* Number of threads used to analyse (and, with -O p, generate the code of) the POUs in parallel (0 or 1: sequentially) */
+	unsigned int max_errors;       /* Stop the compilation once this many errors have been reported (0: no limit) */
 } runtime_options_t;
 
 extern runtime_options_t runtime_options;
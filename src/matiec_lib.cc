@@ -191,6 +191,7 @@ MATIEC_API void matiec_options_init(matiec_options_t *opts) {
     opts->disable_implicit_en_eno = false;
     opts->conversion_functions = false;
     opts->full_token_location = false;
+    opts->max_errors = 0;
 }
 
 static void apply_options(const matiec_options_t *opts) {
@@ -209,6 +210,8 @@ static void apply_options(const matiec_options_t *opts) {
         runtime_options.conversion_functions = false;
         runtime_options.full_token_loc = false;
         runtime_options.includedir = nullptr;
+        runtime_options.max_errors = 0;
+        runtime_options.dependency_file = nullptr;
         return;
     }
 
@@ -225,6 +228,8 @@ static void apply_options(const matiec_options_t *opts) {
     runtime_options.conversion_functions = opts->conversion_functions;
     runtime_options.full_token_loc = opts->full_token_location;
     runtime_options.includedir = opts->include_dir;
+    runtime_options.max_errors = (opts->max_errors > 0) ? static_cast<unsigned int>(opts->max_errors) : 0;
+    runtime_options.dependency_file = opts->dependency_file;
 }
 
 static void result_init(matiec_result_t *result) {
@@ -360,10 +365,19 @@ static void result_set_error_from_reporter(matiec_result_t* result,
     }
 }
 
-MATIEC_API matiec_error_t matiec_compile_file(
+/* Runs the whole compilation. When ast_stats_report is not NULL, this is a
+ * diagnostic run instead: it stops after stage 3 (semantic analysis), and
+ * stores the AST memory statistics report in *ast_stats_report.
+ * When check_only is set, it stops after stage 3 too, analysing only the
+ * POU named check_pou (if any, see stage3_check()).
+ */
+static matiec_error_t compile_file_impl(
     const char *input_file,
     const matiec_options_t *opts,
-    matiec_result_t *result
+    matiec_result_t *result,
+    std::string *ast_stats_report,
+    bool check_only = false,
+    const char *check_pou = nullptr
 ) {
     if (!result) {
         return MATIEC_ERROR_INVALID_ARG;
@@ -420,6 +434,7 @@ MATIEC_API matiec_error_t matiec_compile_file(
 
     /* Apply compiler options */
     apply_options(opts);
+    matiec::globalErrorReporter().setMaxErrors(static_cast<int>(runtime_options.max_errors));
 
     /* Prepare output directory */
     const char *builddir = nullptr;
@@ -458,7 +473,13 @@ MATIEC_API matiec_error_t matiec_compile_file(
         absyntax_utils_init(tree_root);
 
         /* Stage 3: Semantic analysis */
-        if (stage3(tree_root, &ordered_tree_root) < 0) {
+        const int stage3_result = check_only ? stage3_check(tree_root, check_pou)
+                                             : stage3(tree_root, &ordered_tree_root);
+        if (ast_stats_report) {
+            *ast_stats_report = matiec::ast_memory_stats_report(
+                matiec::ast_memory_stats(tree_root, ordered_tree_root));
+        }
+        if (stage3_result < 0) {
             cleanup.tree_root_owner().get_deleter().ordered_root = ordered_tree_root;
             result_set_error_from_reporter(
                 result,
@@ -469,6 +490,10 @@ MATIEC_API matiec_error_t matiec_compile_file(
         }
         cleanup.tree_root_owner().get_deleter().ordered_root = ordered_tree_root;
 
+        if (ast_stats_report || check_only) {
+            return MATIEC_OK;
+        }
+
         /* Stage 4: Code generation */
         if (opts && opts->output_format == MATIEC_OUTPUT_IEC) {
             if (stage4_generate_iec_to_file(ordered_tree_root, builddir, input_file) < 0) {
@@ -507,12 +532,59 @@ MATIEC_API matiec_error_t matiec_compile_file(
     return ret;
 }
 
-MATIEC_API matiec_error_t matiec_compile_string(
+MATIEC_API matiec_error_t matiec_compile_file(
+    const char *input_file,
+    const matiec_options_t *opts,
+    matiec_result_t *result
+) {
+    return compile_file_impl(input_file, opts, result, nullptr);
+}
+
+MATIEC_API matiec_error_t matiec_ast_stats_file(
+    const char *input_file,
+    const matiec_options_t *opts,
+    matiec_result_t *result,
+    char **report
+) {
+    if (!report) {
+        if (result) {
+            result_init(result);
+            result_set_error(result, MATIEC_ERROR_INVALID_ARG, "Report pointer is NULL");
+        }
+        return MATIEC_ERROR_INVALID_ARG;
+    }
+    *report = nullptr;
+
+    std::string ast_stats_report;
+    const matiec_error_t ret = compile_file_impl(input_file, opts, result, &ast_stats_report);
+    if (!ast_stats_report.empty()) {
+        *report = matiec_strdup(ast_stats_report.c_str());
+    }
+    return ret;
+}
+
+MATIEC_API void matiec_string_free(char *str) {
+    free(str);
+}
+
+MATIEC_API matiec_error_t matiec_check_file(
+    const char *input_file,
+    const char *pou_name,
+    const matiec_options_t *opts,
+    matiec_result_t *result
+) {
+    return compile_file_impl(input_file, opts, result, nullptr, true, pou_name);
+}
+
+/* Compiles (or, when check_only is set, checks) source, by way of a temporary file. */
+static matiec_error_t compile_string_impl(
     const char *source,
     size_t source_len,
     const char *source_name,
     const matiec_options_t *opts,
-    matiec_result_t *result
+    matiec_result_t *result,
+    bool check_only,
+    const char *check_pou
 ) {
     if (!result) {
         return MATIEC_ERROR_INVALID_ARG;
@@ -618,10 +690,31 @@ MATIEC_API matiec_error_t matiec_compile_string(
     f.reset(); // close before compiling
 
     /* Compile the temp file */
-    matiec_error_t ret = matiec_compile_file(temp_file_path.c_str(), opts, result);
+    matiec_error_t ret = compile_file_impl(temp_file_path.c_str(), opts, result, nullptr, check_only, check_pou);
     return ret;
 }
 
+MATIEC_API matiec_error_t matiec_compile_string(
+    const char *source,
+    size_t source_len,
+    const char *source_name,
+    const matiec_options_t *opts,
+    matiec_result_t *result
+) {
+    return compile_string_impl(source, source_len, source_name, opts, result, false, nullptr);
+}
+
+MATIEC_API matiec_error_t matiec_check_string(
+    const char *source,
+    size_t source_len,
+    const char *source_name,
+    const char *pou_name,
+    const matiec_options_t *opts,
+    matiec_result_t *result
+) {
+    return compile_string_impl(source, source_len, source_name, opts, result, true, pou_name);
+}
+
 MATIEC_API void matiec_result_free(matiec_result_t *result) {
     if (!result) return;
 
@@ -168,6 +168,17 @@ void yyerror (const char *error_msg);
 #include "stage1_2_diagnostics.hh"
 
 
+/* Once the maximum number of errors (runtime_options.max_errors) has been reported,
+ * the parser is handed the end of the input file, so it stops instead of recovering
+ * from (and reporting) any further errors.
+ */
+static int yylex_within_error_budget(void) {
+  if (matiec::globalErrorReporter().reachedMaxErrors())  return 0;
+  return yylex();
+}
+#define yylex() yylex_within_error_budget()
+
+
 
 /*************************/
 /* global variables...   */
@@ -8575,6 +8586,9 @@ void print_err_msg(int first_line,
                    long int last_order,
                    const char *additional_error_msg) {
 
+  /* the errors after the maximum number of errors are not reported */
+  if (matiec::globalErrorReporter().reachedMaxErrors())  return;
+
   const char *unknown_file = "<unknown_file>";
   if (first_filename == NULL) first_filename = unknown_file;
   if ( last_filename == NULL)  last_filename = unknown_file;
@@ -8802,6 +8816,9 @@ static int parse_files(const char *libfilename, const char *filename) {
     return -2;
   }
 
+  /* everything parsed so far comes from the standard library */
+  set_standard_library_elements(tree_root);
+
   /* if by any chance the library is not complete, we now add the missing reserved keywords to the list!!!  */
   for(int i = 0; standard_function_block_names[i] != NULL; i++)
     if (library_element_symtable.find(standard_function_block_names[i]) ==
@@ -8843,9 +8860,13 @@ static int parse_files(const char *libfilename, const char *filename) {
   //allow_ref_to_any = false;    /* we only allow REF_TO ANY in library functions/FBs, no matter what the user asks for in the command line */
 
   if (yyparse() != 0) {
-    fprintf (stderr, "\nParsing failed because of too many consecutive syntax errors. Bailing out!\n");
-    matiec::globalErrorReporter().reportParseError(
-        "Parsing failed because of too many consecutive syntax errors.");
+    if (matiec::globalErrorReporter().reachedMaxErrors()) {
+      fprintf (stderr, "\nParsing stopped after %d error(s). Bailing out!\n", matiec::globalErrorReporter().errorCount());
+    } else {
+      fprintf (stderr, "\nParsing failed because of too many consecutive syntax errors. Bailing out!\n");
+      matiec::globalErrorReporter().reportParseError(
+          "Parsing failed because of too many consecutive syntax errors.");
+    }
     fclose(mainfile);
     return -4;
   }
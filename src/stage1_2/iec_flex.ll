@@ -2084,9 +2084,9 @@ void include_string_(const char *source_code) {
 /* Open an include file, and set the internal state variables of lexical analyser to process a new include file */
 void include_file(const char *filename) {
   FILE *filehandle = NULL;
+  std::string full_name;
   
   for (int i = 0; (INCLUDE_DIRECTORIES[i] != NULL) && (filehandle == NULL); i++) {
-    std::string full_name;
     try {
       full_name = std::string(INCLUDE_DIRECTORIES[i]) + "/" + filename;
     } catch (const std::bad_alloc&) {
@@ -2111,6 +2111,7 @@ void include_file(const char *filename) {
     return;
   }
 
+  add_source_file(full_name.c_str());
   /* now process the new file... */
   handle_include_file_(filehandle, filename);
 }
@@ -2270,6 +2271,7 @@ FILE *parse_file(const char *filename) {
     yyin = filehandle;
     current_filename = matiec::cstr_pool_strdup(filename);
     current_tracking = GetNewTracking(yyin);
+    add_source_file(filename);
   }
   return filehandle;
 }
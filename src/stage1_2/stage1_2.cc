@@ -38,6 +38,8 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <unordered_set>
 
 /* file with declaration of absyntax classes... */
 #include "../absyntax/absyntax.hh"
@@ -206,12 +208,40 @@ int stage2__(const char *filename,
              symbol_c **tree_root_ref
             );
 
+/* The source files read by the lexical analyser. The same files are read again when pre-parsing. */
+static std::vector<std::string> source_files__;
+
+void add_source_file(const char *filename) {
+  if (std::find(source_files__.begin(), source_files__.end(), filename) == source_files__.end())
+    source_files__.push_back(filename);
+}
+
+const std::vector<std::string> &stage1_2_source_files(void) {return source_files__;}
+
+
+/* The elements of the library that were declared in the standard library. */
+static std::unordered_set<symbol_c *> standard_library_elements__;
+
+void set_standard_library_elements(symbol_c *library) {
+  standard_library_elements__.clear();
+  list_c *list = dynamic_cast<list_c *>(library);
+  for (int i = 0; (NULL != list) && (i < list->n); i++)
+    standard_library_elements__.insert(list->get_element(i));
+}
+
+bool stage1_2_is_standard_library_element(symbol_c *element) {
+  return (standard_library_elements__.count(element) > 0);
+}
+
+
 void stage1_2_reset(void) {
   /* These tables are used by the lexer to disambiguate identifiers. They must
    * not retain values across independent compilation runs in-process. */
   library_element_symtable.clear();
   variable_name_symtable.clear();
   direct_variable_symtable.clear();
+  source_files__.clear();
+  standard_library_elements__.clear();
 
   /* Reset flex/bison coordination flags. */
   rst_preparse_state();
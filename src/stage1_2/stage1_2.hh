@@ -44,12 +44,25 @@
 
 /* This file includes the interface through which the main function accesses the stage1_2 services */
 
+#include <string>
+#include <vector>
+
 
 int stage1_2(const char *filename, symbol_c **tree_root);
 
 /* Reset per-compilation global state (symbol tables, parser/scanner flags). */
 void stage1_2_reset(void);
 
+/* The source files read by the last call to stage1_2(), in the order they were first opened: the
+ * standard library, the input file, and every file they include. Used to write the dependency file.
+ */
+const std::vector<std::string> &stage1_2_source_files(void);
+
+/* Whether the library element (e.g. a function declaration) was declared in the standard library
+ * (ieclib.txt and the files it includes), as parsed by the last call to stage1_2().
+ */
+bool stage1_2_is_standard_library_element(symbol_c *element);
+
 
 
 
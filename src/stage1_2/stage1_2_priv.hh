@@ -141,6 +141,16 @@ void include_string(const char *source_code);
  */
 FILE *parse_file(const char *filename);
 
+/* This is a service that stage1_2.cc provides to flex... */
+/* Record a source file that has just been opened (see stage1_2_source_files()). */
+void add_source_file(const char *filename);
+
+/* This is a service that stage1_2.cc provides to bison... */
+/* Record the elements of the library, just after the standard library has been parsed into it
+ * (see stage1_2_is_standard_library_element()).
+ */
+void set_standard_library_elements(symbol_c *library);
+
 /* Reset/cleanup the flex scanner between parsing runs. */
 void stage1_2_lex_reset(void);
 void stage1_2_lex_cleanup(void);
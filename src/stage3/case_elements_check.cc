@@ -46,6 +46,12 @@
 #include "case_elements_check.hh"
 #include "stage3_diagnostics.hh"
 
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <string>
+#include <unordered_map>
+
 
 #define STAGE3_ERROR(error_level, symbol1, symbol2, ...) \
   MATIEC_STAGE3_ERROR((error_level), matiec::ErrorCategory::Semantic, (symbol1), (symbol2), \
@@ -180,6 +186,165 @@ void case_elements_check_c::check_symb_symb(symbol_c *s1, symbol_c *s2) {
 
 
 
+/* A limit of a CASE element, normalised so that int64 and uint64 cvalues may be compared with each other:
+ * the negative values (ordered as int64) come before all the non-negative values (ordered as uint64).
+ */
+typedef std::pair<bool, uint64_t> case_limit_t;
+
+static bool get_case_limit(symbol_c *symbol, case_limit_t &limit) {
+  if (VALID_CVALUE( int64, symbol)) {limit = case_limit_t(GET_CVALUE(int64, symbol) >= 0, (uint64_t)GET_CVALUE(int64, symbol)); return true;}
+  if (VALID_CVALUE(uint64, symbol)) {limit = case_limit_t(true, GET_CVALUE(uint64, symbol));                                   return true;}
+  return false;
+}
+
+
+/* check whether we have any overlappings in the case_elements_list
+ *
+ * Instead of comparing every pair of elements, the elements that may overlap are first found by
+ * normalising each element with integer cvalues to a (lower, upper) interval, sorting the intervals,
+ * and sweeping through them. The few remaining elements (i.e. ranges with the limits in reverse
+ * order, and elements with non integer cvalues or that are compared as identifiers) are compared
+ * with the others directly.
+ * Each pair of elements that may overlap is then checked (and the warnings printed) in the same
+ * order as when every pair of elements was compared.
+ */
+void case_elements_check_c::check_case_elements_list(void) {
+  typedef struct {case_limit_t lower, upper; size_t element;} interval_t;
+  std::vector<interval_t> intervals;
+  std::vector<size_t>     reversed;   // ranges with the upper limit lower than the lower limit
+  std::vector<size_t>     consts;     // elements with (non integer) cvalues
+  std::unordered_map<std::string, std::vector<size_t> > identifiers; // elements compared as identifiers, by upper case name
+  std::vector<std::pair<size_t, size_t> > candidates;
+  size_t n = case_elements_list.size();
+
+  for (size_t i = 0; i < n; i++) {
+    symbol_c   *element  = case_elements_list[i];
+    subrange_c *subrange = dynamic_cast<subrange_c *>(element);
+    interval_t  interval;
+    interval.element = i;
+    if (NULL != subrange) {
+      /* ranges without constant limits never overlap anything */
+      if (!get_case_limit(subrange->lower_limit, interval.lower) || !get_case_limit(subrange->upper_limit, interval.upper)) continue;
+      if (interval.upper < interval.lower) reversed.push_back(i);
+      else                                 intervals.push_back(interval);
+      continue;
+    }
+    if (get_case_limit(element, interval.lower)) {interval.upper = interval.lower; intervals.push_back(interval); continue;}
+    if (element->const_value.is_const()) consts.push_back(i);
+    token_c *token = dynamic_cast<token_c *>(element);
+    if (NULL != token) {
+      std::string name(matiec::sv_or_empty(token->value));
+      for (char &c : name) c = std::toupper(static_cast<unsigned char>(c));
+      identifiers[name].push_back(i);
+    }
+  }
+
+  /* sweep through the intervals sorted by their lower limit, keeping the intervals that have started (by upper limit) */
+  std::sort(intervals.begin(), intervals.end(), [](const interval_t &a, const interval_t &b) {return a.lower < b.lower;});
+  std::multimap<case_limit_t, size_t> active;
+  for (size_t i = 0; i < intervals.size(); i++) {
+    active.erase(active.begin(), active.lower_bound(intervals[i].lower)); // these end before the current interval starts
+    for (std::multimap<case_limit_t, size_t>::const_iterator a = active.begin(); a != active.end(); a++)
+      candidates.push_back(std::minmax(a->second, intervals[i].element));
+    active.insert(std::make_pair(intervals[i].upper, intervals[i].element));
+  }
+
+  for (size_t i = 0; i < reversed.size(); i++)
+    for (size_t j = 0; j < n; j++)
+      if (j != reversed[i]) candidates.push_back(std::minmax(reversed[i], j));
+  for (size_t i = 0; i < consts.size(); i++)
+    for (size_t j = i + 1; j < consts.size(); j++)
+      candidates.push_back(std::make_pair(consts[i], consts[j]));
+  for (std::unordered_map<std::string, std::vector<size_t> >::const_iterator same = identifiers.begin(); same != identifiers.end(); same++)
+    for (size_t i = 0; i < same->second.size(); i++)
+      for (size_t j = i + 1; j < same->second.size(); j++)
+        candidates.push_back(std::make_pair(same->second[i], same->second[j]));
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  for (size_t i = 0; i < candidates.size(); i++) {
+    symbol_c *s1 = case_elements_list[candidates[i].first];
+    symbol_c *s2 = case_elements_list[candidates[i].second];
+    // Check for overlapping elements
+    check_subr_subr(s1, s2);
+    check_subr_symb(s1, s2);
+    check_symb_symb(s2, s1);
+  }
+}
+
+
+
+matiec::ast_preorder_index_c            case_elements_check_c::library_index;
+std::unordered_map<symbol_c *, int32_t> case_elements_check_c::element_positions;
+
+
+/* static method! */
+void case_elements_check_c::enter_library(symbol_c *library) {
+  library_index.build(library);
+  element_positions.clear();
+  /* the library elements are the children of the root, one subtree after the other */
+  for (int32_t pos = 1; (size_t)pos < library_index.size(); pos = library_index[pos].subtree_end)
+    element_positions[library_index[pos].node] = pos;
+}
+
+
+/* static method! */
+void case_elements_check_c::leave_library(void) {
+  library_index.clear();
+  element_positions.clear();
+}
+
+
+void case_elements_check_c::check(symbol_c *symbol) {
+  std::unordered_map<symbol_c *, int32_t>::const_iterator element = element_positions.find(symbol);
+  if (element != element_positions.end()) {check(library_index, element->second); return;}
+  check(matiec::ast_preorder_index_c(symbol));
+}
+
+
+void case_elements_check_c::check(const matiec::ast_preorder_index_c &ast_index, int32_t root) {
+  if (ast_index.empty()) return;
+  /* The positions are in preorder, so those of the subtree are a contiguous range. */
+  const std::vector<int32_t> &all_positions = ast_index.positions_of(matiec::ast_class_tag_t::case_statement_c);
+  std::vector<int32_t> positions(std::lower_bound(all_positions.begin(), all_positions.end(), root),
+                                 std::lower_bound(all_positions.begin(), all_positions.end(), ast_index[root].subtree_end));
+
+  /* The visitor checks a CASE only after having visited (and checked) all the CASE statements nested inside it.
+   * Keep the warnings in that same order by handling the CASE statements in postorder, i.e. sorted by the end
+   * of their subtree, inner (i.e. later starting) statements first.
+   */
+  std::sort(positions.begin(), positions.end(), [&ast_index](int32_t a, int32_t b) {
+    if (ast_index[a].subtree_end != ast_index[b].subtree_end)
+      return ast_index[a].subtree_end < ast_index[b].subtree_end;
+    return a > b;
+  });
+
+  for (int32_t pos : positions) {
+    case_statement_c *symbol = static_cast<case_statement_c *>(ast_index[pos].node);
+    case_elements_list.clear();
+    list_c *case_element_list = dynamic_cast<list_c *>(symbol->case_element_list);
+    if (NULL == case_element_list) continue;
+    /* Only collect the case_list_c of this CASE. Do NOT recurse into the statement lists, as any nested CASE
+     * statements have their own entry in the index.
+     */
+    for (int i = 0; i < case_element_list->n; i++) {
+      case_element_c *case_element = dynamic_cast<case_element_c *>(case_element_list->get_element(i));
+      if ((NULL != case_element) && (NULL != case_element->case_list))
+        case_element->case_list->accept(*this); // visit(case_list_c *) fills up the case_elements_list
+    }
+    check_case_elements_list();
+  }
+  case_elements_list.clear();
+}
+
+
+
+
+
+
+
+
+
 /***************************************/
 /* B.3 - Language ST (Structured Text) */
 /***************************************/
@@ -196,19 +361,7 @@ void *case_elements_check_c::visit(case_statement_c *symbol) {
 
   case_elements_list.clear();
   symbol->case_element_list->accept(*this); // will fill up the case_elements_list with all the elements in the case!
-  
-  // OK, now check whether we have any overlappings...
-  std::vector<symbol_c *>::iterator s1 = case_elements_list.begin();
-  for (  ; s1 != case_elements_list.end(); s1++) {
-    std::vector<symbol_c *>::iterator s2 = s1;
-    s2++; // do not compare the value with itself!
-    for (; s2 != case_elements_list.end(); s2++) {
-      // Check for overlapping elements
-      check_subr_subr(*s1, *s2);
-      check_subr_symb(*s1, *s2);
-      check_symb_symb(*s2, *s1);
-    }
-  }
+  check_case_elements_list();
   
   case_elements_list = case_elements_list_local;
   return NULL;
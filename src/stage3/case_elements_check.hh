@@ -43,6 +43,9 @@
  */
 
 #include "../absyntax_utils/absyntax_utils.hh"
+#include "../absyntax/ast_preorder_index.hh"
+
+#include <unordered_map>
 
 
 
@@ -54,9 +57,13 @@ class case_elements_check_c: public iterator_visitor_c {
     int current_display_error_level;
 
     std::vector<symbol_c *> case_elements_list;
+    /* The flattened AST index of the library, and the position of each library element in it (see enter_library()) */
+    static matiec::ast_preorder_index_c             library_index;
+    static std::unordered_map<symbol_c *, int32_t>  element_positions;
     void check_subr_subr(symbol_c *s1, symbol_c *s2);
     void check_subr_symb(symbol_c *s1, symbol_c *s2);
     void check_symb_symb(symbol_c *s1, symbol_c *s2);
+    void check_case_elements_list(void);
   
 
   public:
@@ -64,6 +71,24 @@ class case_elements_check_c: public iterator_visitor_c {
     virtual ~case_elements_check_c(void);
     int get_error_count();
 
+    /* Check every CASE statement of the subtree rooted at the given entry of the flattened AST index,
+     * instead of walking the tree with accept(). Unlike the visitor, this also reaches CASE statements
+     * nested inside the ELSE branch of another CASE (which the visitor never visits).
+     */
+    void check(const matiec::ast_preorder_index_c &ast_index, int32_t root = 0);
+    /* Same as above, for the CASE statements inside symbol. When called between enter_library() and
+     * leave_library() with an element of that library, the index of the library is used, otherwise
+     * symbol gets indexed.
+     */
+    void check(symbol_c *symbol);
+
+    /* When the elements of a library are checked separately (e.g. when stage3 analyses the POUs in parallel),
+     * enter_library() indexes the whole library once, before, and leave_library() drops the index, after,
+     * checking them. The index is only valid as long as the tree does not change in between.
+     */
+    static void enter_library(symbol_c *library);
+    static void leave_library(void);
+
     /***************************************/
     /* B.3 - Language ST (Structured Text) */
     /***************************************/
@@ -143,9 +143,13 @@
 #include <string.h>  /* required for strlen() */
 // #include <stdlib.h>  /* required for atoi() */
 #include <errno.h>   /* required for errno */
+#include <queue>
+#include <unordered_map>
 
 #include "../main.hh" // required for uint8_t, real_64_t, ..., and the macros NAN, INFINITY, INT8_MAX, REAL32_MAX, ... */
 #include "stage3_diagnostics.hh"
+#include "standard_function_evaluators.hh"
+#include "../stage1_2/stage1_2.hh" // required for stage1_2_is_standard_library_element()
 
 
 
@@ -598,6 +602,55 @@ static void *handle_move(symbol_c *to, symbol_c *from) {
 }
 
 
+/* A call to a pure standard function (e.g. SQRT(2.0), MAX(3, 7, 5)) with constant parameters.
+ * The overload being called is only known once narrow_candidate_datatypes_c has run, so these calls
+ * only get a cvalue when the POU is constant folded for the second time (see function_folding() in stage3.cc).
+ * In IL non-formal function calls, the first parameter is the value stored in the IL default variable (accumulator).
+ * The evaluators are chosen by function name, so only the functions declared in the standard library are evaluated
+ * (the user may declare a function named, for e.g., TRUNC_INT, which the standard library does not declare).
+ */
+static void *handle_function_call(symbol_c *fcall, symbol_c *called_function_declaration, bool use_accumulator, symbol_c *accumulator) {
+	fcall->const_value = const_value_c();
+	function_declaration_c *f_decl = dynamic_cast<function_declaration_c *>(called_function_declaration);
+	if (NULL == f_decl) return NULL;
+	if (!stage1_2_is_standard_library_element(f_decl)) return NULL;
+
+	function_call_param_iterator_c fcp_iterator(fcall);
+	/* calls with EN or ENO are left for run time */
+	if ((NULL != fcp_iterator.search_f("EN")) || (NULL != fcp_iterator.search_f("ENO"))) return NULL;
+
+	std::vector<symbol_c *> param_values, param_types;
+	function_param_iterator_c fp_iterator(f_decl);
+	identifier_c *param_name;
+	while ((param_name = fp_iterator.next()) != NULL) {
+		if (fp_iterator.is_en_eno_param_implicit()) continue;
+		std::string name(matiec::sv_or_empty(param_name->value));
+		if (fp_iterator.is_extensible_param()) name += std::to_string(fp_iterator.extensible_param_index());
+
+		symbol_c *param_value = fcp_iterator.search_f(name.c_str());
+		if ((NULL == param_value) && use_accumulator) {
+			if (NULL == accumulator) return NULL;
+			param_value = accumulator;
+			use_accumulator = false;
+		}
+		if (NULL == param_value) param_value = fcp_iterator.next_nf();
+		if ((NULL == param_value) && fp_iterator.is_extensible_param()) break;
+
+		if (function_param_iterator_c::direction_in != fp_iterator.param_direction()) {
+			if (NULL != param_value) return NULL; /* the output parameters are set at run time */
+			continue;
+		}
+		if (NULL == param_value) return NULL; /* default values are not folded */
+		param_values.push_back(param_value);
+		param_types .push_back(fp_iterator.param_type());
+	}
+	if (NULL != fcp_iterator.next_nf()) return NULL;
+
+	evaluate_standard_function(f_decl, param_values, param_types, fcall->const_value);
+	return NULL;
+}
+
+
 /* unary negation (multiply by -1) */
 static void *handle_neg(symbol_c *symbol, symbol_c *oper) {
 	if (NULL == oper) return NULL;
@@ -723,21 +776,21 @@ static void *handle_pow(symbol_c *symbol, symbol_c *oper1, symbol_c *oper2) {
 
 
 /* If the cvalues of all the prev_il_intructions have the same VALID value, then set the local cvalue to that value, otherwise, set it to NONCONST! */
-#define intersect_prev_CVALUE_(dtype, symbol) {                                                                   \
-	symbol->const_value.m_##dtype = symbol->prev_il_instruction[0]->const_value.m_##dtype;                      \
-	for (unsigned int i = 1; i < symbol->prev_il_instruction.size(); i++) {                                   \
-		if (!ISEQUAL_CVALUE(dtype, symbol, symbol->prev_il_instruction[i]))                               \
+#define intersect_prev_CVALUE_(dtype, symbol, prev) {                                                             \
+	symbol->const_value.m_##dtype = prev[0]->const_value.m_##dtype;                                           \
+	for (unsigned int i = 1; i < prev.size(); i++) {                                                          \
+		if (!ISEQUAL_CVALUE(dtype, symbol, prev[i]))                                                      \
 			{SET_NONCONST(dtype, symbol); break;}                                                     \
 	}                                                                                                         \
 }
 
-static void intersect_prev_cvalues(il_instruction_c *symbol) {
-	if (symbol->prev_il_instruction.empty())
+static void intersect_prev_cvalues(il_instruction_c *symbol, const std::vector<symbol_c *> &prev) {
+	if (prev.empty())
 		return;
-	intersect_prev_CVALUE_(real64, symbol);
-	intersect_prev_CVALUE_(uint64, symbol);
-	intersect_prev_CVALUE_( int64, symbol);
-	intersect_prev_CVALUE_(  bool, symbol);
+	intersect_prev_CVALUE_(real64, symbol, prev);
+	intersect_prev_CVALUE_(uint64, symbol, prev);
+	intersect_prev_CVALUE_( int64, symbol, prev);
+	intersect_prev_CVALUE_(  bool, symbol, prev);
 }
 
 
@@ -757,6 +810,7 @@ constant_folding_c::constant_folding_c(symbol_c *symbol) {
     current_display_error_level = 0;
     il_operand = NULL;
     prev_il_instruction = NULL;
+    il_current = 0;
     
     /* check whether the platform on which the compiler is being run implements IEC 559 floating point data types. */
     symbol_c null_symbol;
@@ -940,10 +994,119 @@ void *constant_folding_c::visit(fixed_point_c *symbol) {
 /***********************************/
 /* B 2.1 Instructions and Operands */
 /***********************************/
-/* Not needed, since we inherit from iterator_visitor_c */
 /*| instruction_list il_instruction */
 // SYM_LIST(instruction_list_c)
-// void *constant_folding_c::visit(instruction_list_c *symbol) {}
+/* The positions of the previous (or next) IL instructions of each IL instruction, as stored in il_prev/il_prev_begin. */
+static void il_positions(const std::unordered_map<symbol_c *, int> &position,
+                         const std::vector<il_instruction_c *> &il_instructions, bool prev,
+                         std::vector<int> &begin, std::vector<int> &positions) {
+	begin.assign(1, 0);
+	positions.clear();
+	for (il_instruction_c *il_instruction : il_instructions) {
+		if (NULL != il_instruction) {
+			const std::vector<symbol_c *> &list = prev ? il_instruction->prev_il_instruction : il_instruction->next_il_instruction;
+			for (symbol_c *element : list) {
+				std::unordered_map<symbol_c *, int>::const_iterator i = position.find(element);
+				positions.push_back((i == position.end()) ? -1 : i->second);
+			}
+		}
+		begin.push_back(positions.size());
+	}
+}
+
+/* The cvalues of the IL instructions are determined by a worklist algorithm, that iterates to a fixpoint
+ * over the control flow graph built by the flow_control_analysis_c (i.e. the prev_il_instruction and
+ * next_il_instruction of each IL instruction).
+ *
+ * The worklist starts off with the entry of the instruction list (and any other IL instruction without a
+ * previous IL instruction), and is always processed in program order. The cvalue of an IL instruction
+ * is determined using only the previous IL instructions that have already been reached (i.e. visited)
+ * by the algorithm, which allows a loop (backward jump) that keeps the same value in the IL default
+ * variable to be folded. Whenever the cvalue of an IL instruction changes, the IL instructions that may be
+ * executed right after it are (re)added to the worklist.
+ *
+ * The state of the algorithm is kept in dense arrays, indexed by the position of each IL instruction in the list,
+ * which are filled once before the algorithm starts.
+ *
+ * Any IL instruction that is never reached is dead code, and is visited at the end (once, in program order).
+ * Should the algorithm not converge within the expected number of visits, we fall back to a single visit
+ * of all the IL instructions in program order, in which the destinations of backward jumps become NONCONST.
+ */
+void *constant_folding_c::visit(instruction_list_c *symbol) {
+	const int n = symbol->n;
+	std::vector<il_instruction_c *> il_instructions(n);
+	std::unordered_map<symbol_c *, int> position(n);
+	for (int i = 0; i < n; i++) {
+		il_instructions[i] = dynamic_cast<il_instruction_c *>(symbol->get_element(i));
+		position[symbol->get_element(i)] = i;
+	}
+	il_positions(position, il_instructions, true,  il_prev_begin, il_prev);
+	il_positions(position, il_instructions, false, il_next_begin, il_next);
+	il_reached.assign(n, false);
+
+	std::vector<bool> in_worklist(n, false);
+	std::priority_queue<int, std::vector<int>, std::greater<int> > worklist;
+	for (int i = 0; i < n; i++) {
+		if ((NULL != il_instructions[i]) && ((0 == i) || il_instructions[i]->prev_il_instruction.empty()))
+			{worklist.push(i); in_worklist[i] = true;}
+	}
+
+	/* each IL instruction's cvalue may only change a few times (VALID -> NONCONST, ...) */
+	long int visits_left = 8 * (long int)n;
+	while (!worklist.empty() && (visits_left-- > 0)) {
+		int i = worklist.top();
+		worklist.pop();
+		in_worklist[i] = false;
+
+		il_instruction_c *il_instruction = il_instructions[i];
+		const_value_c old_value = il_instruction->const_value;
+		bool first_visit = !il_reached[i];
+		il_reached[i] = true;
+		il_current = i;
+		il_instruction->accept(*this);
+		if (!first_visit && (il_instruction->const_value == old_value))  continue;
+
+		for (int j = il_next_begin[i]; j < il_next_begin[i + 1]; j++) {
+			int next = il_next[j];
+			if ((next < 0) || in_worklist[next])  continue;
+			worklist.push(next);
+			in_worklist[next] = true;
+		}
+	}
+
+	bool converged = worklist.empty();
+	std::vector<bool> reached;
+	reached.swap(il_reached);
+
+	if (!converged)
+		for (int i = 0; i < n; i++)  symbol->get_element(i)->const_value = const_value_c();
+	for (int i = 0; i < n; i++)
+		if (!converged || !reached[i])  symbol->get_element(i)->accept(*this);
+	return NULL;
+}
+
+
+/* The previous IL instructions whose cvalues are used to determine the cvalue of the IL default variable
+ * before executing the IL instruction. While the worklist algorithm is running, only the previous IL instructions
+ * that have already been reached are used. The entry of the instruction list has an additional (undefined)
+ * previous cvalue, for when it is also the destination of a backward jump.
+ * The returned list is only valid until the next call.
+ */
+const std::vector<symbol_c *> &constant_folding_c::reached_prev_il_instructions(il_instruction_c *symbol) {
+	if (il_reached.empty())
+		return symbol->prev_il_instruction;
+
+	static symbol_c undefined_entry_value;
+	il_prev_scratch.clear();
+	for (int i = il_prev_begin[il_current]; i < il_prev_begin[il_current + 1]; i++) {
+		int prev = il_prev[i];
+		if ((prev < 0) || il_reached[prev])
+			il_prev_scratch.push_back(symbol->prev_il_instruction[i - il_prev_begin[il_current]]);
+	}
+	if (!il_prev_scratch.empty() && (0 == il_current))
+		il_prev_scratch.push_back(&undefined_entry_value);
+	return il_prev_scratch;
+}
 
 /* | label ':' [il_incomplete_instruction] eol_list */
 // SYM_REF2(il_instruction_c, label, il_instruction)
@@ -953,12 +1116,13 @@ void *constant_folding_c::visit(il_instruction_c *symbol) {
 		/* This empty/null il_instruction does not change the value of the current/default IL variable.
 		 * So it inherits the candidate_datatypes from it's previous IL instructions!
 		 */
-		intersect_prev_cvalues(symbol);
+		intersect_prev_cvalues(symbol, reached_prev_il_instructions(symbol));
 	} else {
+		const std::vector<symbol_c *> &prev = reached_prev_il_instructions(symbol);
 		il_instruction_c fake_prev_il_instruction = *symbol;
-		intersect_prev_cvalues(&fake_prev_il_instruction);
+		intersect_prev_cvalues(&fake_prev_il_instruction, prev);
 
-		if (symbol->prev_il_instruction.size() == 0)  prev_il_instruction = NULL;
+		if (prev.size() == 0)                         prev_il_instruction = NULL;
 		else                                          prev_il_instruction = &fake_prev_il_instruction;
 		symbol->il_instruction->accept(*this);
 		prev_il_instruction = NULL;
@@ -986,11 +1150,13 @@ void *constant_folding_c::visit(il_simple_operation_c *symbol) {
 }
 
 
-/* TODO: handle function invocations... */
 /* | function_name [il_operand_list] */
 /* NOTE: The parameters 'called_function_declaration' and 'extensible_param_count' are used to pass data between the stage 3 and stage 4. */
 // SYM_REF2(il_function_call_c, function_name, il_operand_list, symbol_c *called_function_declaration; int extensible_param_count;)
-// void *constant_folding_c::visit(il_function_call_c *symbol) {}
+void *constant_folding_c::visit(il_function_call_c *symbol) {
+	if (NULL != symbol->il_operand_list) symbol->il_operand_list->accept(*this);
+	return handle_function_call(symbol, symbol->called_function_declaration, true, prev_il_instruction);
+}
 
 
 /* | il_expr_operator '(' [il_operand] eol_list [simple_instr_list] ')' */
@@ -1052,11 +1218,13 @@ void *constant_folding_c::visit(il_jump_operation_c *symbol) {
 void *constant_folding_c::visit(il_fb_call_c *symbol) {return handle_move(symbol, prev_il_instruction);}
 
 
-/* TODO: handle function invocations... */
 /* | function_name '(' eol_list [il_param_list] ')' */
 /* NOTE: The parameter 'called_function_declaration' is used to pass data between the stage 3 and stage 4. */
 // SYM_REF2(il_formal_funct_call_c, function_name, il_param_list, symbol_c *called_function_declaration; int extensible_param_count;)
-// void *constant_folding_c::visit(il_formal_funct_call_c *symbol) {return NULL;}
+void *constant_folding_c::visit(il_formal_funct_call_c *symbol) {
+	if (NULL != symbol->il_param_list) symbol->il_param_list->accept(*this);
+	return handle_function_call(symbol, symbol->called_function_declaration, false, NULL);
+}
 
 
 
@@ -1199,6 +1367,14 @@ void *constant_folding_c::visit( power_expression_c *symbol) {symbol->l_exp->acc
 void *constant_folding_c::visit(   neg_expression_c *symbol) {symbol->  exp->accept(*this); return handle_neg(symbol, symbol->exp);}
 void *constant_folding_c::visit(   not_expression_c *symbol) {symbol->  exp->accept(*this); return handle_not(symbol, symbol->exp);}
 
+/* NOTE: The parameter 'called_function_declaration', 'extensible_param_count' and 'candidate_functions' are used to pass data between the stage 3 and stage 4. */
+// SYM_REF3(function_invocation_c, function_name, formal_param_list, nonformal_param_list, symbol_c *called_function_declaration; int extensible_param_count; std::vector <symbol_c *> candidate_functions;)
+void *constant_folding_c::visit(function_invocation_c *symbol) {
+	if (NULL != symbol->   formal_param_list) symbol->   formal_param_list->accept(*this);
+	if (NULL != symbol->nonformal_param_list) symbol->nonformal_param_list->accept(*this);
+	return handle_function_call(symbol, symbol->called_function_declaration, false, NULL);
+}
+
 
 
 
@@ -1231,28 +1407,16 @@ constant_propagation_c::constant_propagation_c(symbol_c *symbol)
 constant_propagation_c::~constant_propagation_c(void) {}
 
 
-static constant_propagation_c::map_values_t inner_left_join_values(constant_propagation_c::map_values_t m1, constant_propagation_c::map_values_t m2) {
-	constant_propagation_c::map_values_t::const_iterator itr;
-	constant_propagation_c::map_values_t ret;
-
-	itr = m1.begin();
-	for ( ; itr != m1.end(); ++itr) {
-		std::string name = itr->first;
+/* Only the variables assigned to in either branch (since the values map was forked) are visited. */
+constant_propagation_c::map_values_t constant_propagation_c::inner_left_join_values(const map_values_t &m1, const map_values_t &m2) {
+	return map_values_t::left_join(m1, m2, [](const_value_c c1, const_value_c c2) {
 		const_value_c value;
-
-		if (m2.count(name) > 0) {
-			const_value_c c1 = itr->second;
-			const_value_c c2 = m2[name];
-			COMPUTE_MEET_SEMILATTICE (real64, c1, c2, value);
-			COMPUTE_MEET_SEMILATTICE (uint64, c1, c2, value);
-			COMPUTE_MEET_SEMILATTICE ( int64, c1, c2, value);
-			COMPUTE_MEET_SEMILATTICE (  bool, c1, c2, value);
-		} else
-			value = m1[name];
-		ret[name] = value;
-	}
-
-	return ret;
+		COMPUTE_MEET_SEMILATTICE (real64, c1, c2, value);
+		COMPUTE_MEET_SEMILATTICE (uint64, c1, c2, value);
+		COMPUTE_MEET_SEMILATTICE ( int64, c1, c2, value);
+		COMPUTE_MEET_SEMILATTICE (  bool, c1, c2, value);
+		return value;
+	});
 }
 
 /***************************/
@@ -1373,17 +1537,17 @@ void *constant_propagation_c::visit(library_c *symbol) {
 /*********************/
 #if DO_CONSTANT_PROPAGATION__
 void *constant_propagation_c::visit(symbolic_variable_c *symbol) {
-  std::string varName = get_var_name_c::get_name(symbol->var_name)->value.c_str();
-	if (values->count(varName) > 0) 
-		symbol->const_value = (*values)[varName];
+	const const_value_c *value = values->find_value(get_var_name_c::get_name(symbol->var_name)->value.view());
+	if (NULL != value)
+		symbol->const_value = *value;
 	return NULL;
 }
 #endif  // DO_CONSTANT_PROPAGATION__
 
 void *constant_propagation_c::visit(symbolic_constant_c *symbol) {
-  std::string varName = get_var_name_c::get_name(symbol->var_name)->value.c_str();
-	if (values->count(varName) > 0) 
-		symbol->const_value = (*values)[varName];
+	const const_value_c *value = values->find_value(get_var_name_c::get_name(symbol->var_name)->value.view());
+	if (NULL != value)
+		symbol->const_value = *value;
 	return NULL;
 }
 
@@ -1993,23 +2157,22 @@ void *constant_propagation_c::visit(if_statement_c *symbol) {
 	map_values_t values_incoming;
 	map_values_t values_statement_result;
 	map_values_t values_elsestatement_result;
-	map_values_t::iterator itr;
 
 	/* Optimize dead code */
 	symbol->expression->accept(*this);
 	if (VALID_CVALUE(bool, symbol->expression) && GET_CVALUE(bool, symbol->expression) == false)
 		return NULL;
 
-	values_incoming = values; /* save incoming status */
+	values_incoming = values->fork(); /* save incoming status (a cheap, shared copy) */
 	symbol->statement_list->accept(*this);
-	values_statement_result = values;
+	values_statement_result = std::move(*values);
 	if (NULL != symbol->else_statement_list) {
-		values = values_incoming;
+		*values = values_incoming;
 		symbol->else_statement_list->accept(*this);
-		values_elsestatement_result = values;
+		values_elsestatement_result = std::move(*values);
 	} else
 		values_elsestatement_result = values_incoming;
-	values = inner_left_join_values(values_statement_result, values_elsestatement_result);
+	*values = inner_left_join_values(values_statement_result, values_elsestatement_result);
 
 	return NULL;
 }
@@ -2021,10 +2184,10 @@ void *constant_propagation_c::visit(for_statement_c *symbol) {
 	map_values_t values_incoming;
 	map_values_t values_statement_result;
 
-	values_incoming = values; /* save incoming status */
+	values_incoming = values->fork(); /* save incoming status (a cheap, shared copy) */
 	symbol->beg_expression->accept(*this);
 	symbol->end_expression->accept(*this);
-	(*values)[get_var_name_c::get_name(symbol->control_variable)->value].m_int64.status = const_value_c::cs_non_const;
+	(*values)[get_var_name_c::get_name(symbol->control_variable)->value].m_int64.set_nonconst();
 
 	/* Optimize dead code */
 	if (NULL != symbol->by_expression) {
@@ -2048,8 +2211,8 @@ void *constant_propagation_c::visit(for_statement_c *symbol) {
 
 
 	symbol->statement_list->accept(*this);
-	values_statement_result = values;
-	values = inner_left_join_values(values_statement_result, values_incoming);
+	values_statement_result = std::move(*values);
+	*values = inner_left_join_values(values_statement_result, values_incoming);
 
 	return NULL;
 }
@@ -2063,10 +2226,10 @@ void *constant_propagation_c::visit(while_statement_c *symbol) {
 	if (VALID_CVALUE(bool, symbol->expression) && GET_CVALUE(bool, symbol->expression) == false)
 		return NULL;
 
-	values_incoming = values; /* save incoming status */
+	values_incoming = values->fork(); /* save incoming status (a cheap, shared copy) */
 	symbol->statement_list->accept(*this);
-	values_statement_result = values;
-	values = inner_left_join_values(values_statement_result, values_incoming);
+	values_statement_result = std::move(*values);
+	*values = inner_left_join_values(values_statement_result, values_incoming);
 
 	return NULL;
 }
@@ -2075,7 +2238,7 @@ void *constant_propagation_c::visit(repeat_statement_c *symbol) {
 	map_values_t values_incoming;
 	map_values_t values_statement_result;
 
-	values_incoming = values; /* save incoming status */
+	values_incoming = values->fork(); /* save incoming status (a cheap, shared copy) */
 	symbol->statement_list->accept(*this);
 
 	/* Optimize dead code */
@@ -2083,8 +2246,8 @@ void *constant_propagation_c::visit(repeat_statement_c *symbol) {
 	if (VALID_CVALUE(bool, symbol->expression) && GET_CVALUE(bool, symbol->expression) == true)
 		return NULL;
 
-	values_statement_result = values;
-	values = inner_left_join_values(values_statement_result, values_incoming);
+	values_statement_result = std::move(*values);
+	*values = inner_left_join_values(values_statement_result, values_incoming);
 
 	return NULL;
 }
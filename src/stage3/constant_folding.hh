@@ -39,16 +39,21 @@
  *       etc...
  */
 
+#include <map>
 #include <vector>
 #include "../absyntax_utils/absyntax_utils.hh"
 #include "../util/symtable.hh"
+#include "../util/persistent_symtable.hh"
 
 
 
 /* For the moment we disable constant propagation algorithm as it is not yet complete, 
  * and due to this is currently brocken and producing incorrect results!
+ * (The unit tests build it with the algorithm enabled, defining DO_CONSTANT_PROPAGATION__ to 1.)
  */
+#ifndef DO_CONSTANT_PROPAGATION__
 #define DO_CONSTANT_PROPAGATION__ 0
+#endif
 
 
 
@@ -62,6 +67,18 @@ class constant_folding_c : public iterator_visitor_c {
     symbol_c *prev_il_instruction;
     /* the current IL operand being analyzed */
     symbol_c *il_operand;
+    /* State of the worklist algorithm run over the IL instructions of an instruction_list_c, indexed by the
+     * position of each IL instruction in the list:
+     *   - the positions of the previous IL instructions of IL instruction i are il_prev[il_prev_begin[i] .. il_prev_begin[i+1]-1],
+     *     in the same order as its prev_il_instruction (-1 for an IL instruction that is not in the list),
+     *     and likewise for the next IL instructions in il_next/il_next_begin;
+     *   - whether each IL instruction has already been reached, and the position of the one being visited.
+     */
+    std::vector<int> il_prev_begin, il_prev, il_next_begin, il_next;
+    std::vector<bool> il_reached;
+    int il_current;
+    std::vector<symbol_c *> il_prev_scratch; /* reused by reached_prev_il_instructions() */
+    const std::vector<symbol_c *> &reached_prev_il_instructions(il_instruction_c *symbol);
 
 
 
@@ -102,14 +119,14 @@ class constant_folding_c : public iterator_visitor_c {
     /***********************************/
     /* B 2.1 Instructions and Operands */
     /***********************************/
-    // void *visit(instruction_list_c *symbol); /* Not needed, since we inherit from iterator_visitor_c */
+    void *visit(instruction_list_c *symbol);
     void *visit(il_instruction_c *symbol);
     void *visit(il_simple_operation_c *symbol);
-    //void *visit(il_function_call_c *symbol);  /* TODO */
+    void *visit(il_function_call_c *symbol);
     void *visit(il_expression_c *symbol);
     void *visit(il_jump_operation_c *symbol);
     void *visit(il_fb_call_c *symbol);
-    //void *visit(il_formal_funct_call_c *symbol);   /* TODO */
+    void *visit(il_formal_funct_call_c *symbol);
     //void *visit(il_operand_list_c *symbol);  /* Not needed, since we inherit from iterator_visitor_c */
     void *visit(simple_instr_list_c *symbol);
     void *visit(il_simple_instruction_c *symbol);
@@ -187,7 +204,7 @@ class constant_folding_c : public iterator_visitor_c {
     void *visit( power_expression_c *symbol);
     void *visit(   neg_expression_c *symbol);
     void *visit(   not_expression_c *symbol);
-    //void *visit(function_invocation_c *symbol); /* TODO */
+    void *visit(function_invocation_c *symbol);
 };
 
 
@@ -207,7 +224,8 @@ class constant_propagation_c : public constant_folding_c {
   public:
     constant_propagation_c(symbol_c *symbol = NULL);
     virtual ~constant_propagation_c(void);
-    typedef symtable_c<const_value_c> map_values_t;
+    /* Forked at every branch of IF/CASE/loop statements, so we use a table with cheap (shared) forks. */
+    typedef persistent_symtable_c<const_value_c> map_values_t;
   private:
     symbol_c *current_resource;
     symbol_c *current_configuration;
@@ -225,7 +243,7 @@ class constant_propagation_c : public constant_folding_c {
     bool function_pou_;
     bool is_constant(symbol_c *option);
     bool is_retain  (symbol_c *option);
-    static map_values_t inner_left_join_values(map_values_t m1, map_values_t m2);
+    static map_values_t inner_left_join_values(const map_values_t &m1, const map_values_t &m2);
 
 
   private:
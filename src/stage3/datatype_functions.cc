@@ -385,10 +385,25 @@ const struct widen_entry widen_CMP_table[] = {
 /* Search for a datatype inside a candidate_datatypes list.
  * Returns: position of datatype in the list, or -1 if not found.
  */
-int search_in_candidate_datatype_list(symbol_c *datatype, const std::vector <symbol_c *> &candidate_datatypes) {
+int search_in_candidate_datatype_list(symbol_c *datatype, const candidate_datatypes_c &candidate_datatypes) {
 	if (NULL == datatype) 
 		return -1;
 
+	/* An elementary datatype can only be equal to a candidate of the same class (which would be marked in the
+	 * elementary_mask), or to a generic datatype (which would be counted as non elementary).
+	 * Any other datatype can only be equal to a non elementary candidate, unless it is itself the generic ANY.
+	 */
+	if (candidate_datatypes.empty())
+		return -1;
+	if (candidate_datatypes.non_elementary_count() == 0) {
+		int bit = candidate_datatypes_c::elementary_bit(datatype);
+		if (bit >= 0) {
+			if (!candidate_datatypes.has_elementary(bit))
+				return -1;
+		} else if (!get_datatype_info_c::is_type_valid(datatype) || !get_datatype_info_c::is_ANY_generic_type(datatype))
+			return -1;
+	}
+
 	for(unsigned int i = 0; i < candidate_datatypes.size(); i++)
 		if (get_datatype_info_c::is_type_equal(datatype, candidate_datatypes[i]))
 			return i;
@@ -399,7 +414,7 @@ int search_in_candidate_datatype_list(symbol_c *datatype, const std::vector <sym
 /* Remove a datatype inside a candidate_datatypes list.
  * Returns: If successful it returns true, false otherwise.
  */
-bool remove_from_candidate_datatype_list(symbol_c *datatype, std::vector <symbol_c *> &candidate_datatypes) {
+bool remove_from_candidate_datatype_list(symbol_c *datatype, candidate_datatypes_c &candidate_datatypes) {
 	int pos = search_in_candidate_datatype_list(datatype, candidate_datatypes);
 	if (pos < 0)
 		return false;
@@ -420,13 +435,20 @@ void intersect_candidate_datatype_list(symbol_c *list1 /*origin, dest.*/, symbol
 		/* In principle, we should never call it with NULL values. Best to abort the compiler just in case! */
 		return;
 
-	for(std::vector<symbol_c *>::iterator i = list1->candidate_datatypes.begin(); i < list1->candidate_datatypes.end(); ) {
+	/* If both lists only contain elementary datatypes, the intersection is simply the AND of both masks. */
+	if (   (list1->candidate_datatypes.non_elementary_count() == 0)
+	    && (list2->candidate_datatypes.non_elementary_count() == 0)) {
+		list1->candidate_datatypes.keep_elementary(list2->candidate_datatypes.elementary_mask());
+		return;
+	}
+
+	for(candidate_datatypes_c::iterator i = list1->candidate_datatypes.begin(); i < list1->candidate_datatypes.end(); ) {
 		/* Note that we do _not_ increment i in the for() loop!
 		 * When we erase an element from position i, a new element will take it's place, that must also be tested! 
 		 */
 		if (search_in_candidate_datatype_list(*i, list2->candidate_datatypes) < 0)
 			/* remove this element! This will change the value of candidate_datatypes.size() */
-			list1->candidate_datatypes.erase(i);
+			i = list1->candidate_datatypes.erase(i);
 		else i++;
 	}
 }
@@ -77,12 +77,12 @@ extern const struct widen_entry widen_CMP_table[];
 /* Search for a datatype inside a candidate_datatypes list.
  * Returns: position of datatype in the list, or -1 if not found.
  */
-int search_in_candidate_datatype_list(symbol_c *datatype, const std::vector <symbol_c *> &candidate_datatypes);
+int search_in_candidate_datatype_list(symbol_c *datatype, const candidate_datatypes_c &candidate_datatypes);
 
 /* Remove a datatype inside a candidate_datatypes list.
  * Returns: If successful it returns true, false otherwise.
  */
-bool remove_from_candidate_datatype_list(symbol_c *datatype, std::vector <symbol_c *> &candidate_datatypes);
+bool remove_from_candidate_datatype_list(symbol_c *datatype, candidate_datatypes_c &candidate_datatypes);
 
 /* Intersect two candidate_datatype_lists.
  * Remove from list1 (origin, dest.) all elements that are not found in list2 (with).
@@ -149,10 +149,12 @@ class populate_enumvalue_symtable_c: public iterator_visitor_c {
 
 
 
+symbol_c::enumvalue_symtable_t *enum_declaration_check_c::library_enumvalue_symtable = NULL;
+
 enum_declaration_check_c::enum_declaration_check_c(symbol_c *ignore) {
   error_count = 0;
   current_display_error_level = 0;
-  global_enumvalue_symtable = NULL;
+  global_enumvalue_symtable = library_enumvalue_symtable;
   populate_enumvalue_symtable = new populate_enumvalue_symtable_c(error_count, current_display_error_level);
 }
 
@@ -164,6 +166,19 @@ enum_declaration_check_c::~enum_declaration_check_c(void) {
 int enum_declaration_check_c::get_error_count() {return error_count;}
 
 
+/* static method! */
+void enum_declaration_check_c::enter_library(symbol_c *library) {
+  library_c *symbol = dynamic_cast<library_c *>(library);
+  if (NULL == symbol) ERROR;
+  library_enumvalue_symtable = &(symbol->enumvalue_symtable);
+}
+
+/* static method! */
+void enum_declaration_check_c::leave_library(void) {
+  library_enumvalue_symtable = NULL;
+}
+
+
 /***************************/
 /* B 0 - Programming Model */
 /***************************/
@@ -40,12 +40,20 @@ class enum_declaration_check_c : public iterator_visitor_c {
     int current_display_error_level;
     populate_enumvalue_symtable_c *populate_enumvalue_symtable;
     symbol_c::enumvalue_symtable_t *global_enumvalue_symtable;
+    /* the table of the library set by enter_library() */
+    static symbol_c::enumvalue_symtable_t *library_enumvalue_symtable;
     
   public:
      enum_declaration_check_c(symbol_c *ignore);
     ~enum_declaration_check_c(void);
     int get_error_count();
 
+    /* When the elements of the library are visited separately (instead of visiting the library_c),
+     * enter_library() must be called before, and leave_library() after, visiting them.
+     */
+    static void enter_library(symbol_c *library);
+    static void leave_library(void);
+
     
     /***************************/
     /* B 0 - Programming Model */
@@ -62,6 +62,7 @@
 #include <../main.hh>         /* required for UINT64_MAX, INT64_MAX, INT64_MIN, ... */
 #include "fill_candidate_datatypes.hh"
 #include "datatype_functions.hh"
+#include "function_call_cache.hh"
 #include "matiec/string_utils.hpp"
 #include <typeinfo>
 #include <list>
@@ -77,6 +78,10 @@
 static int debug = 0;
 
 
+/* The compatible declarations of the function invocations already resolved in the library being analysed. */
+static function_call_cache_c function_call_cache;
+
+
 
 /*****************************************************/
 /*                                                   */
@@ -199,7 +204,8 @@ static populate_globalenumvalue_symtable_c populate_globalenumvalue_symtable;
  *     END_FUNCTION_BLOCK
  */
  
-static enumerated_value_symtable_t local_enumerated_value_symtable;
+/* NOTE: the POUs may be analysed in parallel, each thread with its own table. */
+static thread_local enumerated_value_symtable_t local_enumerated_value_symtable;
 
 
 class populate_localenumvalue_symtable_c: public iterator_visitor_c {
@@ -253,7 +259,7 @@ class populate_localenumvalue_symtable_c: public iterator_visitor_c {
   }
 }; // class populate_enumvalue_symtable_c
 
-static populate_localenumvalue_symtable_c populate_enumvalue_symtable;
+static thread_local populate_localenumvalue_symtable_c populate_enumvalue_symtable;
 
 
 
@@ -426,7 +432,7 @@ bool fill_candidate_datatypes_c::match_formal_call(symbol_c *f_call, symbol_c *f
 			return false;
 
 		/* Obtaining the type of the value being passed in the function call */
-		std::vector <symbol_c *>&call_param_types = call_param_value->candidate_datatypes;
+		candidate_datatypes_c &call_param_types = call_param_value->candidate_datatypes;
 
 		/* Find the corresponding parameter in function declaration */
 		param_name = fp_iterator.search(call_param_name);
@@ -520,22 +526,49 @@ void fill_candidate_datatypes_c::handle_function_call(symbol_c *fcall, generic_f
 			fcall_data.candidate_functions.push_back(f_decl);
 		
 	}
-	for(; lower != upper; lower++) {
-		bool compatible = false;
-		
-		f_decl = function_symtable.get_value(lower);
-		/* Check if function declaration in symbol_table is compatible with parameters */
-		if (NULL != fcall_data.nonformal_operand_list) compatible=match_nonformal_call(fcall, f_decl);
-		if (NULL != fcall_data.   formal_operand_list) compatible=   match_formal_call(fcall, f_decl);
-		if (compatible) {
-			/* Add the data type returned by the called functions. 
-			 * However, only do this if this data type is not already present in the candidate_datatypes list_c
-			 */
-			returned_parameter_type = base_type(f_decl->type_name);		
-			if (add_datatype_to_candidate_list(fcall, returned_parameter_type))
-				/* we only add it to the function declaration list if this entry was not already present in the candidate datatype list! */
-				fcall_data.candidate_functions.push_back(f_decl);
+
+	/* The declarations compatible with this invocation, in function_symtable order.
+	 * Invocations with the same signature (see function_call_cache.hh) are only resolved once.
+	 */
+	std::vector <function_declaration_c *> compatible;
+	std::string signature;
+	if (function_call_cache.enabled()) signature = function_call_cache_c::signature(fcall, fcall_data);
+	if (signature.empty() || !function_call_cache.lookup(signature, compatible)) {
+		/* For non-formal invocations, only check the overloads that accept the number of parameters being passed, and whose
+		 * first parameter may take the datatype of the first value being passed. The function_overload_index returns them
+		 * in the same order as they appear in the function_symtable.
+		 */
+		std::vector <function_declaration_c *> overloads;
+		if ((NULL != fcall_data.nonformal_operand_list) && (NULL == fcall_data.formal_operand_list)) {
+			function_call_param_iterator_c fcp_iterator(fcall);
+			symbol_c *first_param_value = fcp_iterator.next_nf();
+			int nf_param_count = (NULL == first_param_value)? 0 : 1;
+			while (fcp_iterator.next_nf() != NULL) nf_param_count++;
+			function_overload_index.nonformal_candidates(fcall_data.function_name, first_param_value, nf_param_count, overloads);
+		} else {
+			for(; lower != upper; lower++)
+				overloads.push_back(function_symtable.get_value(lower));
+		}
+
+		for(unsigned int i = 0; i < overloads.size(); i++) {
+			bool compatible_call = false;
+			/* Check if function declaration in symbol_table is compatible with parameters */
+			if (NULL != fcall_data.nonformal_operand_list) compatible_call=match_nonformal_call(fcall, overloads[i]);
+			if (NULL != fcall_data.   formal_operand_list) compatible_call=   match_formal_call(fcall, overloads[i]);
+			if (compatible_call) compatible.push_back(overloads[i]);
 		}
+		if (!signature.empty()) function_call_cache.insert(signature, compatible);
+	}
+
+	for(unsigned int i = 0; i < compatible.size(); i++) {
+		f_decl = compatible[i];
+		/* Add the data type returned by the called functions. 
+		 * However, only do this if this data type is not already present in the candidate_datatypes list_c
+		 */
+		returned_parameter_type = base_type(f_decl->type_name);		
+		if (add_datatype_to_candidate_list(fcall, returned_parameter_type))
+			/* we only add it to the function declaration list if this entry was not already present in the candidate datatype list! */
+			fcall_data.candidate_functions.push_back(f_decl);
 	}
 	if (debug) std::cout << "end_function() [" << fcall->candidate_datatypes.size() << "] result.\n";
 	return;
@@ -683,19 +716,32 @@ symbol_c *fill_candidate_datatypes_c::base_type(symbol_c *symbol) {
 /***************************/
 /* main entry function! */
 void *fill_candidate_datatypes_c::visit(library_c *symbol) {
+        enter_library(symbol);
+        /* Now let the base class iterator_visitor_c iterate through all the library elements */
+        void *res = iterator_visitor_c::visit(symbol);
+        leave_library();
+        return res;
+}
+
+
+/* static method! */
+void fill_candidate_datatypes_c::enter_library(symbol_c *library) {
         // These tables store raw pointers into the AST. Clear them at the start
         // of each compilation to avoid use-after-free across in-process runs.
         global_enumerated_value_symtable.reset();
         local_enumerated_value_symtable.reset();
 
-        symbol->accept(populate_globalenumvalue_symtable);
-        /* Now let the base class iterator_visitor_c iterate through all the library elements */
-        void *res = iterator_visitor_c::visit(symbol);
+        library->accept(populate_globalenumvalue_symtable);
+        function_call_cache.enable();
+}
+
 
+/* static method! */
+void fill_candidate_datatypes_c::leave_library(void) {
         // Do not retain dangling pointers once the analysis is complete.
         global_enumerated_value_symtable.reset();
         local_enumerated_value_symtable.reset();
-        return res;
+        function_call_cache.disable();
 }
 
 
@@ -720,7 +766,8 @@ void *fill_candidate_datatypes_c::visit(library_c *symbol) {
  * explicitly (assuming we do also implement the visitor for poutype_identifier_c). However, I will leave this code cleanup for some later oportunity.
  */
 void *fill_candidate_datatypes_c::visit(derived_datatype_identifier_c *symbol) {
-  add_datatype_to_candidate_list(symbol, base_type(                type_symtable[symbol->value])); // will only add if datatype is not NULL!
+  symbol_c *type_decl = (NULL != symbol->decl)? symbol->decl : type_symtable[symbol->value];
+  add_datatype_to_candidate_list(symbol, base_type(type_decl)); // will only add if datatype is not NULL!
   return NULL;
 }
 
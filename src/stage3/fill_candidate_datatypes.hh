@@ -47,6 +47,9 @@
  * WARNING: This visitor class starts off by building a map of all enumeration constants that are defined in the source code (i.e. a library_c symbol),
  *          and this map is later used to determine the datatpe of each use of an enumeration constant. By implication, the fill_candidate_datatypes_c 
  *          visitor class will only work corretly if it is asked to visit a symbol of class library_c!!
+ *          The only exception is when each element of the library is visited separately (e.g. when stage3 analyses
+ *          the POUs in parallel). In that case enter_library() must be called before, and leave_library() after,
+ *          visiting the library elements.
  */
 
 
@@ -115,6 +118,10 @@ class fill_candidate_datatypes_c: public iterator_visitor_c {
     fill_candidate_datatypes_c(symbol_c *ignore);
     virtual ~fill_candidate_datatypes_c(void);
 
+    /* Build/clear the map of the enumeration constants declared in the library. */
+    static void enter_library(symbol_c *library);
+    static void leave_library(void);
+
     
     /***************************/
     /* B 0 - Programming Model */
@@ -115,6 +115,8 @@
 
 #include "flow_control_analysis.hh"
 
+#include <unordered_map>
+
 
 
 /* set to 1 to see debug info during execution */
@@ -215,6 +217,25 @@ void *flow_control_analysis_c::visit(configuration_declaration_c *symbol) {
 /*| instruction_list il_instruction */
 // SYM_LIST(instruction_list_c)
 void *flow_control_analysis_c::visit(instruction_list_c *symbol) {
+	/* Size the prev_il_instruction vectors up front, so they are not grown one element at a time
+	 * when many jumps lead to the same label: each il_instruction has (at most) one previous
+	 * il_instruction in the previous line, and one more for every jump to its label.
+	 */
+	std::unordered_map<symbol_c *, unsigned int> jumps_to;
+	if (NULL != search_il_label)
+		for(int i = 0; i < symbol->n; i++) {
+			il_instruction_c    *il_instruction = dynamic_cast<il_instruction_c    *>(symbol->get_element(i));
+			il_jump_operation_c *jump           = (NULL == il_instruction)? NULL : dynamic_cast<il_jump_operation_c *>(il_instruction->il_instruction);
+			if (NULL != jump)
+				jumps_to[search_il_label->find_label(jump->label)]++;
+		}
+	for(int i = 0; i < symbol->n; i++) {
+		il_instruction_c *il_instruction = dynamic_cast<il_instruction_c *>(symbol->get_element(i));
+		if (NULL == il_instruction) continue;
+		std::unordered_map<symbol_c *, unsigned int>::const_iterator jumps = jumps_to.find(il_instruction);
+		il_instruction->prev_il_instruction.reserve(il_instruction->prev_il_instruction.size() + 1 + ((jumps == jumps_to.end())? 0 : jumps->second));
+	}
+
 	prev_il_instruction_is_JMP_or_RET = false;
 	for(int i = 0; i < symbol->n; i++) {
 		prev_il_instruction = NULL;
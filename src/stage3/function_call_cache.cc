@@ -0,0 +1,130 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * An IEC 61131-3 compiler.
+ *
+ * Based on the
+ * FINAL DRAFT - IEC 61131-3, 2nd Ed. (2001-12-10)
+ *
+ */
+
+
+/*
+ *  Memoized overload resolution of function invocations.
+ *  See function_call_cache.hh for details.
+ */
+
+
+#include "function_call_cache.hh"
+#include "../absyntax_utils/absyntax_utils.hh"
+
+#include <cctype>
+#include <mutex>
+
+
+/* Identifiers are case insensitive. */
+static void append_name(std::string &key, symbol_c *name) {
+  token_c *token = dynamic_cast<token_c *>(name);
+  if (NULL == token) ERROR;
+  for (char c : matiec::sv_or_empty(token->value))
+    key.push_back(std::toupper(static_cast<unsigned char>(c)));
+  key.push_back('\0');
+}
+
+
+static void append_datatypes(std::string &key, symbol_c *value) {
+  const candidate_datatypes_c &candidate_datatypes = value->candidate_datatypes;
+  size_t count = candidate_datatypes.size();
+  key.append(reinterpret_cast<const char *>(&count), sizeof(count));
+  for (symbol_c *datatype : candidate_datatypes)
+    key.append(reinterpret_cast<const char *>(&datatype), sizeof(datatype));
+}
+
+
+
+void function_call_cache_c::enable(void) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  cache.clear();
+  enabled_ = true;
+}
+
+
+void function_call_cache_c::disable(void) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  cache.clear();
+  enabled_ = false;
+}
+
+
+
+std::string function_call_cache_c::signature(symbol_c *fcall, const generic_function_call_t &fcall_data) {
+  std::string key;
+  append_name(key, fcall_data.function_name);
+
+  /* This must cover everything fill_candidate_datatypes_c::match_nonformal_call() and
+   * fill_candidate_datatypes_c::match_formal_call() look at in the function invocation.
+   */
+  symbol_c *param_name, *param_value;
+  if (NULL != fcall_data.nonformal_operand_list) {
+    key.push_back('n');
+    function_call_param_iterator_c fcp_iterator(fcall);
+    while ((param_value = fcp_iterator.next_nf()) != NULL) {
+      key.push_back(',');
+      append_datatypes(key, param_value);
+    }
+  }
+  if (NULL != fcall_data.formal_operand_list) {
+    key.push_back('f');
+    function_call_param_iterator_c fcp_iterator(fcall);
+    while ((param_name = fcp_iterator.next_f()) != NULL) {
+      param_value = fcp_iterator.get_current_value();
+      if (NULL == param_value) ERROR;
+      key.push_back(',');
+      append_name(key, param_name);
+      key.push_back((function_call_param_iterator_c::assign_out == fcp_iterator.get_assign_direction())? '>' : '=');
+      append_datatypes(key, param_value);
+    }
+  }
+  return key;
+}
+
+
+
+bool function_call_cache_c::lookup(const std::string &signature, overloads_t &overloads) const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  std::unordered_map<std::string, overloads_t>::const_iterator it = cache.find(signature);
+  if (it == cache.end()) return false;
+  overloads = it->second;
+  return true;
+}
+
+
+void function_call_cache_c::insert(const std::string &signature, const overloads_t &overloads) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  if (enabled_) cache.emplace(signature, overloads);
+}
+
+
+size_t function_call_cache_c::size(void) const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  return cache.size();
+}
@@ -0,0 +1,92 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * An IEC 61131-3 compiler.
+ *
+ * Based on the
+ * FINAL DRAFT - IEC 61131-3, 2nd Ed. (2001-12-10)
+ *
+ */
+
+
+/*
+ *  Memoized overload resolution of function invocations.
+ *
+ *  The same call shape (e.g. ADD(INT, INT), or INT_TO_REAL(x)) is typically found
+ *  over and over again in a project. Which of the declarations of the called function
+ *  are compatible with an invocation only depends on
+ *    - the name of the function,
+ *    - whether the parameters are passed formally or non-formally (and, for formal
+ *      invocations, the name and assignment direction (:= or =>) of each parameter),
+ *    - the candidate datatypes of each value being passed, in order.
+ *  fill_candidate_datatypes_c builds this signature for each invocation, and only
+ *  matches the parameters against the declarations the first time it sees it.
+ *
+ *  The cached declarations are kept in function_symtable order, so the candidate
+ *  datatypes (and candidate functions) of an invocation do not depend on whether
+ *  they came from the cache or not.
+ *
+ *  The cache stores raw pointers into the AST, so it is only enabled while a library
+ *  is being analysed (see fill_candidate_datatypes_c::enter_library()), and is cleared
+ *  when enabled and disabled. It may be used by several threads at the same time.
+ */
+
+
+#ifndef _FUNCTION_CALL_CACHE_HH
+#define _FUNCTION_CALL_CACHE_HH
+
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../absyntax/absyntax.hh"
+#include "datatype_functions.hh"
+
+
+class function_call_cache_c {
+  public:
+    typedef std::vector<function_declaration_c *> overloads_t;
+
+    void enable (void);
+    void disable(void);
+    bool enabled(void) const {return enabled_;}
+
+    /* The signature of the function invocation fcall.
+     * The candidate_datatypes of all the parameters being passed must already have been filled in.
+     */
+    static std::string signature(symbol_c *fcall, const generic_function_call_t &fcall_data);
+
+    /* Returns true, and the compatible declarations in overloads, if the signature has already been resolved. */
+    bool lookup(const std::string &signature, overloads_t &overloads) const;
+    void insert(const std::string &signature, const overloads_t &overloads);
+
+    size_t size(void) const;
+
+  private:
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, overloads_t> cache;
+    bool enabled_ = false;
+};
+
+
+#endif /* _FUNCTION_CALL_CACHE_HH */
@@ -12,11 +12,6 @@
 
 namespace {
 
-matiec::types::TypeRegistry& legacy_type_registry() {
-    static matiec::types::TypeRegistry registry;
-    return registry;
-}
-
 bool is_safe_type_name(std::string_view name) {
     return name.rfind("SAFE", 0) == 0;
 }
@@ -86,80 +81,107 @@ void assign_status_from_legacy(const_value_c& legacy,
 
 matiec::types::TypedConstValue typed_const_value_from_legacy(
     const_value_c& legacy,
-    const std::shared_ptr<const matiec::types::Type>& type) {
+    matiec::types::TypeId type) {
     matiec::types::TypedConstValue out;
     out.type = type;
     out.value = std::monostate{};
-    if (!type) {
+    const matiec::types::Type* resolved = matiec::stage3::modern_type_registry().type(type);
+    if (!resolved) {
         return out;
     }
-    assign_status_from_legacy(legacy, out, type->category());
+    assign_status_from_legacy(legacy, out, resolved->category());
     return out;
 }
 
-bool contains_type(const std::vector<std::shared_ptr<const matiec::types::Type>>& types,
-                   const std::shared_ptr<const matiec::types::Type>& type) {
-    return std::any_of(types.begin(), types.end(),
-                       [&](const auto& entry) { return entry == type; });
-}
-
 } // namespace
 
 namespace matiec::stage3 {
 
-std::shared_ptr<const types::Type> resolve_legacy_type(symbol_c *type_symbol) {
+types::TypeRegistry& modern_type_registry() {
+    /* Only the elementary types are registered, all of them when it is built,
+     * so the per-POU passes running in parallel only ever read from it.
+     */
+    static types::TypeRegistry registry;
+    return registry;
+}
+
+types::TypeId resolve_legacy_type(symbol_c *type_symbol) {
     if (!get_datatype_info_c::is_type_valid(type_symbol)) {
-        return {};
+        return types::kNoType;
     }
     symbol_c *type_id = get_datatype_info_c::get_id(type_symbol);
     if (!type_id) {
-        return {};
+        return types::kNoType;
     }
     const char* name = get_datatype_info_c::get_id_str(type_id);
     if (!name) {
-        return {};
+        return types::kNoType;
     }
     std::string_view view(name);
     if (is_safe_type_name(view)) {
-        return {};
+        return types::kNoType;
     }
     view = normalize_legacy_name(view);
-    return legacy_type_registry().findType(view);
+    return modern_type_registry().findTypeId(view);
 }
 
 void populate_modern_annotations(symbol_c *symbol) {
     if (!symbol) {
         return;
     }
+    symbol->reset_modern_annotations();
+    (void)symbol->get_datatype_modern();
+}
+
+void modern_semantic_annotations_c::prefix_fcall(symbol_c *symbol) {
+    populate_modern_annotations(symbol);
+}
+
+} // namespace matiec::stage3
+
 
-    symbol->candidate_types.clear();
-    for (auto* legacy_type : symbol->candidate_datatypes) {
-        auto modern_type = resolve_legacy_type(legacy_type);
-        if (!modern_type || contains_type(symbol->candidate_types, modern_type)) {
+/* The symbol_c queries of the modern annotations, declared in absyntax.hh */
+void symbol_c::derive_modern_annotations(void) {
+    namespace types = matiec::types;
+    const types::TypeRegistry& registry = matiec::stage3::modern_type_registry();
+    candidate_types.clear();
+    for (auto* legacy_type : candidate_datatypes) {
+        const types::TypeId modern_type = matiec::stage3::resolve_legacy_type(legacy_type);
+        if (modern_type == types::kNoType ||
+            std::find(candidate_types.begin(), candidate_types.end(), modern_type) != candidate_types.end()) {
             continue;
         }
-        symbol->candidate_types.push_back(std::move(modern_type));
+        candidate_types.push_back(modern_type);
     }
 
-    symbol->datatype_modern = resolve_legacy_type(symbol->datatype);
-    if (symbol->datatype_modern) {
-        symbol->candidate_types.erase(
-            std::remove_if(symbol->candidate_types.begin(),
-                           symbol->candidate_types.end(),
-                           [&](const auto& candidate) {
-                               return !candidate ||
-                                      !candidate->isAssignableTo(*symbol->datatype_modern);
+    datatype_modern = matiec::stage3::resolve_legacy_type(datatype);
+    if (datatype_modern != types::kNoType) {
+        const types::Type& modern_datatype = *registry.type(datatype_modern);
+        candidate_types.erase(
+            std::remove_if(candidate_types.begin(),
+                           candidate_types.end(),
+                           [&](types::TypeId candidate) {
+                               return !registry.type(candidate)->isAssignableTo(modern_datatype);
                            }),
-            symbol->candidate_types.end());
-        symbol->const_value_modern =
-            typed_const_value_from_legacy(symbol->const_value, symbol->datatype_modern);
+            candidate_types.end());
+        const_value_modern = typed_const_value_from_legacy(const_value, datatype_modern);
     } else {
-        symbol->const_value_modern = types::TypedConstValue{};
+        const_value_modern = types::TypedConstValue{};
     }
+    modern_annotations_valid = true;
 }
 
-void modern_semantic_annotations_c::prefix_fcall(symbol_c *symbol) {
-    populate_modern_annotations(symbol);
+matiec::types::TypeId symbol_c::get_datatype_modern(void) {
+    if (!modern_annotations_valid) derive_modern_annotations();
+    return datatype_modern;
 }
 
-} // namespace matiec::stage3
+const std::vector<matiec::types::TypeId> &symbol_c::get_candidate_types_modern(void) {
+    if (!modern_annotations_valid) derive_modern_annotations();
+    return candidate_types;
+}
+
+const matiec::types::TypedConstValue &symbol_c::get_const_value_modern(void) {
+    if (!modern_annotations_valid) derive_modern_annotations();
+    return const_value_modern;
+}
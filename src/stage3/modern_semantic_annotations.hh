@@ -5,16 +5,20 @@
 #ifndef MATIEC_STAGE3_MODERN_SEMANTIC_ANNOTATIONS_HH
 #define MATIEC_STAGE3_MODERN_SEMANTIC_ANNOTATIONS_HH
 
-#include <memory>
-
 #include "absyntax/visitor.hh"
-#include "matiec/types/type.hpp"
+#include "matiec/types/type_registry.hpp"
 
 namespace matiec::stage3 {
 
-std::shared_ptr<const types::Type> resolve_legacy_type(symbol_c *type_symbol);
+/* The registry the TypeIds stored in the AST annotations refer to */
+types::TypeRegistry& modern_type_registry();
+types::TypeId resolve_legacy_type(symbol_c *type_symbol);
+/* Derive (again) the modern annotations of a symbol from its legacy ones.
+ * Usually called on demand by the symbol_c::get_*_modern() queries.
+ */
 void populate_modern_annotations(symbol_c *symbol);
 
+/* Derive the modern annotations of every symbol of a tree up front. */
 class modern_semantic_annotations_c : public fcall_iterator_visitor_c {
 public:
     void prefix_fcall(symbol_c *symbol) override;
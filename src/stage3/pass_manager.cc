@@ -0,0 +1,237 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * An IEC 61131-3 compiler.
+ *
+ * Based on the
+ * FINAL DRAFT - IEC 61131-3, 2nd Ed. (2001-12-10)
+ *
+ */
+
+/*
+ * Runs the stage3 passes.
+ * See pass_manager.hh for details.
+ */
+
+#include "pass_manager.hh"
+#include "stage3_diagnostics.hh"
+#include "../util/work_pool.hh"
+#include "../main.hh" // required for ERROR() and ERROR_MSG() macros.
+
+#include <exception>
+#include <mutex>
+
+
+namespace matiec::stage3 {
+
+
+static bool is_pou(symbol_c *element) {
+  return (   (NULL != dynamic_cast<function_declaration_c       *>(element))
+          || (NULL != dynamic_cast<function_block_declaration_c *>(element))
+          || (NULL != dynamic_cast<program_declaration_c        *>(element)));
+}
+
+static bool is_configuration(symbol_c *element) {
+  return (NULL != dynamic_cast<configuration_declaration_c *>(element));
+}
+
+
+
+void pass_manager_c::add(pass_t pass) {
+  for (const std::string &dependency : pass.depends_on) {
+    bool found = false;
+    for (const pass_t &previous : passes)
+      if (dependency == previous.name) found = true;
+    if (!found) ERROR_MSG("stage3 pass %s depends on pass %s, which does not run before it.", pass.name, dependency.c_str());
+  }
+  passes.push_back(std::move(pass));
+}
+
+
+
+std::vector<std::vector<size_t>> pass_manager_c::traversals(void) const {
+  std::vector<std::vector<size_t>> result;
+  for (size_t i = 0; i < passes.size(); i++) {
+    bool fuse = !result.empty() && passes[i].per_pou && passes[result.back().front()].per_pou;
+    /* a pass can not share a traversal with a pass it depends on */
+    for (size_t j = 0; fuse && (j < result.back().size()); j++)
+      for (const std::string &dependency : passes[i].depends_on)
+        if (dependency == passes[result.back()[j]].name) fuse = false;
+    if (fuse) result.back().push_back(i);
+    else      result.push_back(std::vector<size_t>(1, i));
+  }
+  return result;
+}
+
+
+
+int pass_manager_c::run(symbol_c *tree_root, unsigned int jobs) const {
+  library_c *library = dynamic_cast<library_c *>(tree_root);
+  std::vector<symbol_c *> elements;
+  for (int i = 0; (NULL != library) && (i < library->n); i++) elements.push_back(library->get_element(i));
+  return run(tree_root, library, elements, jobs);
+}
+
+
+int pass_manager_c::run(library_c *library, const std::vector<symbol_c *> &elements, unsigned int jobs) const {
+  if (NULL == library) ERROR;
+  return run(NULL, library, elements, jobs);
+}
+
+
+int pass_manager_c::run(symbol_c *tree_root, library_c *library, const std::vector<symbol_c *> &elements, unsigned int jobs) const {
+  int error_count = 0;
+  for (const std::vector<size_t> &traversal : traversals()) {
+    /* Once the maximum number of errors has been reported, the remaining passes would only find more errors */
+    if (error_budget_exhausted()) break;
+    if ((NULL == library) || ((NULL != tree_root) && !passes[traversal.front()].per_pou)) {
+      for (size_t pass : traversal)
+        if (!error_budget_exhausted()) error_count += passes[pass].run(tree_root);
+      continue;
+    }
+    for (size_t pass : traversal)
+      if (NULL != passes[pass].enter_library) passes[pass].enter_library(library);
+    if (passes[traversal.front()].per_pou) {
+      error_count += run_per_element(elements, traversal, jobs);
+    } else {
+      /* only some of the elements are analysed, so the pass can not walk the whole library */
+      for (size_t pass : traversal)
+        for (symbol_c *element : elements)
+          if (!error_budget_exhausted()) error_count += passes[pass].run(element);
+    }
+    for (size_t pass : traversal)
+      if (NULL != passes[pass].leave_library) passes[pass].leave_library();
+  }
+  return error_count;
+}
+
+
+
+/* Run the passes of the traversal on each of the library elements, one element after the other.
+ *
+ * The datatype declarations are analysed before the POUs, and the configurations after them, as
+ * the analysis of a POU may look into the datatype declarations, and the analysis of a configuration
+ * into the POUs. Besides those declarations, the POUs only share the tables built by
+ * absyntax_utils_init(), which stage3 does not modify, so the POUs are analysed in parallel.
+ */
+int pass_manager_c::run_per_element(const std::vector<symbol_c *> &elements, const std::vector<size_t> &traversal, unsigned int jobs) const {
+  const int n = elements.size();
+  const int pass_count = traversal.size();
+  /* indexed by [pass * n + element] */
+  std::vector<diagnostic_buffer_c> buffers(pass_count * n);
+  std::vector<int> error_counts(pass_count * n, 0);
+  /* the pass whose analysis of each element threw an exception, if any */
+  std::vector<int> failed_pass(n, pass_count);
+  std::vector<std::exception_ptr> exceptions(n);
+
+  /* Once the maximum number of errors is reached, the remaining analysis is skipped.
+   * The diagnostics are reported pass by pass, element by element, so the analysis of a pass on an element
+   * is only skipped when the errors that will be reported before its own diagnostics already reach the
+   * maximum. Those are counted from the elements analysed so far (whatever the order they are analysed in),
+   * so that skipping the analysis never changes the diagnostics that get reported.
+   */
+  const int max_errors = globalErrorReporter().maxErrors();
+  const int reported   = globalErrorReporter().errorCount();
+  std::mutex budget_mutex;
+  std::vector<bool> analysed(n, false);
+  int analysed_prefix = 0;                        /* the elements before this one have all been analysed */
+  std::vector<int> pass_errors(pass_count, 0);    /* errors of each pass, over the analysed elements */
+  std::vector<int> prefix_errors(pass_count, 0);  /* errors of each pass, over the elements before analysed_prefix */
+
+  auto element_errors = [&](int element, int pass) {return buffers[pass * n + element].error_count();};
+  auto budget_spent = [&](int element, int pass) {
+    if (max_errors <= 0) return false;
+    int errors = reported;
+    std::lock_guard<std::mutex> lock(budget_mutex);
+    for (int p = 0; p < pass; p++) errors += pass_errors[p] + element_errors(element, p);
+    errors += prefix_errors[pass]; /* the element itself is not yet analysed, so it comes after analysed_prefix */
+    return errors >= max_errors;
+  };
+  auto done = [&](int element) {
+    if (max_errors <= 0) return;
+    std::lock_guard<std::mutex> lock(budget_mutex);
+    analysed[element] = true;
+    for (int p = 0; p < pass_count; p++) pass_errors[p] += element_errors(element, p);
+    for (; (analysed_prefix < n) && analysed[analysed_prefix]; analysed_prefix++)
+      for (int p = 0; p < pass_count; p++) prefix_errors[p] += element_errors(analysed_prefix, p);
+  };
+
+  /* Run the first pass_limit passes of the traversal on the element. */
+  auto run_passes = [&](int element, int pass_limit) {
+    for (int pass = 0; pass < pass_limit; pass++) {
+      if (budget_spent(element, pass)) return;
+      try {
+        scoped_diagnostic_buffer_c buffer(&buffers[pass * n + element]);
+        error_counts[pass * n + element] = passes[traversal[pass]].run(elements[element]);
+      } catch (...) {
+        failed_pass[element] = pass;
+        exceptions [element] = std::current_exception();
+        return;
+      }
+    }
+  };
+  auto analyse = [&](int element, int pass_limit) {
+    run_passes(element, pass_limit);
+    done(element);
+  };
+
+  /* The first failure in the order of the sequential analysis (pass by pass, element by element)... */
+  int first_pass = pass_count, first_element = n;
+  auto note_failure = [&](int element) {
+    if (!exceptions[element]) return;
+    if ((failed_pass[element] < first_pass) || ((failed_pass[element] == first_pass) && (element < first_element)))
+      {first_pass = failed_pass[element]; first_element = element;}
+  };
+  /* ...after which the sequential analysis would not have run anything. */
+  auto pass_limit = [&](int element) {
+    if (first_pass == pass_count) return pass_count;
+    return (element < first_element)? first_pass + 1 : first_pass;
+  };
+
+  std::vector<int> pous, configurations;
+  for (int i = 0; i < n; i++) {
+    symbol_c *element = elements[i];
+    if      (is_pou(element))           pous.push_back(i);
+    else if (is_configuration(element)) configurations.push_back(i);
+    else                                {analyse(i, pass_limit(i)); note_failure(i);}
+  }
+  std::vector<int> pou_limits(pous.size());
+  for (size_t i = 0; i < pous.size(); i++) pou_limits[i] = pass_limit(pous[i]);
+  work_pool_c::shared(jobs).run(pous.size(), [&](size_t task) {analyse(pous[task], pou_limits[task]);});
+  for (int i : pous) note_failure(i);
+  for (int i : configurations) {analyse(i, pass_limit(i)); note_failure(i);}
+
+  int error_count = 0;
+  for (int pass = 0; pass < pass_count; pass++)
+    for (int i = 0; i < n; i++) {
+      if ((pass > first_pass) || ((pass == first_pass) && (i > first_element))) break;
+      /* the errors after the maximum number of errors are not reported, nor counted */
+      if (error_budget_exhausted()) break;
+      buffers[pass * n + i].flush();
+      error_count += error_counts[pass * n + i];
+    }
+  if (first_pass < pass_count) std::rethrow_exception(exceptions[first_element]);
+  return error_count;
+}
+
+
+} // namespace matiec::stage3
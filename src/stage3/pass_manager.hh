@@ -0,0 +1,108 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * An IEC 61131-3 compiler.
+ *
+ * Based on the
+ * FINAL DRAFT - IEC 61131-3, 2nd Ed. (2001-12-10)
+ *
+ */
+
+/*
+ * Runs the stage3 passes.
+ *
+ * Each pass declares the passes that must have completed (over the whole
+ * library) before it may run, and whether it only looks into one library
+ * element (POU, datatype declaration, configuration) at a time.
+ *
+ * Consecutive per POU passes that do not depend on each other are fused:
+ * they are run one after the other on each library element, while the
+ * element is still in the cache, instead of each pass walking the whole
+ * library in turn. The POUs are analysed in parallel when more than one job
+ * is requested.
+ *
+ * The diagnostics of the per POU passes are buffered, and reported pass by
+ * pass, element by element, i.e. in exactly the same order as when each pass
+ * walks the whole library.
+ *
+ * The diagnostics of a traversal are only reported once it has completed on
+ * all the elements.
+ *
+ * Once the maximum number of errors (runtime_options.max_errors) has been
+ * reported, no further diagnostics are reported and no further passes run.
+ */
+
+#ifndef _STAGE3_PASS_MANAGER_HH
+#define _STAGE3_PASS_MANAGER_HH
+
+#include <string>
+#include <vector>
+
+#include "../absyntax/absyntax.hh"
+
+namespace matiec::stage3 {
+
+struct pass_t {
+    const char *name;
+    /* Runs the pass over symbol (the whole tree, or one library element for per POU passes).
+     * Returns the number of errors found.
+     */
+    int (*run)(symbol_c *symbol);
+    /* The passes that must have completed before this one runs. */
+    std::vector<std::string> depends_on;
+    /* The pass only looks into one library element at a time, so it may run on each element separately. */
+    bool per_pou = false;
+    /* When the pass runs on each library element separately (always the case for per POU passes, and the
+     * case for the other passes when only some of the elements are analysed), these are called with the
+     * library before, and after, running it on the elements.
+     */
+    void (*enter_library)(symbol_c *library) = nullptr;
+    void (*leave_library)(void) = nullptr;
+};
+
+
+class pass_manager_c {
+  public:
+    /* The passes are run in the order they are added, so the passes a pass depends on must be added first. */
+    void add(pass_t pass);
+
+    /* The passes (their indexes, in the order they were added) that are run by each traversal. */
+    std::vector<std::vector<size_t>> traversals(void) const;
+
+    /* Run all the passes. Returns the total number of errors found. */
+    int run(symbol_c *tree_root, unsigned int jobs) const;
+    /* Run all the passes on the given elements of the library only, in the order given.
+     * The passes that are not per POU are then run on each of the elements separately.
+     */
+    int run(library_c *library, const std::vector<symbol_c *> &elements, unsigned int jobs) const;
+
+  private:
+    /* tree_root is NULL when only the given elements are analysed */
+    int run(symbol_c *tree_root, library_c *library, const std::vector<symbol_c *> &elements, unsigned int jobs) const;
+    int run_per_element(const std::vector<symbol_c *> &elements, const std::vector<size_t> &traversal, unsigned int jobs) const;
+
+    std::vector<pass_t> passes;
+};
+
+} // namespace matiec::stage3
+
+#endif /* _STAGE3_PASS_MANAGER_HH */
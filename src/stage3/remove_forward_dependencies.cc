@@ -42,6 +42,11 @@
  * a new order. 
  * This means that the new and original AST share all the object instances, and only use a distinct
  * library_c object!
+ *
+ * The POUs referenced by each library element are collected in a single walk through the library,
+ * building a dependency graph, which is then topologically sorted (Kahn's algorithm). Any elements
+ * left out of the sort are analysed for strongly connected components (Tarjan's algorithm), so the
+ * POUs belonging to a circular dependency can be reported.
  */
 
 #include "remove_forward_dependencies.hh"
@@ -49,6 +54,10 @@
 #include "../absyntax_utils/absyntax_utils.hh"
 #include "stage3_diagnostics.hh"
 
+#include <algorithm>
+#include <functional>
+#include <queue>
+
 
 
 
@@ -71,7 +80,7 @@
  *          - FB type
  *          - Program type
  *          - Function type
- *      and by checking whether those references are in the declared_identifiers list.
+ *      and by collecting the names of the POUs being referenced.
  *      However, one of those objects, the ref_spec_c, may reference an FB type, or any other datatype, so we must have a way
  *      of knowing what is being referenced in this case. I have opted to introduce a new object type in the AST, the
  *      poutype_identifier_c, that will be used anywhere in the AST that references either a PROGRAM name or a FB type name
@@ -80,15 +89,22 @@
  */
 class find_forward_dependencies_c: public search_visitor_c {
   private:
-    identifiers_symbtable_t *declared_identifiers; // list of identifiers already declared by the symbols in the new tree
+    std::set<std::string, nocasecmp_c> *references; // the names of the POUs referenced by the symbol being searched
   public:
-    find_forward_dependencies_c(identifiers_symbtable_t *declared_identifiers_) {declared_identifiers = declared_identifiers_;}
+    find_forward_dependencies_c(void) {references = NULL;}
+    // add the names of all the POUs referenced by symbol to the references_ set
+    void get_references(symbol_c *symbol, std::set<std::string, nocasecmp_c> *references_) {
+      if (NULL == symbol) return;
+      references = references_;
+      symbol->accept(*this);
+      references = NULL;
+    }
   /*******************************************/
   /* B 1.1 - Letters, digits and identifiers */
   /*******************************************/
-  // return NULL if the symbol is already in the declared_identifiers symbol table, otherwise return the missing symbol!
+  // always return NULL, so the search continues through the whole symbol
   void *visit(            poutype_identifier_c *symbol)
-    {if (declared_identifiers->find(symbol) != declared_identifiers->end()) return NULL; else return symbol;}
+    {references->insert(std::string(symbol->value.view())); return NULL;}
 };   /* class find_forward_dependencies_c */
 
 
@@ -140,7 +156,7 @@ symbol_c remove_forward_dependencies_c_null_symbol;
 
 // constructor & destructor
 remove_forward_dependencies_c:: remove_forward_dependencies_c(void) {
-  find_forward_dependencies      = new find_forward_dependencies_c(&declared_identifiers);
+  find_forward_dependencies      = new find_forward_dependencies_c();
   current_display_error_level = error_level_default;
   error_count = 0;
 }
@@ -168,31 +184,124 @@ library_c *remove_forward_dependencies_c::create_new_tree(symbol_c *tree) {
 
 
 
+/* Add a POU (or configuration) to the dependency graph, with the POUs referenced by search1, search2 and search3 */
 void *remove_forward_dependencies_c::handle_library_symbol(symbol_c *symbol, symbol_c *name, symbol_c *search1, symbol_c *search2, symbol_c *search3) {
-  if (inserted_symbols.find(symbol) != inserted_symbols.end())                 return NULL; // already previously inserted into new_tree and declared_identifiers. Do not handle again!
-  if ((search1 != NULL) && (search1->accept(*find_forward_dependencies) != NULL)) return NULL; // A forward depency has not yet been satisfied. Wait for a later iteration to try again! 
-  if ((search2 != NULL) && (search2->accept(*find_forward_dependencies) != NULL)) return NULL; // A forward depency has not yet been satisfied. Wait for a later iteration to try again!
-  if ((search3 != NULL) && (search3->accept(*find_forward_dependencies) != NULL)) return NULL; // A forward depency has not yet been satisfied. Wait for a later iteration to try again!
-  /* no forward dependencies found => insert into new AST, and add to the 'defined identifiers' and 'inserted symbol' lists */
-  if (declared_identifiers.find(name) == declared_identifiers.end())
-      declared_identifiers.insert(name, NULL);  // only add if not yet in the symbol table (an overloaded version of this same POU could have been inderted previously!)
-  inserted_symbols.insert(symbol);
-  new_tree->add_element(current_code_generation_pragma);  
-  new_tree->add_element(symbol);  
+  element_t element;
+  element.symbol                 = symbol;
+  element.name                   = name;
+  element.code_generation_pragma = current_code_generation_pragma;
+  element.unresolved             = 0;
+  element.pass                   = 1;
+  find_forward_dependencies->get_references(search1, &element.references);
+  find_forward_dependencies->get_references(search2, &element.references);
+  find_forward_dependencies->get_references(search3, &element.references);
+  elements.push_back(element);
   return NULL;
 }
 
 
+/* Insert an element of the dependency graph into the new AST */
+void remove_forward_dependencies_c::insert_element(int index) {
+  element_t &element = elements[index];
+  if (inserted_symbols.find(element.symbol) != inserted_symbols.end()) return; // already previously inserted into new_tree. Do not handle again!
+  inserted_symbols.insert(element.symbol);
+  if (NULL != element.name)
+    new_tree->add_element(element.code_generation_pragma);
+  new_tree->add_element(element.symbol);
+}
+
+
+/* The elements not yet inserted in the new AST that declare a POU referenced by the element */
+std::vector<int> remove_forward_dependencies_c::uninserted_dependencies(int index) {
+  std::vector<int> dependencies;
+  for (names_t::const_iterator reference = elements[index].references.begin(); reference != elements[index].references.end(); ++reference) {
+    std::map<std::string, pou_name_t, nocasecmp_c>::const_iterator pou_name = pou_names.find(*reference);
+    if ((pou_name == pou_names.end()) || pou_name->second.inserted) continue;
+    for (size_t i = 0; i < pou_name->second.declarations.size(); i++)
+      if (inserted_symbols.find(elements[pou_name->second.declarations[i]].symbol) == inserted_symbols.end())
+        dependencies.push_back(pou_name->second.declarations[i]);
+  }
+  return dependencies;
+}
+
+
 /* Tell the user that the source code contains a circular dependency */
-void remove_forward_dependencies_c::print_circ_error(library_c *symbol) {
+void remove_forward_dependencies_c::print_circ_error(void) {
+  /* Find the strongly connected components (Tarjan's algorithm, iterative version) of the graph of the elements
+   * that were not inserted in the new AST. A component with more than one element, or with an element that
+   * references itself, is a circular dependency.
+   */
+  int n = elements.size();
+  std::vector<std::vector<int> > dependencies(n);
+  std::vector<int>  order(n, -1), lowlink(n, 0), component(n, -1), stack;
+  std::vector<bool> on_stack(n, false);
+  std::vector<bool> circular;        // for each component, whether it is a circular dependency...
+  std::vector<bool> blocked;         // ...or depends on one.
+  int next_order = 0;
+
+  for (int i = 0; i < n; i++)
+    if (inserted_symbols.find(elements[i].symbol) == inserted_symbols.end())
+      dependencies[i] = uninserted_dependencies(i);
+
+  for (int root = 0; root < n; root++) {
+    if ((order[root] != -1) || (inserted_symbols.find(elements[root].symbol) != inserted_symbols.end())) continue;
+    std::vector<std::pair<int, size_t> > calls(1, std::make_pair(root, (size_t)0));
+    while (!calls.empty()) {
+      int    v    = calls.back().first;
+      size_t next = calls.back().second;
+      if (0 == next) {
+        order[v] = lowlink[v] = next_order++;
+        stack.push_back(v);
+        on_stack[v] = true;
+      }
+      if (next < dependencies[v].size()) {
+        int w = dependencies[v][next];
+        calls.back().second++;
+        if      (-1 == order[w]) calls.push_back(std::make_pair(w, (size_t)0));
+        else if (on_stack[w])    lowlink[v] = std::min(lowlink[v], order[w]);
+        continue;
+      }
+      calls.pop_back();
+      if (!calls.empty()) lowlink[calls.back().first] = std::min(lowlink[calls.back().first], lowlink[v]);
+      if (lowlink[v] != order[v]) continue;
+      /* v is the root of a component. Components are completed after all the components they depend on. */
+      int c = circular.size();
+      std::vector<int> members;
+      circular.push_back(false);
+      blocked.push_back(false);
+      do {
+        members.push_back(stack.back());
+        stack.pop_back();
+        on_stack[members.back()] = false;
+        component[members.back()] = c;
+      } while (members.back() != v);
+      for (size_t i = 0; i < members.size(); i++) {
+        for (size_t j = 0; j < dependencies[members[i]].size(); j++) {
+          int d = component[dependencies[members[i]][j]];
+          if (d == c) circular[c] = true; // includes an element referencing itself
+          else        blocked [c] = blocked[c] || blocked[d];
+        }
+      }
+      blocked[c] = blocked[c] || circular[c];
+    }
+  }
+
   /* Note that we only print Functions and FBs, as Programs and Configurations cannot contain circular references due to syntax rules */
   /* Note too that circular references in derived datatypes is also not possible due to sytax!                                        */
   int initial_error_count = error_count;
-  for (int i = 0; i < symbol->n; i++) 
-    if (   (inserted_symbols.find(symbol->get_element(i)) == inserted_symbols.end())            // if not copied to new AST
-        &&(  (NULL != dynamic_cast <function_block_declaration_c *>(symbol->get_element(i)))    // and (is a FB  
-           ||(NULL != dynamic_cast <      function_declaration_c *>(symbol->get_element(i)))))  //      or a Function)
-      STAGE3_ERROR(0, symbol->get_element(i), symbol->get_element(i), "POU (%s) contains a self-reference and/or belongs in a circular referencing loop", get_datatype_info_c::get_id_str(symbol->get_element(i)));
+  for (int i = 0; i < n; i++) {
+    symbol_c *symbol = elements[i].symbol;
+    if (-1 == component[i]) continue; // copied to new AST
+    if (   (NULL == dynamic_cast <function_block_declaration_c *>(symbol))    // if not a FB
+        && (NULL == dynamic_cast <      function_declaration_c *>(symbol)))   //   nor a Function
+      continue;
+    if      (circular[component[i]])
+      STAGE3_ERROR(0, symbol, symbol, "POU (%s) contains a self-reference and/or belongs in a circular referencing loop", get_datatype_info_c::get_id_str(symbol));
+    else if (blocked[component[i]])
+      STAGE3_ERROR(0, symbol, symbol, "POU (%s) references a POU that contains a self-reference and/or belongs in a circular referencing loop", get_datatype_info_c::get_id_str(symbol));
+    else
+      STAGE3_ERROR(0, symbol, symbol, "POU (%s) references an undeclared POU", get_datatype_info_c::get_id_str(symbol));
+  }
   if (error_count == initial_error_count) ERROR; // We were unable to determine which POUs contain the circular references!!
 }
 
@@ -215,17 +324,50 @@ void *remove_forward_dependencies_c::visit(library_c *symbol) {
   long long int old_tree_pou_count = pou_count_c::get_count(symbol);
     // if no code generation pragma exists before the first entry in the library, the default is to enable code generation.
   enable_code_generation_pragma_c *default_code_generation_pragma = new enable_code_generation_pragma_c; 
-  int prev_n;
-  cycle_count = 0;
-  do {
-    cycle_count++;
-    prev_n = new_tree->n;
-    current_code_generation_pragma = default_code_generation_pragma;
-    for (int i = 0; i < symbol->n; i++)  symbol->get_element(i)->accept(*this);
-  } while (prev_n != new_tree->n); // repeat while new elementns are still being added to the new AST
+
+  /* build the dependency graph, in a single walk through the library */
+  elements.clear();
+  pou_names.clear();
+  current_code_generation_pragma = default_code_generation_pragma;
+  for (int i = 0; i < symbol->n; i++)  symbol->get_element(i)->accept(*this);
+  for (int i = 0; i < (int)elements.size(); i++) {
+    if (NULL != elements[i].name)
+      pou_names[std::string(dynamic_cast<token_c *>(elements[i].name)->value.view())].declarations.push_back(i);
+    for (names_t::const_iterator reference = elements[i].references.begin(); reference != elements[i].references.end(); ++reference)
+      pou_names[*reference].references.push_back(i);
+    elements[i].unresolved = elements[i].references.size();
+  }
+
+  /* Topological sort (Kahn's algorithm).
+   * Several orders are possible. We keep the one in which the elements are inserted by repeatedly walking through
+   * the library, inserting the elements whose references have all been inserted previously (in this same or in a
+   * previous pass). Elements are therefore inserted in order of (pass, position in the library), and an element
+   * is ready in the same pass as the last of the POUs it references, or in the next pass if that POU is declared
+   * after it in the library.
+   * Since the first declaration of a POU name (e.g. of an overloaded function) that is inserted into the new
+   * AST resolves the references to that name, the inserted elements are considered in that same order.
+   */
+  typedef std::pair<int, int> ready_t; // (pass, index)
+  std::priority_queue<ready_t, std::vector<ready_t>, std::greater<ready_t> > ready;
+  for (int i = 0; i < (int)elements.size(); i++)
+    if (0 == elements[i].unresolved) ready.push(ready_t(elements[i].pass, i));
+  while (!ready.empty()) {
+    ready_t next = ready.top();
+    ready.pop();
+    insert_element(next.second);
+    if (NULL == elements[next.second].name) continue;
+    pou_name_t &pou_name = pou_names[std::string(dynamic_cast<token_c *>(elements[next.second].name)->value.view())];
+    if (pou_name.inserted) continue; // an overloaded version of this same POU was inserted previously!
+    pou_name.inserted = true;
+    for (size_t j = 0; j < pou_name.references.size(); j++) {
+      element_t &element = elements[pou_name.references[j]];
+      element.pass = std::max(element.pass, (next.second < pou_name.references[j])? next.first : next.first + 1);
+      if (0 == --element.unresolved) ready.push(ready_t(element.pass, pou_name.references[j]));
+    }
+  }
   
   if (old_tree_pou_count != pou_count_c::get_count(new_tree)) 
-    print_circ_error(symbol);
+    print_circ_error();
 
   return NULL;
 }
@@ -272,9 +414,7 @@ void *remove_forward_dependencies_c::visit( enable_code_generation_pragma_c *sym
  */
 // TODO: print error message!
 void *remove_forward_dependencies_c::visit(pragma_c *symbol) {
-  if (1 != cycle_count) return NULL; // only handle unknown pragmas in the first cycle!
   STAGE3_WARNING(symbol, symbol, "Unrecognized pragma. Including the pragma when using the '-p' command line option for 'allow use of forward references' may result in unwanted behaviour.");
-  new_tree->add_element(symbol);
-  return NULL;
+  /* an element without dependencies, so it is inserted in the first pass, at the same position as in the original library */
+  return handle_library_symbol(symbol, NULL, NULL);
 }
-
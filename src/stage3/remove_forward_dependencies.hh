@@ -43,16 +43,23 @@
  * a new order. 
  * This means that the new and original AST share all the object instances, and only use a distinct
  * library_c object!
+ *
+ * The POUs referenced by each library element are collected in a single walk through the library,
+ * building a dependency graph, which is then topologically sorted (Kahn's algorithm). Any elements
+ * left out of the sort are analysed for strongly connected components (Tarjan's algorithm), so the
+ * POUs belonging to a circular dependency can be reported.
  */
 
 #include "../absyntax/absyntax.hh"
 #include "../absyntax/visitor.hh"
 #include "../util/symtable.hh"
+#include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 
 class   find_forward_dependencies_c;
-typedef symtable_c<symbol_c *> identifiers_symbtable_t;
 
 
 
@@ -70,13 +77,29 @@ class remove_forward_dependencies_c: public search_visitor_c {
     int             error_count;
     bool            warning_found;
     library_c      *new_tree;
-    int             cycle_count; // main algorithm runs in a loop. The nuber of the current cycle...
-    // NOTE: we need two lists in order to correctly handle overloaded functions
-    identifiers_symbtable_t      declared_identifiers; // list of identifiers already declared by the symbols in the new tree
     std::set <symbol_c *>        inserted_symbols;     // list of symbols already inserted in the new tree 
     symbol_c       *current_code_generation_pragma;    // points to any currently 'active' enable_code_generation_pragma_c
     find_forward_dependencies_c    *find_forward_dependencies;  
 
+    typedef std::set<std::string, nocasecmp_c> names_t;
+    /* A node of the dependency graph: a POU, configuration or (unknown) pragma of the library. */
+    typedef struct {
+      symbol_c     *symbol;
+      symbol_c     *name;                    // the declared name (NULL for pragmas)
+      symbol_c     *code_generation_pragma;  // the code generation pragma in effect where the element is declared
+      names_t       references;              // the names of the POUs referenced by the element
+      unsigned int  unresolved;              // the number of references whose POU has not yet been inserted in the new tree
+      int           pass;                    // see visit(library_c *)
+    } element_t;
+    /* The POUs declared with each name (more than one for overloaded functions), and the elements referencing it. */
+    typedef struct {
+      std::vector<int> declarations;
+      std::vector<int> references;
+      bool             inserted;             // true once the first of its declarations is inserted in the new tree
+    } pou_name_t;
+    std::vector<element_t>                          elements;
+    std::map<std::string, pou_name_t, nocasecmp_c>  pou_names;
+
   public:
      remove_forward_dependencies_c(void);
     ~remove_forward_dependencies_c(void);
@@ -85,7 +108,9 @@ class remove_forward_dependencies_c: public search_visitor_c {
 
   private:
     void *handle_library_symbol(symbol_c *symbol, symbol_c *name, symbol_c *search1, symbol_c *search2 = NULL, symbol_c *search3 = NULL);
-    void  print_circ_error(library_c *symbol);
+    void  insert_element(int index);
+    void  print_circ_error(void);
+    std::vector<int> uninserted_dependencies(int index);
 
     /***************************/
     /* B 0 - Programming Model */
@@ -39,7 +39,6 @@
 #include "narrow_candidate_datatypes.hh"
 #include "forced_narrow_candidate_datatypes.hh"
 #include "print_datatypes_error.hh"
-#include "modern_semantic_annotations.hh"
 #include "lvalue_check.hh"
 #include "array_range_check.hh"
 #include "case_elements_check.hh"
@@ -47,6 +46,8 @@
 #include "declaration_check.hh"
 #include "enum_declaration_check.hh"
 #include "remove_forward_dependencies.hh"
+#include "pass_manager.hh"
+#include "matiec/string_utils.hpp"
 
 
 
@@ -90,29 +91,46 @@ static int constant_propagation(symbol_c *tree_root){
 }
 
 
-/* Type safety analysis assumes that 
- *    - flow control analysis 
- *    - constant folding (constant check)
- * has already been completed, so be sure to call those semantic checkers
- * before calling this function
+static int fill_candidate_datatypes(symbol_c *symbol){
+	fill_candidate_datatypes_c fill_candidate_datatypes(symbol);
+	symbol->accept(fill_candidate_datatypes);
+	return 0;
+}
+
+static int narrow_candidate_datatypes(symbol_c *symbol){
+	narrow_candidate_datatypes_c narrow_candidate_datatypes(symbol);
+	symbol->accept(narrow_candidate_datatypes);
+	return 0;
+}
+
+/* Constant fold each POU once again, now that narrow_candidate_datatypes_c has determined
+ * which function is being called by each function invocation. This folds the calls to pure
+ * standard functions with constant parameters (e.g. SQRT(2.0)), and the expressions that use them.
  */
-static int type_safety(symbol_c *tree_root){
-	fill_candidate_datatypes_c fill_candidate_datatypes(tree_root);
-	tree_root->accept(fill_candidate_datatypes);
-	narrow_candidate_datatypes_c narrow_candidate_datatypes(tree_root);
-	tree_root->accept(narrow_candidate_datatypes);
-	print_datatypes_error_c print_datatypes_error(tree_root);
-	tree_root->accept(print_datatypes_error);
+static int function_folding(symbol_c *symbol){
+	constant_folding_c constant_folding(symbol);
+	symbol->accept(constant_folding);
+	return constant_folding.get_error_count();
+}
+
+
+static int print_datatypes_error(symbol_c *symbol){
+	print_datatypes_error_c print_datatypes_error(symbol);
+	symbol->accept(print_datatypes_error);
+	return print_datatypes_error.get_error_count();
+}
+
+
+static int forced_narrow_candidate_datatypes(symbol_c *tree_root){
 	forced_narrow_candidate_datatypes_c forced_narrow_candidate_datatypes(tree_root);
 	tree_root->accept(forced_narrow_candidate_datatypes);
-	matiec::stage3::modern_semantic_annotations_c modern_semantic_annotations;
-	tree_root->accept(modern_semantic_annotations);
-	return print_datatypes_error.get_error_count();
+	return 0;
 }
 
 
+
 /* Left value checking assumes that data type analysis has already been completed,
- * so be sure to call type_safety() before calling this function
+ * so be sure to call the type safety passes before calling this function
  */
 static int lvalue_check(symbol_c *tree_root){
 	lvalue_check_c lvalue_check(tree_root);
@@ -133,9 +151,9 @@ static int array_range_check(symbol_c *tree_root){
 /* Case options check assumes that constant folding has been completed!
  * so be sure to call constant_folding() before calling this function!
  */
-static int case_elements_check(symbol_c *tree_root){
-	case_elements_check_c case_elements_check(tree_root);
-	tree_root->accept(case_elements_check);
+static int case_elements_check(symbol_c *symbol){
+	case_elements_check_c case_elements_check(symbol);
+	case_elements_check.check(symbol);
 	return case_elements_check.get_error_count();
 }
 
@@ -158,16 +176,71 @@ static int remove_forward_dependencies(symbol_c *tree_root, symbol_c **ordered_t
 }
 
 
+/* The passes, in the order they are run, with the passes they depend on.
+ *
+ * Type safety analysis (fill, narrow, print errors, forced narrow) assumes that
+ *    - flow control analysis
+ *    - constant folding (constant check)
+ * has already been completed.
+ * fill_candidate_datatypes_c needs the enumeration constants of the whole library, even when visiting each element separately.
+ *
+ * The lvalue, array range and CASE element checks only depend on the type safety analysis and constant folding,
+ * so they get fused into a single traversal of each POU.
+ */
+static void add_stage3_passes(matiec::stage3::pass_manager_c &passes) {
+	using matiec::stage3::pass_t;
+	pass_t pass;
+
+	pass = {"enum_declaration_check",            enum_declaration_check,            {}};
+	pass.enter_library = enum_declaration_check_c::enter_library;
+	pass.leave_library = enum_declaration_check_c::leave_library;
+	passes.add(pass);
+	pass = {"flow_control_analysis",             flow_control_analysis,             {}};
+	pass.per_pou = true;
+	passes.add(pass);
+	pass = {"constant_propagation",              constant_propagation,              {"flow_control_analysis"}};
+	passes.add(pass);
+	pass = {"declaration_check",                 declaration_safety,                {"constant_propagation"}};
+	passes.add(pass);
+	pass = {"fill_candidate_datatypes",          fill_candidate_datatypes,          {"flow_control_analysis", "constant_propagation"}};
+	pass.per_pou = true;
+	pass.enter_library = fill_candidate_datatypes_c::enter_library;
+	pass.leave_library = fill_candidate_datatypes_c::leave_library;
+	passes.add(pass);
+	pass = {"narrow_candidate_datatypes",        narrow_candidate_datatypes,        {"fill_candidate_datatypes"}};
+	pass.per_pou = true;
+	passes.add(pass);
+	pass = {"function_folding",                  function_folding,                  {"narrow_candidate_datatypes"}};
+	pass.per_pou = true;
+	passes.add(pass);
+	pass = {"print_datatypes_error",             print_datatypes_error,             {"narrow_candidate_datatypes"}};
+	pass.per_pou = true;
+	passes.add(pass);
+	pass = {"forced_narrow_candidate_datatypes", forced_narrow_candidate_datatypes, {"print_datatypes_error"}};
+	passes.add(pass);
+	pass = {"lvalue_check",                      lvalue_check,                      {"forced_narrow_candidate_datatypes"}};
+	pass.per_pou = true;
+	passes.add(pass);
+	pass = {"array_range_check",                 array_range_check,                 {"constant_propagation", "forced_narrow_candidate_datatypes"}};
+	pass.per_pou = true;
+	passes.add(pass);
+	pass = {"case_elements_check",               case_elements_check,               {"constant_propagation", "forced_narrow_candidate_datatypes"}};
+	pass.per_pou = true;
+	/* Indexes the (by now final) tree of the whole library once, for all its elements.
+	 * Must be done after any pass that may add symbols to the tree.
+	 */
+	pass.enter_library = case_elements_check_c::enter_library;
+	pass.leave_library = case_elements_check_c::leave_library;
+	passes.add(pass);
+}
+
+
 int stage3(symbol_c *tree_root, symbol_c **ordered_tree_root) {
+	matiec::stage3::pass_manager_c passes;
+	add_stage3_passes(passes);
+
 	int error_count = 0;
-	error_count += enum_declaration_check(tree_root);
-	error_count += flow_control_analysis(tree_root);
-	error_count += constant_propagation(tree_root);
-	error_count += declaration_safety(tree_root);
-	error_count += type_safety(tree_root);
-	error_count += lvalue_check(tree_root);
-	error_count += array_range_check(tree_root);
-	error_count += case_elements_check(tree_root);
+	error_count += passes.run(tree_root, runtime_options.jobs);
 	error_count += remove_forward_dependencies(tree_root, ordered_tree_root);
 
 	if (error_count > 0) {
@@ -176,3 +249,43 @@ int stage3(symbol_c *tree_root, symbol_c **ordered_tree_root) {
 	}
 	return 0;
 }
+
+
+/* The name of a POU or configuration, or NULL for any other library element. */
+static symbol_c *library_element_name(symbol_c *element) {
+	if (function_declaration_c       *declaration = dynamic_cast<function_declaration_c       *>(element))  return declaration->derived_function_name;
+	if (function_block_declaration_c *declaration = dynamic_cast<function_block_declaration_c *>(element))  return declaration->fblock_name;
+	if (program_declaration_c        *declaration = dynamic_cast<program_declaration_c        *>(element))  return declaration->program_type_name;
+	if (configuration_declaration_c  *declaration = dynamic_cast<configuration_declaration_c  *>(element))  return declaration->configuration_name;
+	return NULL;
+}
+
+
+int stage3_check(symbol_c *tree_root, const char *pou_name) {
+	library_c *library = dynamic_cast<library_c *>(tree_root);
+	symbol_c  *pou     = NULL;
+	for (int i = 0; (NULL != library) && (NULL != pou_name) && (i < library->n); i++) {
+		token_c *name = dynamic_cast<token_c *>(library_element_name(library->get_element(i)));
+		if ((NULL != name) && matiec::iequals(matiec::sv_or_empty(name->value), pou_name))  pou = library->get_element(i);
+	}
+	if (NULL == pou)  return stage3(tree_root, NULL);
+
+	/* Analyse the datatype declarations, and the requested POU only.
+	 * The declarations of the other POUs are still found in the symbol tables built by
+	 * absyntax_utils_init() over the whole tree, so calls to them are checked as usual.
+	 */
+	std::vector<symbol_c *> elements;
+	for (int i = 0; i < library->n; i++) {
+		symbol_c *element = library->get_element(i);
+		if ((element == pou) || (NULL == library_element_name(element)))  elements.push_back(element);
+	}
+
+	matiec::stage3::pass_manager_c passes;
+	add_stage3_passes(passes);
+	int error_count = passes.run(library, elements, runtime_options.jobs);
+	if (error_count > 0) {
+		fprintf(stderr, "%d error(s) found. Bailing out!\n", error_count);
+		return -1;
+	}
+	return 0;
+}
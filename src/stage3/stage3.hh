@@ -38,4 +38,11 @@
 
 int stage3(symbol_c *tree_root, symbol_c **ordered_tree_root);
 
+/* Semantic analysis only, for tools that just want the diagnostics (no ordered tree is built).
+ * When pou_name names a POU (or configuration) of the library, only that element (and the
+ * datatype declarations it may use) is analysed, so only its diagnostics are reported.
+ * Otherwise (e.g. pou_name is NULL, or the POU is being renamed) the whole library is analysed.
+ */
+int stage3_check(symbol_c *tree_root, const char *pou_name);
+
 #endif /* _STAGE3_HH */
@@ -10,6 +10,7 @@
 #include <cstdio>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absyntax/absyntax.hh"
 #include "matiec/error.hpp"
@@ -37,18 +38,108 @@ inline std::optional<matiec::SourceLocation> make_location(const symbol_c* first
     return loc;
 }
 
+/* Diagnostics emitted while a pass runs on a library element (see pass_manager.hh) are kept
+ * in a buffer instead, and reported by flush() once the pass has completed, so
+ * that they come out in source order whatever the order the POUs were analysed in.
+ */
+class diagnostic_buffer_c {
+  public:
+    void add(matiec::ErrorSeverity severity,
+             matiec::ErrorCategory category,
+             const std::string& message,
+             const std::optional<matiec::SourceLocation>& location,
+             std::string text) {
+        entries_.push_back(entry_t{severity, category, message, location, std::move(text)});
+    }
+
+    bool empty() const { return entries_.empty(); }
+
+    /* The number of errors (not warnings) in the buffer. */
+    int error_count() const {
+        int count = 0;
+        for (const entry_t& entry : entries_)
+            if (entry.severity != matiec::ErrorSeverity::Warning) count++;
+        return count;
+    }
+
+    /* Report the diagnostics, but only up to the maximum number of errors (see error_budget_exhausted()). */
+    void flush() {
+        for (const entry_t& entry : entries_) {
+            if (matiec::globalErrorReporter().reachedMaxErrors()) break;
+            matiec::globalErrorReporter().report(entry.severity, entry.category, entry.message, entry.location);
+            std::fputs(entry.text.c_str(), stderr);
+        }
+        entries_.clear();
+    }
+
+  private:
+    struct entry_t {
+        matiec::ErrorSeverity severity;
+        matiec::ErrorCategory category;
+        std::string message;
+        std::optional<matiec::SourceLocation> location;
+        std::string text;
+    };
+    std::vector<entry_t> entries_;
+};
+
+/* The buffer receiving the diagnostics of the current thread, or nullptr to report them immediately. */
+inline diagnostic_buffer_c*& current_diagnostic_buffer() {
+    static thread_local diagnostic_buffer_c* buffer = nullptr;
+    return buffer;
+}
+
+/* Whether the maximum number of errors (runtime_options.max_errors) has been reached, counting the
+ * errors waiting in the buffer of the current thread. The passes then stop reporting diagnostics.
+ * Each buffer only counts its own errors, so the diagnostics do not depend on the order the POUs are
+ * analysed in when running in parallel. The pass manager also counts the errors buffered by the other
+ * library elements, to stop analysing them altogether (see pass_manager_c::run_per_element()).
+ */
+inline bool error_budget_exhausted() {
+    const matiec::ErrorReporter& reporter = matiec::globalErrorReporter();
+    if (reporter.maxErrors() <= 0) return false;
+    const diagnostic_buffer_c* buffer = current_diagnostic_buffer();
+    return reporter.errorCount() + ((buffer != nullptr) ? buffer->error_count() : 0) >= reporter.maxErrors();
+}
+
+/* Sends the diagnostics of the current thread to buffer, while in scope. */
+class scoped_diagnostic_buffer_c {
+  public:
+    explicit scoped_diagnostic_buffer_c(diagnostic_buffer_c* buffer) : previous_(current_diagnostic_buffer()) {
+        current_diagnostic_buffer() = buffer;
+    }
+    ~scoped_diagnostic_buffer_c() { current_diagnostic_buffer() = previous_; }
+
+    scoped_diagnostic_buffer_c(const scoped_diagnostic_buffer_c&) = delete;
+    scoped_diagnostic_buffer_c& operator=(const scoped_diagnostic_buffer_c&) = delete;
+
+  private:
+    diagnostic_buffer_c* previous_;
+};
+
 inline void emit_diagnostic(matiec::ErrorSeverity severity,
                             matiec::ErrorCategory category,
                             const symbol_c* symbol1,
                             const symbol_c* symbol2,
                             const std::string& message) {
+    if (error_budget_exhausted()) return;
+
     const symbol_c* first = first_symbol(symbol1, symbol2);
     const symbol_c* last = last_symbol(symbol1, symbol2);
     const auto location = make_location(first);
+    const char* label = (severity == matiec::ErrorSeverity::Warning) ? "warning" : "error";
+
+    if (diagnostic_buffer_c* buffer = current_diagnostic_buffer()) {
+        buffer->add(severity, category, message, location,
+                    matiec::format("%s:%d-%d..%d-%d: %s: %s\n",
+                                   first->first_file, first->first_line, first->first_column,
+                                   last->last_line, last->last_column,
+                                   label, message.c_str()));
+        return;
+    }
 
     matiec::globalErrorReporter().report(severity, category, message, location);
 
-    const char* label = (severity == matiec::ErrorSeverity::Warning) ? "warning" : "error";
     std::fprintf(stderr, "%s:%d-%d..%d-%d: %s: %s\n",
                  first->first_file, first->first_line, first->first_column,
                  last->last_line, last->last_column,
@@ -74,16 +165,20 @@ inline void report_warning(matiec::ErrorCategory category,
 #define MATIEC_STAGE3_ERROR(error_level, category, symbol1, symbol2, error_count_ref, display_level, ...) \
     do { \
         if ((display_level) >= (error_level)) { \
-            std::string _matiec_msg = matiec::format(__VA_ARGS__); \
-            ::matiec::stage3::report_error((category), (symbol1), (symbol2), _matiec_msg); \
+            if (!::matiec::stage3::error_budget_exhausted()) { \
+                std::string _matiec_msg = matiec::format(__VA_ARGS__); \
+                ::matiec::stage3::report_error((category), (symbol1), (symbol2), _matiec_msg); \
+            } \
             ++(error_count_ref); \
         } \
     } while (0)
 
 #define MATIEC_STAGE3_WARNING(category, symbol1, symbol2, warning_flag_ref, ...) \
     do { \
-        std::string _matiec_msg = matiec::format(__VA_ARGS__); \
-        ::matiec::stage3::report_warning((category), (symbol1), (symbol2), _matiec_msg); \
+        if (!::matiec::stage3::error_budget_exhausted()) { \
+            std::string _matiec_msg = matiec::format(__VA_ARGS__); \
+            ::matiec::stage3::report_warning((category), (symbol1), (symbol2), _matiec_msg); \
+        } \
         (warning_flag_ref) = true; \
     } while (0)
 
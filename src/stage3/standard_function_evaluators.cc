@@ -0,0 +1,403 @@
+/*
+ *  Compile time evaluation of calls to pure standard functions.
+ *  See standard_function_evaluators.hh for details.
+ */
+
+
+#include "standard_function_evaluators.hh"
+#include "../absyntax_utils/absyntax_utils.hh"
+
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+
+namespace {
+
+typedef enum {bool_kind, signed_kind, unsigned_kind, real_kind, string_kind} value_kind_t;
+
+/* A value passed to, or returned by, a standard function.
+ * The C runtime stores LREAL values in a double, so that is what we use (even if real64_t is a long double).
+ */
+typedef struct {
+  value_kind_t kind;
+  int          bits; /* size of the datatype, in bits */
+  int64_t      s;    /* value of a signed_kind */
+  uint64_t     u;    /* value of an unsigned_kind (ANY_UINT and ANY_nBIT) or bool_kind; length of a string_kind */
+  double       r;    /* value of a real_kind */
+} value_t;
+
+typedef std::vector<value_t> params_t;
+
+/* Compute the value returned by the function. result already has the kind and size of the returned datatype. */
+typedef bool (*evaluator_t)(const params_t &params, value_t &result);
+
+
+/* The elementary datatypes the evaluators know how to handle. */
+static const struct {const char *name; value_kind_t kind; int bits;} datatypes[] = {
+  {"BOOL" ,   bool_kind,  1},
+  {"SINT" , signed_kind,  8}, {"INT"  , signed_kind, 16}, {"DINT" , signed_kind, 32}, {"LINT" , signed_kind, 64},
+  {"USINT", unsigned_kind, 8}, {"UINT" , unsigned_kind, 16}, {"UDINT", unsigned_kind, 32}, {"ULINT", unsigned_kind, 64},
+  {"BYTE" , unsigned_kind, 8}, {"WORD" , unsigned_kind, 16}, {"DWORD", unsigned_kind, 32}, {"LWORD", unsigned_kind, 64},
+  {"REAL" ,   real_kind, 32}, {"LREAL",   real_kind, 64},
+  {"STRING", string_kind, 0},
+};
+
+static bool is_datatype_name(const std::string &name) {
+  for (const auto &datatype : datatypes)
+    if (name == datatype.name)  return true;
+  return false;
+}
+
+static bool get_datatype(symbol_c *type, value_t &value) {
+  if (!get_datatype_info_c::is_ANY_ELEMENTARY(type))  return false;
+  const char *name = get_datatype_info_c::get_id_str(type);
+  if (NULL == name)  return false;
+  for (const auto &datatype : datatypes)
+    if (0 == strcmp(name, datatype.name)) {
+      value = value_t();
+      value.kind = datatype.kind;
+      value.bits = datatype.bits;
+      return true;
+    }
+  return false;
+}
+
+
+/* Conversions between integers of different sizes wrap around, as C casts do. */
+static int64_t wrap_signed(uint64_t value, int bits) {
+  switch (bits) {
+    case  8: return (int8_t )value;
+    case 16: return (int16_t)value;
+    case 32: return (int32_t)value;
+    default: return (int64_t)value;
+  }
+}
+
+static uint64_t wrap_unsigned(uint64_t value, int bits) {
+  return (bits < 64) ? (value & ((UINT64_C(1) << bits) - 1)) : value;
+}
+
+static double round_real(double value, int bits) {
+  return (32 == bits) ? (double)(float)value : value;
+}
+
+
+/* Store an integer value (given as its 64 bit two's complement representation) in result,
+ * converting it to the datatype of result as a C cast would.
+ */
+static bool set_integer(uint64_t value, bool is_signed, value_t &result) {
+  switch (result.kind) {
+    case bool_kind    : result.u = (0 != value);                           return true;
+    case signed_kind  : result.s = wrap_signed  (value, result.bits);       return true;
+    case unsigned_kind: result.u = wrap_unsigned(value, result.bits);       return true;
+    case real_kind    : result.r = round_real(is_signed ? (double)(int64_t)value : (double)value, result.bits); return true;
+    default           : return false;
+  }
+}
+
+static bool set_real(double value, value_t &result) {
+  if (real_kind != result.kind)  return false;
+  result.r = round_real(value, result.bits);
+  return true;
+}
+
+/* A copy of one of the parameters, as the value returned by the function (of the same datatype). */
+static bool set_value(const value_t &value, value_t &result) {
+  if (value.kind != result.kind)  return false;
+  result = value;
+  return true;
+}
+
+
+static double as_real(const value_t &value) {
+  switch (value.kind) {
+    case signed_kind: return (double)value.s;
+    case real_kind  : return value.r;
+    default         : return (double)value.u;
+  }
+}
+
+/* the value of an integer parameter, when it is not negative */
+static bool as_count(const value_t &value, uint64_t &count) {
+  switch (value.kind) {
+    case signed_kind  : if (value.s < 0) return false; count = value.s; return true;
+    case unsigned_kind: count = value.u; return true;
+    default           : return false;
+  }
+}
+
+static bool less(const value_t &value1, const value_t &value2) {
+  switch (value1.kind) {
+    case signed_kind: return value1.s < value2.s;
+    case real_kind  : return value1.r < value2.r;
+    default         : return value1.u < value2.u;
+  }
+}
+
+
+/* __real_round(), __preal_to_sint() and __preal_to_uint() in iec_std_lib.h.
+ * Returns false when the C code would cast an out of range value to a LINT.
+ */
+static bool real_to_integer(double value, bool is_signed, int64_t &result) {
+  const double limit = 9223372036854775808.0; /* 2^63 */
+  if      (value >= 0)  value += 0.5;
+  else if (is_signed)   value -= 0.5;
+  else                  {result = 0; return true;}
+  if (!(value > -limit) || !(value < limit))  return false;
+  result = (std::fmod(value, 1) == 0) ? ((int64_t)value / 2) * 2 : (int64_t)value;
+  return true;
+}
+
+
+/**************************************************************/
+/* The evaluators, one per (overloaded) standard function.    */
+/**************************************************************/
+
+static bool evaluate_ABS(const params_t &params, value_t &result) {
+  const value_t &in = params[0];
+  if (real_kind == in.kind)  return set_real(std::fabs(in.r), result);
+  if ((signed_kind == in.kind) && (in.s < 0)) {
+    if (INT64_MIN == in.s)  return false;
+    return set_integer((uint64_t)(-in.s), true, result);
+  }
+  return set_value(in, result);
+}
+
+#define REAL_FUNCTION(fname, cfunction)                                      \
+static bool evaluate_##fname(const params_t &params, value_t &result) {      \
+  if (real_kind != params[0].kind)  return false;                            \
+  return set_real(cfunction(params[0].r), result);                           \
+}
+
+REAL_FUNCTION(SQRT, std::sqrt)
+REAL_FUNCTION(LN  , std::log)
+REAL_FUNCTION(LOG , std::log10)
+REAL_FUNCTION(EXP , std::exp)
+REAL_FUNCTION(SIN , std::sin)
+REAL_FUNCTION(COS , std::cos)
+REAL_FUNCTION(TAN , std::tan)
+REAL_FUNCTION(ASIN, std::asin)
+REAL_FUNCTION(ACOS, std::acos)
+REAL_FUNCTION(ATAN, std::atan)
+
+static bool evaluate_EXPT(const params_t &params, value_t &result) {
+  return set_real(std::pow(as_real(params[0]), as_real(params[1])), result);
+}
+
+static bool evaluate_MOVE(const params_t &params, value_t &result) {
+  return set_value(params[0], result);
+}
+
+static bool evaluate_MAX(const params_t &params, value_t &result) {
+  value_t op1 = params[0];
+  for (size_t i = 1; i < params.size(); i++)
+    if (less(op1, params[i]))  op1 = params[i];
+  return set_value(op1, result);
+}
+
+static bool evaluate_MIN(const params_t &params, value_t &result) {
+  value_t op1 = params[0];
+  for (size_t i = 1; i < params.size(); i++)
+    if (less(params[i], op1))  op1 = params[i];
+  return set_value(op1, result);
+}
+
+/* LIMIT(MN, IN, MX) */
+static bool evaluate_LIMIT(const params_t &params, value_t &result) {
+  const value_t &mn = params[0], &in = params[1], &mx = params[2];
+  return set_value(less(mn, in) ? (less(in, mx) ? in : mx) : mn, result);
+}
+
+/* SEL(G, IN0, IN1) */
+static bool evaluate_SEL(const params_t &params, value_t &result) {
+  return set_value((0 != params[0].u) ? params[2] : params[1], result);
+}
+
+/* MUX(K, IN0, IN1, ...). An out of range K sets ENO to FALSE, so that is left for run time. */
+static bool evaluate_MUX(const params_t &params, value_t &result) {
+  uint64_t k;
+  if (!as_count(params[0], k) || (k >= params.size() - 1))  return false;
+  return set_value(params[k + 1], result);
+}
+
+/* SHL(IN, N), SHR(IN, N), ROL(IN, N), ROR(IN, N)
+ * Shifting a BOOL by N > 0 always gives FALSE, and rotating it does not change it.
+ * Shifting by N >= (size of IN) is undefined behaviour in C, so that is left for run time.
+ */
+static bool shift(const params_t &params, value_t &result, bool left, bool rotate) {
+  const value_t &in = params[0];
+  uint64_t n;
+  if (!as_count(params[1], n))  return false;
+  if (bool_kind == in.kind)  return set_integer((rotate || (0 == n)) ? in.u : 0, false, result);
+  if (unsigned_kind != in.kind)  return false;
+  if (rotate)  n %= in.bits;
+  if (n >= (uint64_t)in.bits)  return false;
+  if (0 == n)  return set_value(in, result);
+  uint64_t value = left ? (in.u << n) : (in.u >> n);
+  if (rotate)  value |= left ? (in.u >> (in.bits - n)) : (in.u << (in.bits - n));
+  return set_integer(value, false, result);
+}
+
+static bool evaluate_SHL(const params_t &params, value_t &result) {return shift(params, result, true , false);}
+static bool evaluate_SHR(const params_t &params, value_t &result) {return shift(params, result, false, false);}
+static bool evaluate_ROL(const params_t &params, value_t &result) {return shift(params, result, true , true );}
+static bool evaluate_ROR(const params_t &params, value_t &result) {return shift(params, result, false, true );}
+
+/* TRUNC(IN) -> ANY_INT. Casting an out of range REAL to an integer is undefined behaviour in C. */
+static bool evaluate_TRUNC(const params_t &params, value_t &result) {
+  if (real_kind != params[0].kind)  return false;
+  double value = std::trunc(params[0].r);
+  double min = 0, max = std::ldexp(1.0, result.bits);
+  if (signed_kind == result.kind)  {max /= 2; min = -max;}
+  else if (unsigned_kind != result.kind)  return false;
+  if (!(value >= min) || !(value < max))  return false;
+  return set_integer((signed_kind == result.kind) ? (uint64_t)(int64_t)value : (uint64_t)value, true, result);
+}
+
+static bool evaluate_LEN(const params_t &params, value_t &result) {
+  if (string_kind != params[0].kind)  return false;
+  return set_integer(params[0].u, false, result);
+}
+
+/* [ANY_BIT | ANY_NUM]_TO_[ANY_BIT | ANY_NUM], as in the *_TO_* functions of iec_std_functions.h */
+static bool evaluate_TO(const params_t &params, value_t &result) {
+  const value_t &in = params[0];
+  if (bool_kind == result.kind) {
+    result.u = (real_kind == in.kind) ? (0 != in.r) : (signed_kind == in.kind) ? (0 != in.s) : (0 != in.u);
+    return true;
+  }
+  switch (in.kind) {
+    case bool_kind    :
+    case unsigned_kind: return set_integer(in.u, false, result);
+    case signed_kind  : return set_integer((uint64_t)in.s, true, result);
+    case real_kind    : {
+      if (real_kind == result.kind)  return set_real(in.r, result);
+      int64_t value;
+      if (!real_to_integer(in.r, signed_kind == result.kind, value))  return false;
+      return set_integer((uint64_t)value, true, result);
+    }
+    default           : return false;
+  }
+}
+
+
+typedef struct {
+  evaluator_t evaluate;
+  size_t      min_params; /* number of input parameters (extensible functions take min_params or more) */
+  bool        extensible;
+} function_t;
+
+typedef std::unordered_map<std::string, function_t> evaluators_t;
+
+static const evaluators_t &evaluators(void) {
+  #define FUNCTION(fname, params)   {#fname, {evaluate_##fname, params, false}}
+  #define EXTENSIBLE(fname, params) {#fname, {evaluate_##fname, params, true }}
+  static const evaluators_t table = {
+    FUNCTION(ABS , 1), FUNCTION(SQRT, 1), FUNCTION(LN  , 1), FUNCTION(LOG , 1), FUNCTION(EXP , 1),
+    FUNCTION(SIN , 1), FUNCTION(COS , 1), FUNCTION(TAN , 1), FUNCTION(ASIN, 1), FUNCTION(ACOS, 1),
+    FUNCTION(ATAN, 1), FUNCTION(EXPT, 2), FUNCTION(MOVE, 1), EXTENSIBLE(MAX, 1), EXTENSIBLE(MIN, 1),
+    FUNCTION(LIMIT, 3), FUNCTION(SEL, 3), EXTENSIBLE(MUX, 2), FUNCTION(SHL , 2), FUNCTION(SHR , 2),
+    FUNCTION(ROL , 2), FUNCTION(ROR , 2), FUNCTION(TRUNC, 1), FUNCTION(LEN , 1),
+    {"_TO_", {evaluate_TO, 1, false}},
+  };
+  #undef FUNCTION
+  #undef EXTENSIBLE
+  return table;
+}
+
+
+/* The evaluator of a function, given its (upper case) name.
+ * All the <type>_TO_<type> conversions share the "_TO_" entry of the table.
+ * The explicitly typed functions (e.g. SQRT_REAL, MAX_INT) share the evaluator of the overloaded function.
+ * Only the <type>_TO_<type> conversions between the above datatypes are evaluated (i.e. not the BCD conversions).
+ */
+static const function_t *get_function(const std::string &name) {
+  const evaluators_t &table = evaluators();
+  evaluators_t::const_iterator function = table.end();
+
+  size_t to = name.find("_TO_");
+  if (std::string::npos != to) {
+    if (is_datatype_name(name.substr(0, to)) && is_datatype_name(name.substr(to + 4)))
+      function = table.find("_TO_");
+  } else {
+    function = table.find(name);
+    size_t suffix = name.rfind('_');
+    if ((table.end() == function) && (std::string::npos != suffix) && is_datatype_name(name.substr(suffix + 1)))
+      function = table.find(name.substr(0, suffix));
+  }
+  return (table.end() != function) ? &function->second : NULL;
+}
+
+
+/* Number of characters in a STRING literal (see generate_c_base_c::visit(single_byte_character_string_c *)) */
+static bool string_length(symbol_c *symbol, uint64_t &length) {
+  single_byte_character_string_c *literal = dynamic_cast<single_byte_character_string_c *>(symbol);
+  if (NULL == literal)  return false;
+  std::string_view value = matiec::sv_or_empty(literal->value);
+  if (value.size() < 2)  return false;
+  length = 0;
+  /* we ignore the first and last bytes, they will be the character ' */
+  for (size_t i = 1; i < value.size() - 1; i++, length++) {
+    if ('$' != value[i])  continue;
+    i++;
+    if ((i + 1 < value.size() - 1) && isxdigit((unsigned char)value[i]) && isxdigit((unsigned char)value[i + 1]))  i++;
+  }
+  /* longer strings get truncated at run time (STR_MAX_LEN in lib/C/iec_types.h) */
+  return (length <= 126);
+}
+
+
+/* The value passed to a parameter, converted to the datatype of the parameter (as a C cast would) */
+static bool get_param_value(symbol_c *symbol, symbol_c *type, value_t &value) {
+  if ((NULL == symbol) || !get_datatype(type, value))  return false;
+  const_value_c &cvalue = symbol->const_value;
+  switch (value.kind) {
+    case bool_kind    : if (!cvalue.m_bool  .is_valid()) return false; value.u = cvalue.m_bool.get();                              return true;
+    case signed_kind  : if (!cvalue.m_int64 .is_valid()) return false; value.s = wrap_signed  (cvalue.m_int64 .get(), value.bits); return true;
+    case unsigned_kind: if (!cvalue.m_uint64.is_valid()) return false; value.u = wrap_unsigned(cvalue.m_uint64.get(), value.bits); return true;
+    case real_kind    : if (!cvalue.m_real64.is_valid()) return false; value.r = round_real((double)cvalue.m_real64.get(), value.bits); return true;
+    case string_kind  : return string_length(symbol, value.u);
+  }
+  return false;
+}
+
+} // namespace
+
+
+
+bool evaluate_standard_function(function_declaration_c *function_declaration,
+                                const std::vector<symbol_c *> &param_values,
+                                const std::vector<symbol_c *> &param_types,
+                                const_value_c &result) {
+  if ((NULL == function_declaration) || param_values.empty() || (param_values.size() != param_types.size()))  return false;
+
+  token_c *function_name = dynamic_cast<token_c *>(function_declaration->derived_function_name);
+  if (NULL == function_name)  return false;
+  std::string name;
+  for (char c : matiec::sv_or_empty(function_name->value))
+    name.push_back(std::toupper(static_cast<unsigned char>(c)));
+  const function_t *function = get_function(name);
+  if (NULL == function)  return false;
+  if ((param_values.size() < function->min_params) || (!function->extensible && (param_values.size() > function->min_params)))  return false;
+
+  value_t value;
+  if (!get_datatype(function_declaration->type_name, value) || (string_kind == value.kind))  return false;
+  params_t params(param_values.size());
+  for (size_t i = 0; i < param_values.size(); i++)
+    if (!get_param_value(param_values[i], param_types[i], params[i]))  return false;
+  if (!function->evaluate(params, value))  return false;
+
+  const_value_c cvalue;
+  switch (value.kind) {
+    case bool_kind    : cvalue.m_bool  .set(0 != value.u); break;
+    case signed_kind  : cvalue.m_int64 .set(value.s);      break;
+    case unsigned_kind: cvalue.m_uint64.set(value.u);      break;
+    case real_kind    : if (!std::isfinite(value.r)) return false; cvalue.m_real64.set(value.r); break;
+    default           : return false;
+  }
+  result = cvalue;
+  return true;
+}
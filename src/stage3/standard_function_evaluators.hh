@@ -0,0 +1,71 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * An IEC 61131-3 compiler.
+ *
+ * Based on the
+ * FINAL DRAFT - IEC 61131-3, 2nd Ed. (2001-12-10)
+ *
+ */
+
+
+/*
+ *  Compile time evaluation of calls to pure standard functions.
+ *
+ *  Calls such as SQRT(2.0), INT_TO_REAL(100), SHL(16#1, 4), MAX(3, 7, 5), EXPT(10.0, 3)
+ *  or LEN('abc') always return the same value, so constant_folding_c may store that value
+ *  in the const_value of the function invocation, and stage 4 may print it out as a literal
+ *  instead of calling the function in every scan cycle.
+ *
+ *  The functions that may be evaluated are kept in a table, indexed by function name. The
+ *  evaluator of each function computes the value returned by the overload that was chosen
+ *  by narrow_candidate_datatypes_c (i.e. using the datatypes of its parameters and of its
+ *  return value), exactly as the functions in lib/C/iec_std_functions.h would compute it.
+ *  Whenever the result would depend on undefined (or platform dependent) behaviour of those
+ *  C functions (e.g. shifting a value by more bits than it has), the call is not evaluated.
+ */
+
+
+#ifndef _STANDARD_FUNCTION_EVALUATORS_HH
+#define _STANDARD_FUNCTION_EVALUATORS_HH
+
+#include <vector>
+
+#include "../absyntax/absyntax.hh"
+
+
+/* Determine the value returned by a call to the standard function declared by function_declaration.
+ * The function is only identified by its name, so the caller must make sure function_declaration
+ * was declared in the standard library (see stage1_2_is_standard_library_element()).
+ * param_values and param_types hold the value passed to each input parameter of the function,
+ * and the declared datatype of that parameter, in the order in which the parameters are declared
+ * (extensible parameters included).
+ * Returns false (leaving result unchanged) if the function may not be evaluated at compile time,
+ * or if any of the values being passed is not constant.
+ */
+bool evaluate_standard_function(function_declaration_c *function_declaration,
+                                const std::vector<symbol_c *> &param_values,
+                                const std::vector<symbol_c *> &param_types,
+                                const_value_c &result);
+
+
+#endif /* _STANDARD_FUNCTION_EVALUATORS_HH */
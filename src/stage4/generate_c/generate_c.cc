@@ -30,6 +30,9 @@
 #include <map>
 #include <memory>
 #include <sstream>
+#include <exception>
+#include <functional>
+#include <vector>
 #ifdef _WIN32
 #include <string.h>
 #else
@@ -39,6 +42,7 @@
 
 #include "../../util/symtable.hh"
 #include "../../util/dsymtable.hh"
+#include "../../util/work_pool.hh"
 #include "../../absyntax/visitor.hh"
 #include "../../absyntax_utils/absyntax_utils.hh"
 #include "../../main.hh" // required for ERROR() and ERROR_MSG() macros.
@@ -429,7 +433,7 @@ class print_function_parameter_data_types_c: public generate_c_base_and_typeid_c
 /* 'complex' means that it is either a strcuture or an array!               */
 class analyse_variable_c: public search_visitor_c {
   private:
-    static analyse_variable_c *singleton_;
+    static thread_local analyse_variable_c *singleton_; // one per thread, as the POUs may be generated in parallel
 
   public:
     analyse_variable_c(void) {};
@@ -543,7 +547,7 @@ class analyse_variable_c: public search_visitor_c {
     
 };
 
-analyse_variable_c *analyse_variable_c::singleton_ = NULL;
+thread_local analyse_variable_c *analyse_variable_c::singleton_ = NULL;
 
 /***********************************************************************/
 /***********************************************************************/
@@ -2416,6 +2420,14 @@ class generate_c_c: public iterator_visitor_c {
     
     unsigned long long common_ticktime;
 
+    /* A POU whose pair of files (-O p) is still to be generated. */
+    struct pending_pou_t {
+      symbol_c   *symbol;
+      const char *name;
+      std::function<void(stage4out_c &, bool)> generate; /* generate_c_pous_c::handle_XXX(symbol, ...) */
+    };
+    std::vector<pending_pou_t> pending_pous;
+
   public:
     generate_c_c(stage4out_c *s4o_ptr, const char *builddir): 
             s4o(*s4o_ptr),
@@ -2476,8 +2488,12 @@ class generate_c_c: public iterator_visitor_c {
       pous_incl_s4o.print("#include \"accessor.h\"\n#include \"iec_std_lib.h\"\n\n");
 
       for(int i = 0; i < symbol->n; i++) {
+        /* the code of the configurations may depend on the annotations left by the generation of the POUs */
+        if (NULL != dynamic_cast<configuration_declaration_c *>(symbol->get_element(i)))
+          generate_pending_pous();
         symbol->get_element(i)->accept(*this);
       }
+      generate_pending_pous();
 
       pous_incl_s4o.print("#endif //__POUS_H\n");
       
@@ -2526,20 +2542,16 @@ class generate_c_c: public iterator_visitor_c {
 /* WARNING: The following code is buggy when generating an independent pair of files for each POU, as the
  *          specially created stage4out_c (s4o_c and s4o_h) will not comply with the enable/disable_code_generation_pragma_c
  */
+/* When generating an independent pair of files for each POU, the files are only generated later on
+ * (see generate_pending_pous()), but their #include directives are added to POUS.h and POUS.c right away.
+ */
 #define handle_pou(fname,pname) \
       if (!allow_output) return NULL;\
       if (generate_pou_filepairs__) {\
         const char *pou_name = get_datatype_info_c::get_id_str(pname);\
-        stage4out_c s4o_c(current_builddir, pou_name, "c");\
-        stage4out_c s4o_h(current_builddir, pou_name, "h");\
-        s4o_c.print("#include \""); s4o_c.print(pou_name); s4o_c.print(".h\"\n");\
-        s4o_h.print("#ifndef __");  s4o_h.print(pou_name); s4o_h.print("_H\n");\
-        s4o_h.print("#define __");  s4o_h.print(pou_name); s4o_h.print("_H\n");\
-        generate_c_implicit_typedecl_c generate_c_implicit_typedecl__(&s4o_h);\
-        symbol->accept(generate_c_implicit_typedecl__); /* generate implicitly delcared datatypes (arrays and ref_to) */\
-        generate_c_pous_c::fname(symbol, s4o_h, true); /* generate the <pou_name>.h file */\
-        generate_c_pous_c::fname(symbol, s4o_c, false);/* generate the <pou_name>.c file */\
-        s4o_h.print("#endif /* __");  s4o_h.print(pou_name); s4o_h.print("_H */\n");\
+        pending_pous.push_back({symbol, pou_name, [symbol](stage4out_c &s4o, bool print_declaration) {generate_c_pous_c::fname(symbol, s4o, print_declaration);}});\
+        stage4out_c::announce(current_builddir, pou_name, "c");\
+        stage4out_c::announce(current_builddir, pou_name, "h");\
         /* add #include directives to the POUS.h and POUS.c files... */\
         pous_incl_s4o.print("#include \"");\
         pous_s4o.     print("#include \"");\
@@ -2553,6 +2565,74 @@ class generate_c_c: public iterator_visitor_c {
         generate_c_pous_c::fname(symbol, pous_s4o,      false);\
       }
 
+    /* Start the <pou_name>.c and <pou_name>.h files of a POU, up to the implicitly declared datatypes. */
+    void begin_pou_filepair(const pending_pou_t &pou, std::unique_ptr<stage4out_c> &s4o_c, std::unique_ptr<stage4out_c> &s4o_h) {
+      s4o_c.reset(new stage4out_c(current_builddir, pou.name, "c", "  ", false /* already announced */));
+      s4o_h.reset(new stage4out_c(current_builddir, pou.name, "h", "  ", false /* already announced */));
+      s4o_c->print("#include \""); s4o_c->print(pou.name); s4o_c->print(".h\"\n");
+      s4o_h->print("#ifndef __");  s4o_h->print(pou.name); s4o_h->print("_H\n");
+      s4o_h->print("#define __");  s4o_h->print(pou.name); s4o_h->print("_H\n");
+      generate_c_implicit_typedecl_c generate_c_implicit_typedecl__(s4o_h.get());
+      pou.symbol->accept(generate_c_implicit_typedecl__); /* generate implicitly delcared datatypes (arrays and ref_to) */
+    }
+
+    /* Generate the code of a POU into the files started by begin_pou_filepair(), and write them. */
+    void end_pou_filepair(const pending_pou_t &pou, std::unique_ptr<stage4out_c> &s4o_c, std::unique_ptr<stage4out_c> &s4o_h) {
+      pou.generate(*s4o_h, true); /* generate the <pou_name>.h file */
+      pou.generate(*s4o_c, false);/* generate the <pou_name>.c file */
+      s4o_h->print("#endif /* __");  s4o_h->print(pou.name); s4o_h->print("_H */\n");
+      s4o_c.reset();
+      s4o_h.reset();
+    }
+
+    /* Generate the pairs of files of the pending POUs, in parallel when more than one job was requested (-j).
+     * The implicitly declared datatypes are generated first, one POU after the other, as doing so annotates
+     * the AST (the generate_c_annotaton__implicit_type_id annotations) and the annotated nodes may be shared
+     * between POUs (e.g. the datatype of an expression). The code of the POUs, which only reads those
+     * annotations, is then generated in parallel, each POU writing to its own pair of files.
+     * The errors of each POU are buffered, so that only the errors of the first POU (in source order)
+     * that fails get reported, just like when generating the POUs one after the other.
+     */
+    void generate_pending_pous(void) {
+      const size_t count = pending_pous.size();
+      std::vector<stage4_error_buffer_c> errors(count);
+      std::vector<std::unique_ptr<stage4out_c>> s4o_c(count), s4o_h(count);
+
+      size_t started = 0;
+      std::exception_ptr begin_failure;
+      for (; started < count; started++) {
+        scoped_stage4_error_buffer_c buffer(&errors[started]);
+        try {
+          begin_pou_filepair(pending_pous[started], s4o_c[started], s4o_h[started]);
+        } catch (...) {
+          /* the POUs before this one must still be generated, as their errors come first */
+          begin_failure = std::current_exception();
+          break;
+        }
+      }
+
+      matiec::work_pool_c &pool = matiec::work_pool_c::shared(runtime_options.jobs);
+      try {
+        pool.run(started, [&](size_t i) {
+          scoped_stage4_error_buffer_c buffer(&errors[i]);
+          end_pou_filepair(pending_pous[i], s4o_c[i], s4o_h[i]);
+        });
+      } catch (...) {
+        errors[pool.failed_task()].flush();
+        pending_pous.clear();
+        throw;
+      }
+      if (begin_failure) {
+        errors[started].flush();
+        pending_pous.clear();
+        std::rethrow_exception(begin_failure);
+      }
+      /* no POU failed, but writing their files may still have failed */
+      for (stage4_error_buffer_c &error : errors)
+        error.flush();
+      pending_pous.clear();
+    }
+
 /***********************/
 /* B 1.5.1 - Functions */
 /***********************/      
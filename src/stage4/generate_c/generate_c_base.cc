@@ -23,6 +23,7 @@
  */
 
 #include <string.h>
+#include <cmath>
 
 #include "matiec/string_utils.hpp"
 
@@ -144,6 +145,38 @@ class generate_c_base_c: public iterator_visitor_c {
       return NULL;
     }
 
+    /* Print the constant value stage 3 determined for an expression (e.g. for a call to a pure standard
+     * function with constant parameters, such as SQRT(2.0)) as a literal of the expression's datatype.
+     * When assign_to is given, the literal is printed as the value assigned to that variable.
+     * Returns false, without printing anything, when the expression does not have such a value.
+     */
+    bool print_const_value(symbol_c *symbol, symbol_c *assign_to = NULL) {
+      symbol_c *type = symbol->datatype;
+      const_value_c &cvalue = symbol->const_value;
+      std::string value;
+      if      (get_datatype_info_c::is_BOOL(type) && cvalue.m_bool.is_valid())
+        value = cvalue.m_bool.get() ? "TRUE" : "FALSE";
+      else if (get_datatype_info_c::is_ANY_signed_INT(type) && cvalue.m_int64.is_valid() && (cvalue.m_int64.get() != INT64_MIN))
+        value = matiec::format("%lld", (long long)cvalue.m_int64.get());
+      else if ((get_datatype_info_c::is_ANY_unsigned_INT(type) || get_datatype_info_c::is_ANY_nBIT(type)) && cvalue.m_uint64.is_valid())
+        value = matiec::format("0x%llX", (unsigned long long)cvalue.m_uint64.get());
+      else if (get_datatype_info_c::is_ANY_REAL(type) && cvalue.m_real64.is_valid() && std::isfinite((double)cvalue.m_real64.get()))
+        /* enough digits to get back the same REAL (float) or LREAL (double) */
+        value = matiec::format("%.*g", (NULL != dynamic_cast<real_type_name_c *>(type)) ? 9 : 17, (double)cvalue.m_real64.get());
+      else
+        return false;
+      if (NULL != assign_to) {
+        assign_to->accept(*this);
+        s4o.print(" = ");
+      }
+      s4o.print("__");
+      type->accept(*this);
+      s4o.print("_LITERAL(");
+      s4o.print(value);
+      s4o.print(")");
+      return true;
+    }
+
     void *print_striped_token(token_c *token, int offset = 0) {
       std::string str = "";
       bool leading_zero = true;
@@ -927,7 +960,7 @@ void *visit(enumerated_value_c *symbol) {}
 void *visit(array_type_declaration_c *symbol) {
   const auto implicit_id_count = symbol->anotations_map.count("generate_c_annotaton__implicit_type_id");
   if (1 != implicit_id_count) ERROR;
-  return symbol->anotations_map["generate_c_annotaton__implicit_type_id"]->accept(*this);
+  return symbol->anotations_map.at("generate_c_annotaton__implicit_type_id")->accept(*this);
 }
 
 
@@ -936,7 +969,7 @@ void *visit(array_type_declaration_c *symbol) {
 /* array_initialization may be NULL ! */
 void *visit(array_spec_init_c *symbol) {
   const auto implicit_id_count = symbol->anotations_map.count("generate_c_annotaton__implicit_type_id");
-  if (1 == implicit_id_count) return symbol->anotations_map["generate_c_annotaton__implicit_type_id"]->accept(*this);
+  if (1 == implicit_id_count) return symbol->anotations_map.at("generate_c_annotaton__implicit_type_id")->accept(*this);
   if (0 == implicit_id_count) return symbol->datatype->accept(*this);
   return NULL;
 }
@@ -945,7 +978,7 @@ void *visit(array_spec_init_c *symbol) {
 void *visit(array_specification_c *symbol) {
   const auto implicit_id_count = symbol->anotations_map.count("generate_c_annotaton__implicit_type_id");
   if (1 != implicit_id_count) ERROR;
-  return symbol->anotations_map["generate_c_annotaton__implicit_type_id"]->accept(*this);
+  return symbol->anotations_map.at("generate_c_annotaton__implicit_type_id")->accept(*this);
 }
 
 
@@ -978,7 +1011,7 @@ void *visit(ref_spec_c *symbol) {
       /* this is part of an implicitly declared datatype (i.e. inside a variable decaration), for which an equivalent C datatype
        * has already been defined. So, we simly print out the id of that C datatpe...
        */
-    return symbol->anotations_map["generate_c_annotaton__implicit_type_id"]->accept(*this);
+    return symbol->anotations_map.at("generate_c_annotaton__implicit_type_id")->accept(*this);
   }
   /* This is NOT part of an implicitly declared datatype (i.e. we are being called from an visit(ref_type_decl_c *),
    * through the visit(ref_spec_init_c*)), so we need to simply print out the name of the datatype we reference to.
@@ -1005,7 +1038,7 @@ void *visit(ref_spec_init_c *symbol) {
   const auto implicit_id_count = symbol->anotations_map.count("generate_c_annotaton__implicit_type_id");
   if (1  < implicit_id_count) ERROR;
   if (1 == implicit_id_count)
-    return symbol->anotations_map["generate_c_annotaton__implicit_type_id"]->accept(*this);
+    return symbol->anotations_map.at("generate_c_annotaton__implicit_type_id")->accept(*this);
   return symbol->ref_spec->accept(*this); // this is probably pointing to an ***_identifier_c !!
 }
 
@@ -754,6 +754,10 @@ void *visit(il_simple_operation_c *symbol) {
 /* | function_name [il_operand_list] */
 // SYM_REF2(il_function_call_c, function_name, il_operand_list)
 void *visit(il_function_call_c *symbol) {
+  /* calls to pure standard functions with constant parameters were already evaluated in stage 3 */
+  if (print_const_value(symbol, &this->implicit_variable_result))
+    return NULL;
+
   symbol_c* function_type_prefix = NULL;
   symbol_c* function_name = NULL;
   symbol_c* function_type_suffix = NULL;
@@ -1158,6 +1162,10 @@ void *visit(il_fb_call_c *symbol) {
 /* | function_name '(' eol_list [il_param_list] ')' */
 // SYM_REF2(il_formal_funct_call_c, function_name, il_param_list)
 void *visit(il_formal_funct_call_c *symbol) {
+  /* calls to pure standard functions with constant parameters were already evaluated in stage 3 */
+  if (print_const_value(symbol, &this->implicit_variable_result))
+    return NULL;
+
   symbol_c* function_type_prefix = NULL;
   symbol_c* function_name = NULL;
   symbol_c* function_type_suffix = NULL;
@@ -719,6 +719,10 @@ void *visit(not_expression_c *symbol) {
 }
 
 void *visit(function_invocation_c *symbol) {
+  /* calls to pure standard functions with constant parameters were already evaluated in stage 3 */
+  if (print_const_value(symbol))
+    return NULL;
+
   symbol_c* function_name = NULL;
   DECLARE_PARAM_LIST()
 
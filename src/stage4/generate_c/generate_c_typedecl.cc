@@ -90,7 +90,7 @@ class generate_datatypes_aliasid_c: fcall_visitor_c {
   private:
     //std::map<std::string, int> inline_array_defined;
     std::string current_array_name;
-    static generate_datatypes_aliasid_c *singleton_;
+    static thread_local generate_datatypes_aliasid_c *singleton_; // one per thread, as the POUs may be generated in parallel
 
   public:
     generate_datatypes_aliasid_c(void) {};
@@ -193,7 +193,7 @@ class generate_datatypes_aliasid_c: fcall_visitor_c {
 };
 
 
-generate_datatypes_aliasid_c *generate_datatypes_aliasid_c::singleton_ = NULL;
+thread_local generate_datatypes_aliasid_c *generate_datatypes_aliasid_c::singleton_ = NULL;
 
 
 
@@ -205,7 +205,7 @@ class generate_c_array_initialization_c: public generate_c_base_and_typeid_c {
                 /* this is part of an implicitly declared datatype (i.e. inside a variable decaration), for which an equivalent C datatype
                  * has already been defined. So, we simly print out the id of that C datatpe...
                  */
-              symbol->anotations_map["generate_c_annotaton__implicit_type_id"]->accept(*this);
+              symbol->anotations_map.at("generate_c_annotaton__implicit_type_id")->accept(*this);
             else
               symbol->non_generic_type_name->accept(*this);
             break;
@@ -572,6 +572,8 @@ class generate_c_structure_initialization_c: public generate_c_base_and_typeid_c
       type_symtable_t::iterator iter = type_symtable.end();
       switch (current_mode) {
         case initdefault_sm:
+          /* use the declaration already resolved by absyntax_utils_init(), if available... */
+          if (NULL != type_name->decl) {type_name->decl->accept(*this); break;}
           /* look up the type declaration... */
           iter = type_symtable.find(type_name);
           if (iter == type_symtable.end())
@@ -41,6 +41,10 @@
 
 // #include <stdio.h>  /* required for NULL */
 #include <string>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <type_traits>
 #include <iostream>
 #include <fstream>
 #include <cstdio>
@@ -52,6 +56,7 @@
 
 #include "stage4.hh"
 #include "../main.hh" // required for ERROR() and ERROR_MSG() macros.
+#include "../stage1_2/stage1_2.hh" // required for stage1_2_source_files()
 #include "matiec/error.hpp"
 #include "matiec/format.hpp"
 
@@ -62,6 +67,37 @@
 #define  LAST_(symbol1, symbol2) (((symbol1)->last_order  > (symbol2)->last_order)    ? (symbol1) : (symbol2))
 #include <stdarg.h>
 
+static stage4_error_buffer_c *&current_error_buffer(void) {
+  static thread_local stage4_error_buffer_c *buffer = NULL;
+  return buffer;
+}
+
+scoped_stage4_error_buffer_c::scoped_stage4_error_buffer_c(stage4_error_buffer_c *buffer): previous(current_error_buffer()) {
+  current_error_buffer() = buffer;
+}
+
+scoped_stage4_error_buffer_c::~scoped_stage4_error_buffer_c(void) {
+  current_error_buffer() = previous;
+}
+
+void stage4_error_buffer_c::add(std::string message, std::optional<matiec::SourceLocation> location, std::string text,
+                                matiec::ErrorCategory category) {
+  entries.push_back(entry_t{std::move(message), std::move(location), std::move(text), category});
+}
+
+void stage4_error_buffer_c::flush(void) {
+  for (entry_t &entry : entries) {
+    matiec::globalErrorReporter().report(
+        matiec::ErrorSeverity::Error,
+        entry.category,
+        std::move(entry.message),
+        entry.location);
+    fputs(entry.text.c_str(), stderr);
+  }
+  entries.clear();
+}
+
+
 void stage4err(const char *stage4_generator_id, symbol_c *symbol1, symbol_c *symbol2, const char *errmsg, ...) {
     va_list argptr;
     va_start(argptr, errmsg); /* second argument is last fixed pamater of stage4err() */
@@ -88,69 +124,183 @@ void stage4err(const char *stage4_generator_id, symbol_c *symbol1, symbol_c *sym
       full_msg = msg;
     }
 
-    matiec::globalErrorReporter().report(
-        matiec::ErrorSeverity::Error,
-        matiec::ErrorCategory::CodeGen,
-        std::move(full_msg),
-        loc);
-
+    std::string text;
     if ((symbol1 != NULL) && (symbol2 != NULL))
-      fprintf(stderr, "%s:%d-%d..%d-%d: ",
+      text = matiec::format("%s:%d-%d..%d-%d: ",
               FIRST_(symbol1,symbol2)->first_file, FIRST_(symbol1,symbol2)->first_line, FIRST_(symbol1,symbol2)->first_column,
                                                    LAST_(symbol1,symbol2) ->last_line,  LAST_(symbol1,symbol2) ->last_column);
+    text += matiec::format("error %s: %s\n", stage4_generator_id, msg.c_str());
 
-    fprintf(stderr, "error %s: %s\n", stage4_generator_id, msg.c_str());
+    if (current_error_buffer() != NULL) {
+      current_error_buffer()->add(std::move(full_msg), std::move(loc), std::move(text));
+      return;
+    }
+    stage4_error_buffer_c unbuffered;
+    unbuffered.add(std::move(full_msg), std::move(loc), std::move(text));
+    unbuffered.flush();
     // error_count++;
 }
 
 
 
 stage4out_c::stage4out_c(std::string indent_level):
-  m_file(nullptr) {
+  buffer(new char[buffer_size]), buffered(0) {
   out = &std::cout;
   this->indent_level = indent_level;
   this->indent_spaces = "";
   allow_output = true;
 }
 
-stage4out_c::stage4out_c(const char *dir, const char *radix, const char *extension, std::string indent_level) {
-  std::string filename(radix);
-  filename += ".";
-  filename += extension;
+static std::string output_path(const char *dir, const char *radix, const char *extension) {
   std::string filepath("");
   if (dir != NULL) {
     filepath += dir;
     filepath += "/";
   }
-  filepath += filename;
-  auto file = std::make_unique<std::fstream>(filepath.c_str(), std::fstream::out);
-  if(file->fail()){
+  filepath += radix;
+  filepath += ".";
+  filepath += extension;
+  return filepath;
+}
+
+stage4out_c::stage4out_c(const char *dir, const char *radix, const char *extension, std::string indent_level, bool announce):
+  buffered(0), out(NULL), filepath(output_path(dir, radix, extension)) {
+  /* Check right away that we will be able to write the file. Opening it for appending creates
+   * the file if it does not yet exist, but leaves an existing file (and its timestamp) untouched.
+   */
+  std::ofstream file(filepath.c_str(), std::ofstream::out | std::ofstream::app);
+  if(file.fail()){
     std::string msg = "Cannot open " + filepath + " for write access";    
     matiec::globalErrorReporter().report(
         matiec::ErrorSeverity::Error,
         matiec::ErrorCategory::IO,
         msg);
     throw stage4_codegen_error(msg);
-  }else{
-    std::cout << filename << "\n";
+  }else if (announce){
+    stage4out_c::announce(dir, radix, extension);
   }
-  out = file.get();
-  m_file = std::move(file);
   this->indent_level = indent_level;
   this->indent_spaces = "";
   allow_output = true;
 }
 
 stage4out_c::~stage4out_c(void) {
-  if (m_file) {
-    m_file->close();
+  if (out == NULL) write_file();
+  else             flush_buffer();
+}
+
+/* Whether the file already holds exactly the given contents (read back in text mode, just as it is written). */
+static bool file_has_contents(const std::string &filepath, std::string_view contents) {
+  std::ifstream file(filepath.c_str());
+  if (file.fail()) return false;
+  char chunk[1 << 16];
+  while (true) {
+    file.read(chunk, sizeof(chunk));
+    size_t len = static_cast<size_t>(file.gcount());
+    if (len == 0) break;
+    if ((len > contents.size()) || (memcmp(chunk, contents.data(), len) != 0)) return false;
+    contents.remove_prefix(len);
+  }
+  return contents.empty() && !file.bad();
+}
+
+/* Write the generated file, unless it already holds the same contents. Errors are reported
+ * (or added to the error buffer of the thread) instead of thrown, as we are called by the destructor.
+ */
+void stage4out_c::write_file(void) {
+  if (file_has_contents(filepath, contents))
+    return;
+  std::ofstream file(filepath.c_str(), std::ofstream::out | std::ofstream::trunc);
+  file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  file.close();
+  if (!file.fail())
+    return;
+
+  std::string msg = "Cannot write " + filepath;
+  stage4_error_buffer_c unbuffered;
+  stage4_error_buffer_c *errors = (current_error_buffer() != NULL) ? current_error_buffer() : &unbuffered;
+  errors->add(msg, std::nullopt, msg + "\n", matiec::ErrorCategory::IO);
+  unbuffered.flush();
+}
+
+void stage4out_c::flush_buffer(void) {
+  if (buffered > 0)
+    out->write(buffer.get(), static_cast<std::streamsize>(buffered));
+  buffered = 0;
+}
+
+void stage4out_c::write(const char *data, size_t len) {
+  if (out == NULL) {
+    contents.append(data, len);
+    return;
+  }
+  if (len > buffer_size - buffered) {
+    flush_buffer();
+    if (len >= buffer_size) {
+      /* would not fit in the buffer anyway, so skip the copy */
+      out->write(data, static_cast<std::streamsize>(len));
+      return;
+    }
+  }
+  memcpy(buffer.get() + buffered, data, len);
+  buffered += len;
+}
+
+/* Write str converted to upper case, with every '.' replaced by dot.
+ * The identifiers and locations are plain ASCII, so we do not need the locale aware toupper().
+ */
+static inline char to_upper(char c, char dot) {
+  return (c == '.') ? dot : ((c >= 'a') && (c <= 'z')) ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+void stage4out_c::write_upper(std::string_view str, char dot) {
+  if (out == NULL) {
+    for (char c : str) contents += to_upper(c, dot);
+    return;
+  }
+  while (!str.empty()) {
+    if (buffered == buffer_size) flush_buffer();
+    size_t len = std::min(str.size(), buffer_size - buffered);
+    char  *dst = buffer.get() + buffered;
+    for (size_t i = 0; i < len; i++)
+      dst[i] = to_upper(str[i], dot);
+    buffered += len;
+    str.remove_prefix(len);
   }
 }
 
+/* Same text as the default formatting of std::ostream, i.e. %d for integers and %g for reals. */
+template<typename value_t>
+void stage4out_c::write_number(value_t value) {
+  char text[64];
+  std::to_chars_result res;
+  if constexpr (std::is_floating_point<value_t>::value)
+    res = std::to_chars(text, text + sizeof(text), value, std::chars_format::general, 6);
+  else
+    res = std::to_chars(text, text + sizeof(text), value);
+  if (res.ec != std::errc()) ERROR;
+  write(text, res.ptr - text);
+}
+
 void stage4out_c::flush(void) {
+  if (out == NULL) return; /* files are only written when complete */
+  flush_buffer();
   out->flush();
 }
 
+static std::vector<std::string> &announced_files_(void) {
+  static std::vector<std::string> files;
+  return files;
+}
+
+void stage4out_c::announce(const char *dir, const char *radix, const char *extension) {
+  std::cout << radix << "." << extension << "\n";
+  announced_files_().push_back(output_path(dir, radix, extension));
+}
+
+const std::vector<std::string> &stage4out_c::announced_files(void) {return announced_files_();}
+void stage4out_c::clear_announced_files(void) {announced_files_().clear();}
+
 void stage4out_c::enable_output(void) {
   allow_output = true;
 }
@@ -170,86 +320,67 @@ void stage4out_c::indent_left(void) {
     indent_spaces.erase();
 }
 
-void *stage4out_c::print(     std::string_view value) {
-  if (!allow_output) return NULL;
-  if (!value.empty())
-    out->write(value.data(), static_cast<std::streamsize>(value.size()));
-  return NULL;
-}
-void *stage4out_c::print(           const char *value) {if (!allow_output) return NULL; *out << value; return NULL;}
-//void *stage4out_c::print(               int64_t value) {if (!allow_output) return NULL; *out << value; return NULL;}
-//void *stage4out_c::print(              uint64_t value) {if (!allow_output) return NULL; *out << value; return NULL;}
-void *stage4out_c::print(              real64_t value) {if (!allow_output) return NULL; *out << value; return NULL;}
-void *stage4out_c::print(                   int value) {if (!allow_output) return NULL; *out << value; return NULL;}
-void *stage4out_c::print(              long int value) {if (!allow_output) return NULL; *out << value; return NULL;}
-void *stage4out_c::print(         long long int value) {if (!allow_output) return NULL; *out << value; return NULL;}
-void *stage4out_c::print(unsigned           int value) {if (!allow_output) return NULL; *out << value; return NULL;}
-void *stage4out_c::print(unsigned      long int value) {if (!allow_output) return NULL; *out << value; return NULL;}
-void *stage4out_c::print(unsigned long long int value) {if (!allow_output) return NULL; *out << value; return NULL;}
+void *stage4out_c::print(     std::string_view value) {if (!allow_output) return NULL; write(value.data(), value.size()); return NULL;}
+void *stage4out_c::print(           const char *value) {if (!allow_output) return NULL; if (value != NULL) write(value, strlen(value)); return NULL;}
+//void *stage4out_c::print(               int64_t value) {if (!allow_output) return NULL; write_number(value); return NULL;}
+//void *stage4out_c::print(              uint64_t value) {if (!allow_output) return NULL; write_number(value); return NULL;}
+void *stage4out_c::print(              real64_t value) {if (!allow_output) return NULL; write_number(value); return NULL;}
+void *stage4out_c::print(                   int value) {if (!allow_output) return NULL; write_number(value); return NULL;}
+void *stage4out_c::print(              long int value) {if (!allow_output) return NULL; write_number(value); return NULL;}
+void *stage4out_c::print(         long long int value) {if (!allow_output) return NULL; write_number(value); return NULL;}
+void *stage4out_c::print(unsigned           int value) {if (!allow_output) return NULL; write_number(value); return NULL;}
+void *stage4out_c::print(unsigned      long int value) {if (!allow_output) return NULL; write_number(value); return NULL;}
+void *stage4out_c::print(unsigned long long int value) {if (!allow_output) return NULL; write_number(value); return NULL;}
 
 
 void *stage4out_c::print_long_integer(unsigned long l_integer, bool suffix) {
   if (!allow_output) return NULL;
-  *out << l_integer;
-  if (suffix) *out << "UL";
+  write_number(l_integer);
+  if (suffix) write("UL", 2);
   return NULL;
 }
 
 void *stage4out_c::print_long_long_integer(unsigned long long ll_integer, bool suffix) {
   if (!allow_output) return NULL;
-  *out << ll_integer;
-  if (suffix) *out << "ULL";
+  write_number(ll_integer);
+  if (suffix) write("ULL", 3);
   return NULL;
 }
 
 
 void *stage4out_c::printupper(const char *str) {
   if (!allow_output) return NULL;
-  for (int i = 0; str[i] != '\0'; i++)
-    *out << static_cast<char>(std::toupper(static_cast<unsigned char>(str[i])));
+  write_upper(str, '.');
   return NULL;
 }
 
 void *stage4out_c::printlocation(const char *str) {
-  if (!allow_output) return NULL;
-  *out << "__";
-  for (int i = 0; str[i] != '\0'; i++)
-    if(str[i] == '.')
-      *out << '_';
-    else
-      *out << static_cast<char>(std::toupper(static_cast<unsigned char>(str[i])));
-  return NULL;
+  return printlocation(std::string_view(str));
 }
 
 void *stage4out_c::printlocation_comasep(const char *str) {
   if (!allow_output) return NULL;
-  *out << static_cast<char>(std::toupper(static_cast<unsigned char>(str[0])));
-  *out << ',';
-  *out << static_cast<char>(std::toupper(static_cast<unsigned char>(str[1])));
-  *out << ',';
-  for (int i = 2; str[i] != '\0'; i++)
-    if(str[i] == '.')
-      *out << ',';
-    else
-      *out << static_cast<char>(std::toupper(static_cast<unsigned char>(str[i])));
+  std::string_view location(str);
+  write_upper(location.substr(0, 1), '.');
+  write(",", 1);
+  write_upper(location.substr(1, 1), '.');
+  write(",", 1);
+  write_upper(location.substr(2), ',');
   return NULL;
 }
 
 
-
 void *stage4out_c::printupper(std::string_view str) {
   if (!allow_output) return NULL;
-  for (char c : str)
-    *out << static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  write_upper(str, '.');
   return NULL;
 }
 
 
 void *stage4out_c::printlocation(std::string_view str) {
   if (!allow_output) return NULL;
-  *out << "__";
-  for (char c : str)
-    *out << ((c == '.') ? '_' : static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+  write("__", 2);
+  write_upper(str, '_');
   return NULL;
 }
 
@@ -273,6 +404,51 @@ visitor_c *new_code_generator(stage4out_c *s4o, const char *builddir);
 void delete_code_generator(visitor_c *code_generator);
 
 
+/* Escape the characters that make would otherwise take as separators, comments or variables. */
+static std::string make_escape(const std::string &path) {
+  std::string escaped;
+  for (char c : path) {
+    if      (c == '$')                            escaped += "$$";
+    else if ((c == ' ') || (c == '#') || (c == '\\')) {escaped += '\\'; escaped += c;}
+    else                                          escaped += c;
+  }
+  return escaped;
+}
+
+int stage4_write_dependency_file(const char *filename, const std::vector<std::string> &targets,
+                                 const std::vector<std::string> &sources) {
+  std::string text;
+  for (size_t i = 0; i < targets.size(); i++) {
+    if (i > 0) text += " ";
+    text += make_escape(targets[i]);
+  }
+  text += ":";
+  for (const std::string &source : sources)
+    text += " \\\n " + make_escape(source);
+  text += "\n";
+  /* an empty rule for each source file, so that make does not fail when a source file gets deleted */
+  for (const std::string &source : sources)
+    text += "\n" + make_escape(source) + ":\n";
+
+  /* just like the generated files, leave the dependency file untouched if it did not change */
+  if (file_has_contents(filename, text))
+    return 0;
+  std::ofstream file(filename, std::ofstream::out | std::ofstream::trunc);
+  file.write(text.data(), static_cast<std::streamsize>(text.size()));
+  file.close();
+  if (file.fail()) {
+    std::string msg = std::string("Cannot write ") + filename;
+    matiec::globalErrorReporter().report(
+        matiec::ErrorSeverity::Error,
+        matiec::ErrorCategory::IO,
+        msg);
+    fprintf(stderr, "%s\n", msg.c_str());
+    return -1;
+  }
+  return 0;
+}
+
+
 int stage4(symbol_c *tree_root, const char *builddir) {
   stage4out_c s4o;
   struct generator_deleter {
@@ -281,32 +457,43 @@ int stage4(symbol_c *tree_root, const char *builddir) {
     }
   };
 
-  std::unique_ptr<visitor_c, generator_deleter> generate_code(new_code_generator(&s4o, builddir));
-  if (generate_code == NULL) {
-    matiec::globalErrorReporter().report(
-        matiec::ErrorSeverity::Fatal,
-        matiec::ErrorCategory::Internal,
-        "Failed to create stage4 code generator");
-    return -1;
+  stage4out_c::clear_announced_files();
+  const int errors_before = matiec::globalErrorReporter().errorCount();
+  {
+    std::unique_ptr<visitor_c, generator_deleter> generate_code(new_code_generator(&s4o, builddir));
+    if (generate_code == NULL) {
+      matiec::globalErrorReporter().report(
+          matiec::ErrorSeverity::Fatal,
+          matiec::ErrorCategory::Internal,
+          "Failed to create stage4 code generator");
+      return -1;
+    }
+
+    try {
+      tree_root->accept(*generate_code);
+    } catch (const stage4_codegen_error&) {
+      return -1;
+    } catch (const std::exception& e) {
+      matiec::globalErrorReporter().report(
+          matiec::ErrorSeverity::Fatal,
+          matiec::ErrorCategory::Internal,
+          std::string("Unhandled exception in stage4: ") + e.what());
+      return -1;
+    } catch (...) {
+      matiec::globalErrorReporter().report(
+          matiec::ErrorSeverity::Fatal,
+          matiec::ErrorCategory::Internal,
+          "Unhandled non-standard exception in stage4");
+      return -1;
+    }
   }
 
-  try {
-    tree_root->accept(*generate_code);
-  } catch (const stage4_codegen_error&) {
-    return -1;
-  } catch (const std::exception& e) {
-    matiec::globalErrorReporter().report(
-        matiec::ErrorSeverity::Fatal,
-        matiec::ErrorCategory::Internal,
-        std::string("Unhandled exception in stage4: ") + e.what());
+  /* The generated files are only written once the code generator (which owns some of them) is gone. */
+  if (matiec::globalErrorReporter().errorCount() > errors_before)
     return -1;
-  } catch (...) {
-    matiec::globalErrorReporter().report(
-        matiec::ErrorSeverity::Fatal,
-        matiec::ErrorCategory::Internal,
-        "Unhandled non-standard exception in stage4");
-    return -1;
-  }
+
+  if (runtime_options.dependency_file != NULL)
+    return stage4_write_dependency_file(runtime_options.dependency_file, stage4out_c::announced_files(), stage1_2_source_files());
 
   return 0;
 }
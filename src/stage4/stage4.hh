@@ -42,10 +42,13 @@
 #include "../absyntax/absyntax.hh"
 #include <fstream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <stdexcept>
 #include <string_view>
+#include <vector>
+#include "matiec/error.hpp"
 
 /* Used to abort code generation without terminating the whole process. */
 struct stage4_codegen_error : public std::runtime_error {
@@ -55,6 +58,40 @@ struct stage4_codegen_error : public std::runtime_error {
 
 void stage4err(const char *stage4_generator_id, symbol_c *symbol1, symbol_c *symbol2, const char *errmsg, ...);
 
+/* The errors found by a part of stage 4 that runs on a worker thread, kept until the thread running
+ * the compiler reports them, so that they get reported in the same order as when generating the code
+ * sequentially. While a scoped_stage4_error_buffer_c is alive, stage4err() adds the errors of that
+ * thread to its buffer instead of reporting them.
+ */
+class stage4_error_buffer_c {
+  public:
+    void add(std::string message, std::optional<matiec::SourceLocation> location, std::string text,
+             matiec::ErrorCategory category = matiec::ErrorCategory::CodeGen);
+    /* Report the buffered errors. */
+    void flush(void);
+
+  private:
+    struct entry_t {
+      std::string message;
+      std::optional<matiec::SourceLocation> location;
+      std::string text; /* as printed on stderr */
+      matiec::ErrorCategory category;
+    };
+    std::vector<entry_t> entries;
+};
+
+class scoped_stage4_error_buffer_c {
+  public:
+    explicit scoped_stage4_error_buffer_c(stage4_error_buffer_c *buffer);
+    ~scoped_stage4_error_buffer_c(void);
+
+    scoped_stage4_error_buffer_c(const scoped_stage4_error_buffer_c &) = delete;
+    scoped_stage4_error_buffer_c &operator=(const scoped_stage4_error_buffer_c &) = delete;
+
+  private:
+    stage4_error_buffer_c *previous;
+};
+
 
 class stage4out_c {
   public:
@@ -63,11 +100,23 @@ class stage4out_c {
 
   public:
     stage4out_c(std::string indent_level = "  ");
-    stage4out_c(const char *dir, const char *radix, const char *extension, std::string indent_level = "  ");
+    /* The file is generated in memory, and only written when the object is destroyed, and only if its
+     * contents changed, so that the build tools do not recompile the files that were generated again
+     * without any change.
+     * announce: print the name of the file on stdout, as the list of generated files. Code generated
+     *           in parallel announces its files beforehand, so they get listed in a deterministic order.
+     */
+    stage4out_c(const char *dir, const char *radix, const char *extension, std::string indent_level = "  ", bool announce = true);
     ~stage4out_c(void);
     
     void flush(void);
-    
+
+    /* Must be called from the thread running stage 4, as it also adds the file to announced_files(). */
+    static void announce(const char *dir, const char *radix, const char *extension);
+    /* The path of every file announced since the last call to clear_announced_files(). */
+    static const std::vector<std::string> &announced_files(void);
+    static void clear_announced_files(void);
+
     void enable_output(void);
     void disable_output(void);
 
@@ -99,8 +148,27 @@ class stage4out_c {
     void *printlocation_comasep(const char *str);
 
   protected:
+    /* The output to a stream is gathered in a buffer, and handed over to the stream in
+     * blocks of buffer_size bytes. Call flush() to empty the buffer earlier.
+     * The output to a file goes straight to its contents (see below), without any buffer.
+     */
+    static const size_t buffer_size = 1 << 20;
+    std::unique_ptr<char[]> buffer;
+    size_t buffered;
+
+    void write(const char *data, size_t len);
+    void write_upper(std::string_view str, char dot);
+    void flush_buffer(void);
+    template<typename value_t> void write_number(value_t value);
+
+    /* Where the output goes: the stream (std::cout), or, when generating a file, the contents of
+     * that file (out is then NULL), written to filepath by write_file().
+     */
     std::ostream *out;
-    std::unique_ptr<std::fstream> m_file;
+    std::string filepath;
+    std::string contents;
+
+    void write_file(void);
     
     /* A flag to tell whether to really print to the file, or to ignore any request to print to the file */
     /* This is used to implement the no_code_generation pragmas, that lets the user tell the compiler
@@ -115,6 +183,12 @@ class stage4out_c {
 
 int stage4(symbol_c *tree_root, const char *builddir);
 
+/* Write the Makefile style dependency file (see runtime_options.dependency_file): every file in targets
+ * depends on every file in sources. Returns -1 if the file could not be written.
+ */
+int stage4_write_dependency_file(const char *filename, const std::vector<std::string> &targets,
+                                 const std::vector<std::string> &sources);
+
 /* Functions to be implemented by each generate_XX version of stage 4 */
 int  stage4_parse_options(char *options);
 void stage4_print_options(void);
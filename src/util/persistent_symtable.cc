@@ -0,0 +1,234 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * A scoped symbol table with cheap copies.
+ * See persistent_symtable.hh for details.
+ */
+
+
+#include <iostream>
+#include <unordered_set>
+#include "persistent_symtable.hh"
+#include "../main.hh" // required for ERROR() and ERROR_MSG() macros.
+
+
+
+
+
+
+template<typename value_type>
+persistent_symtable_c<value_type>::persistent_symtable_c(void) : scopes(1) {}
+
+template<typename value_type>
+persistent_symtable_c<value_type> persistent_symtable_c<value_type>::fork(void) {
+  for (scope_t &scope : scopes)
+    freeze(scope);
+  return *this; /* only copies the layer pointers, as all deltas are now empty */
+}
+
+
+/* Move the delta of a scope into a new shared layer. */
+template<typename value_type>
+void persistent_symtable_c<value_type>::freeze(scope_t &scope) {
+  if (scope.delta.empty())
+    return;
+
+  std::shared_ptr<layer_t> layer = std::make_shared<layer_t>();
+  layer->entries.swap(scope.delta);
+  layer->parent = std::move(scope.frozen);
+
+  /* Keep the chain of layers short. Just like when incrementing a binary counter, merge the new layer with
+   * its parent for as long as the parent is not larger than the new layer. Layers then grow geometrically
+   * along the chain, and each entry is copied into a new layer at most log2(number of entries) times.
+   * Layers shared with another table (i.e. that are also referenced elsewhere) are never merged: the merged
+   * copy would no longer be an ancestor common to both tables, and left_join() would then have to visit all
+   * of its entries. The chain may therefore grow by one layer per fork that is still alive.
+   */
+  while ((layer->parent != NULL) && (layer->parent.use_count() == 1) && (layer->parent->entries.size() <= layer->entries.size())) {
+    layer_ptr_t parent = std::move(layer->parent);
+    layer->entries.insert(parent->entries.begin(), parent->entries.end()); /* does not replace newer entries! */
+    layer->parent = parent->parent;
+  }
+
+  scope.frozen = std::move(layer);
+}
+
+
+template<typename value_type>
+const typename persistent_symtable_c<value_type>::value_t *persistent_symtable_c<value_type>::lookup(const scope_t &scope, std::string_view identifier_str) {
+  typename base_t::const_iterator i = scope.delta.find(identifier_str);
+  if (i != scope.delta.end())
+    return &(i->second);
+
+  for (const layer_t *layer = scope.frozen.get(); layer != NULL; layer = layer->parent.get()) {
+    i = layer->entries.find(identifier_str);
+    if (i != layer->entries.end())
+      return &(i->second);
+  }
+  return NULL;
+}
+
+
+/* The most recent layer shared by both chains (NULL if none) */
+template<typename value_type>
+typename persistent_symtable_c<value_type>::layer_ptr_t persistent_symtable_c<value_type>::common_ancestor(const layer_ptr_t &l1, const layer_ptr_t &l2) {
+  std::unordered_set<const layer_t *> chain1;
+  for (const layer_t *layer = l1.get(); layer != NULL; layer = layer->parent.get())
+    chain1.insert(layer);
+
+  for (layer_ptr_t layer = l2; layer != NULL; layer = layer->parent)
+    if (chain1.count(layer.get()) > 0)
+      return layer;
+  return NULL;
+}
+
+
+
+ /* clear all entries... */
+template<typename value_type>
+void persistent_symtable_c<value_type>::clear(void) {
+  scopes.clear();
+  scopes.resize(1);
+}
+
+ /* create new inner scope */
+template<typename value_type>
+void persistent_symtable_c<value_type>::push(void) {
+  scopes.push_back(scope_t());
+}
+
+  /* clear most inner scope */
+  /* returns 1 if this is the inner most scope	*/
+  /*         0 otherwise			*/
+template<typename value_type>
+int persistent_symtable_c<value_type>::pop(void) {
+  if (scopes.size() > 1) {
+    scopes.pop_back();
+    return 0;
+  }
+  scopes[0] = scope_t();
+  return 1;
+}
+
+
+
+template<typename value_type>
+typename persistent_symtable_c<value_type>::value_t& persistent_symtable_c<value_type>::operator[] (const char *identifier_str) {
+  return (*this)[std::string_view(identifier_str)];
+}
+
+template<typename value_type>
+typename persistent_symtable_c<value_type>::value_t& persistent_symtable_c<value_type>::operator[] (std::string_view identifier_str) {
+  for (size_t s = scopes.size(); s-- > 0; ) {
+    scope_t &scope = scopes[s];
+    typename base_t::iterator i = scope.delta.find(identifier_str);
+    if (i != scope.delta.end())
+      return i->second;
+    const value_t *value = lookup(scope, identifier_str);
+    if (value != NULL)
+      /* copy on write: the caller may change the value through the returned reference */
+      return scope.delta.emplace(std::string(identifier_str), *value).first->second;
+  }
+  /* Not in any scope. Just like symtable_c, create it in the outer most scope. */
+  return scopes[0].delta[std::string(identifier_str)];
+}
+
+
+template<typename value_type>
+int persistent_symtable_c<value_type>::count(const       char *identifier_str) const {
+  return count(std::string_view(identifier_str));
+}
+
+template<typename value_type>
+int persistent_symtable_c<value_type>::count(std::string_view identifier_str) const {
+  int res = 0;
+  for (const scope_t &scope : scopes)
+    if (lookup(scope, identifier_str) != NULL)
+      res++;
+  return res;
+}
+
+
+template<typename value_type>
+const typename persistent_symtable_c<value_type>::value_t *persistent_symtable_c<value_type>::find_value(std::string_view identifier_str) const {
+  for (size_t s = scopes.size(); s-- > 0; ) {
+    const value_t *value = lookup(scopes[s], identifier_str);
+    if (value != NULL)
+      return value;
+  }
+  return NULL;
+}
+
+
+
+template<typename value_type>
+template<typename meet_t>
+persistent_symtable_c<value_type> persistent_symtable_c<value_type>::left_join(const persistent_symtable_c &m1, const persistent_symtable_c &m2, meet_t meet) {
+  persistent_symtable_c ret;
+  ret.scopes.resize(m1.scopes.size());
+
+  const scope_t no_scope;
+  for (size_t s = 0; s < m1.scopes.size(); s++) {
+    const scope_t &s1  = m1.scopes[s];
+    const scope_t &s2  = (s < m2.scopes.size()) ? m2.scopes[s] : no_scope;
+    scope_t       &res = ret.scopes[s];
+
+    /* Entries in the common ancestor have not been changed in either table. */
+    res.frozen = common_ancestor(s1.frozen, s2.frozen);
+
+    /* Only the entries newer than the common ancestor may need to be joined. */
+    auto join_entries = [&](const base_t &entries) {
+      for (const auto &entry : entries) {
+        if (res.delta.find(entry.first) != res.delta.end())
+          continue; /* already joined */
+        const value_t *v1 = lookup(s1, entry.first);
+        if (v1 == NULL)
+          continue; /* left join: only the entries in m1 */
+        const value_t *v2 = lookup(s2, entry.first);
+        res.delta.emplace(entry.first, (v2 != NULL) ? meet(*v1, *v2) : *v1);
+      }
+    };
+    for (const scope_t *scope : {&s1, &s2}) {
+      join_entries(scope->delta);
+      for (const layer_t *layer = scope->frozen.get(); layer != res.frozen.get(); layer = layer->parent.get())
+        join_entries(layer->entries);
+    }
+  }
+
+  return ret;
+}
+
+
+
+/* debuging function... */
+template<typename value_type>
+void persistent_symtable_c<value_type>::print(void) const {
+  for (const scope_t &scope : scopes) {
+    for (const auto &entry : scope.delta)
+      std::cout << entry.second << ":" << entry.first << "\n";
+    for (const layer_t *layer = scope.frozen.get(); layer != NULL; layer = layer->parent.get())
+      for (const auto &entry : layer->entries)
+        if (lookup(scope, entry.first) == &(entry.second))
+          std::cout << entry.second << ":" << entry.first << "\n";
+    std::cout << "=====================\n";
+  }
+}
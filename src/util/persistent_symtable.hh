@@ -0,0 +1,133 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * A scoped symbol table with cheap copies.
+ *
+ * Has the same scoping rules as symtable_c (push()/pop() of inner scopes,
+ * lookups search the inner most scope first), but forking a table does not
+ * copy its entries. Each scope keeps the entries written since the table was
+ * last forked in a small private map (the delta), on top of a chain of
+ * immutable layers that are shared with all the other forks.
+ *
+ * This is meant for data flow analyses (e.g. constant propagation) that fork
+ * the environment at every branch of an IF/CASE/loop and join the results
+ * afterwards:
+ *   - forking a table costs O(number of scopes);
+ *   - left_join() of two tables forked from a common table only visits the
+ *     entries that were written in either of them since the fork.
+ */
+
+
+
+#ifndef _PERSISTENT_SYMTABLE_HH
+#define _PERSISTENT_SYMTABLE_HH
+
+#include "../absyntax/absyntax.hh"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+
+template<typename value_type> class persistent_symtable_c {
+  public:
+    typedef value_type value_t;
+
+  private:
+    /* Comparison between identifiers must ignore case. */
+    typedef std::map<std::string, value_t, nocasecmp_c> base_t;
+
+    /* An immutable set of entries, shared by all the tables forked from the table that created it.
+     * Entries hide the entries with the same name in the parent layers.
+     */
+    typedef struct layer_s {
+      std::shared_ptr<const struct layer_s> parent;
+      base_t entries;
+    } layer_t;
+    typedef std::shared_ptr<const layer_t> layer_ptr_t;
+
+    typedef struct {
+      layer_ptr_t frozen; /* entries shared with other tables (NULL if none) */
+      base_t      delta;  /* entries written since this table was last forked */
+    } scope_t;
+
+    /* scopes[0] is the outer most scope. */
+    std::vector<scope_t> scopes;
+
+    static void           freeze(scope_t &scope);
+    static const value_t *lookup(const scope_t &scope, std::string_view identifier_str);
+    static layer_ptr_t    common_ancestor(const layer_ptr_t &l1, const layer_ptr_t &l2);
+
+  public:
+    persistent_symtable_c(void);
+
+    /* Copies the deltas of other (the layers are shared). Use fork() instead to share all the entries. */
+    persistent_symtable_c(const persistent_symtable_c& other) = default;
+    persistent_symtable_c& operator=(const persistent_symtable_c& other) = default;
+    persistent_symtable_c(persistent_symtable_c&&) noexcept = default;
+    persistent_symtable_c& operator=(persistent_symtable_c&&) noexcept = default;
+    ~persistent_symtable_c() = default;
+
+    /* O(number of scopes). Returns a copy sharing all the entries of this table, which are then copied on write.
+     * Moves the deltas of this table into new shared layers (which does not change its contents).
+     */
+    persistent_symtable_c fork(void);
+
+    void clear(void); /* clear all entries (all scopes) */
+    void push(void);  /* create new inner scope */
+    int  pop(void);   /* clear most inner scope */
+
+    /* Same semantics as symtable_c: returns the entry in the inner most scope that contains the identifier,
+     * or creates a new entry in the outer most scope if the identifier is not in any scope.
+     */
+    value_t& operator[](const       char *identifier_str);
+    value_t& operator[](std::string_view identifier_str);
+
+    /* Number of scopes containing that entry (0 if not found) */
+    int count(const       char *identifier_str) const;
+    int count(std::string_view identifier_str) const;
+
+    /* Read only lookup (does not copy the entry into this table). Returns NULL if not found. */
+    const value_t *find_value(std::string_view identifier_str) const;
+
+    /* Returns a table with every entry of m1, where the entries that also exist in m2 are replaced
+     * by meet(m1_value, m2_value). Entries that have not been written to in m1 nor in m2 since they
+     * were forked from a common table are kept as they are (i.e. meet(v, v) is assumed to be v),
+     * and are not even visited.
+     */
+    template<typename meet_t>
+    static persistent_symtable_c left_join(const persistent_symtable_c &m1, const persistent_symtable_c &m2, meet_t meet);
+
+    /* debuging function... */
+    void print(void) const;
+};
+
+
+
+/* Templates must include the source into the code! */
+#include "persistent_symtable.cc"
+
+#endif /*  _PERSISTENT_SYMTABLE_HH */
@@ -0,0 +1,176 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * This code is made available on the understanding that it will not be
+ * used in safety-critical situations without a full and competent review.
+ */
+
+/*
+ * A small pool of worker threads, for running independent tasks (typically
+ * one per POU) of a compiler pass in parallel.
+ *
+ * run(count, task) calls task(0) .. task(count-1), each exactly once, and only
+ * returns when all of them have completed. The calling thread works on the
+ * tasks too. Threads take the next task that nobody has started yet, so a
+ * thread that finishes a small POU immediately moves on to the next one
+ * while the others are still busy with larger POUs.
+ *
+ * If some tasks throw, run() rethrows the exception of the task with the
+ * lowest index once all tasks have completed, i.e. the same exception that
+ * a sequential loop over the tasks would have thrown. failed_task() then
+ * returns that index.
+ *
+ * With a single job (or a single task) the tasks are simply called in order
+ * on the calling thread.
+ */
+
+#ifndef _WORK_POOL_HH
+#define _WORK_POOL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace matiec {
+
+class work_pool_c {
+  public:
+    static constexpr size_t no_failed_task = (size_t)-1;
+
+    explicit work_pool_c(unsigned int jobs) : jobs_((jobs < 1)? 1 : jobs) {
+      for (unsigned int i = 1; i < jobs_; i++)
+        threads_.emplace_back([this] {worker_loop();});
+    }
+
+    ~work_pool_c(void) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      wake_.notify_all();
+      for (std::thread &thread : threads_) thread.join();
+    }
+
+    work_pool_c(const work_pool_c &) = delete;
+    work_pool_c &operator=(const work_pool_c &) = delete;
+
+    unsigned int jobs(void) const {return jobs_;}
+
+    /* Index of the task whose exception was rethrown by the last call to run(), or no_failed_task. */
+    size_t failed_task(void) const {return failed_task_;}
+
+    void run(size_t count, const std::function<void(size_t)> &task) {
+      failed_task_ = no_failed_task;
+      if ((jobs_ == 1) || (count <= 1)) {
+        for (size_t i = 0; i < count; i++) {
+          try {task(i);}
+          catch (...) {failed_task_ = i; throw;}
+        }
+        return;
+      }
+
+      std::shared_ptr<run_c> run = std::make_shared<run_c>(task, count);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_ = run;
+        generation_++;
+      }
+      wake_.notify_all();
+      run_tasks(*run);
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] {return run->pending == 0;});
+        current_ = nullptr;
+      }
+
+      for (size_t i = 0; i < count; i++)
+        if (run->exceptions[i]) {
+          failed_task_ = i;
+          std::rethrow_exception(run->exceptions[i]);
+        }
+    }
+
+    /* A pool shared by the whole compiler, (re)created when a different number of jobs is requested.
+     * Must only be used from one thread at a time (i.e. the thread running the compiler).
+     */
+    static work_pool_c &shared(unsigned int jobs) {
+      static std::unique_ptr<work_pool_c> pool;
+      if ((nullptr == pool) || (pool->jobs() != ((jobs < 1)? 1 : jobs)))
+        pool.reset(new work_pool_c(jobs));
+      return *pool;
+    }
+
+  private:
+    /* One call to run(). It is only ever replaced, never modified, so a worker that wakes up late
+     * (i.e. after the run it was woken for has completed) only finds a run with no tasks left.
+     */
+    struct run_c {
+      run_c(const std::function<void(size_t)> &task, size_t count)
+        : task(task), count(count), exceptions(count), pending(count) {}
+      const std::function<void(size_t)> &task;
+      const size_t count;
+      std::atomic<size_t> next{0};
+      std::vector<std::exception_ptr> exceptions;
+      size_t pending; /* protected by mutex_ */
+    };
+
+    void run_tasks(run_c &run) {
+      size_t i;
+      while ((i = run.next.fetch_add(1)) < run.count) {
+        try {run.task(i);}
+        catch (...) {run.exceptions[i] = std::current_exception();}
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--run.pending == 0) done_.notify_all();
+      }
+    }
+
+    void worker_loop(void) {
+      unsigned long long seen_generation = 0;
+      while (true) {
+        std::shared_ptr<run_c> run;
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          wake_.wait(lock, [&] {return stop_ || (generation_ != seen_generation);});
+          if (stop_) return;
+          seen_generation = generation_;
+          run = current_;
+        }
+        if (nullptr != run) run_tasks(*run);
+      }
+    }
+
+    unsigned int jobs_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    bool stop_ = false;
+    unsigned long long generation_ = 0;
+
+    /* the run() currently in progress, if any */
+    std::shared_ptr<run_c> current_;
+    size_t failed_task_ = no_failed_task;
+};
+
+} // namespace matiec
+
+#endif /* _WORK_POOL_HH */
@@ -23,14 +23,14 @@ protected:
         opts_.include_dir = lib_dir_.c_str();
         output_dir_ = temp_.path().string();
         opts_.output_dir = output_dir_.c_str();
-        fixture_path_ = getFixturesDir() / "simple_program.st";
     }
 
     void TearDown() override {
         matiec_result_free(&result_);
     }
 
-    void CompileFixture(matiec_output_format_t format) {
+    void CompileFixture(matiec_output_format_t format, const char* fixture = "simple_program.st") {
+        fixture_path_ = getFixturesDir() / fixture;
         ASSERT_TRUE(fs::exists(fixture_path_)) << "Missing fixture: " << fixture_path_.string();
         opts_.output_format = format;
         auto status = matiec_compile_file(fixture_path_.string().c_str(), &opts_, &result_);
@@ -77,3 +77,14 @@ TEST_F(CodegenRegressionTest, GeneratesStableIecOutput) {
 
     EXPECT_EQ(actual_iec, expected_iec);
 }
+
+TEST_F(CodegenRegressionTest, PrintsFoldedStandardFunctionCallsAsLiterals) {
+    CompileFixture(MATIEC_OUTPUT_C, "constant_functions.st");
+
+    const std::string pous_c = ReadRequiredFile(temp_.path() / "POUS.c");
+
+    EXPECT_NE(pous_c.find("__REAL_LITERAL(2)"), std::string::npos) << pous_c;
+    EXPECT_NE(pous_c.find("__INT_LITERAL(7)"), std::string::npos) << pous_c;
+    // the user's TRUNC_INT is called, not evaluated as the standard TRUNC would be
+    EXPECT_EQ(pous_c.find("__INT_LITERAL(2)"), std::string::npos) << pous_c;
+}
@@ -0,0 +1,112 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the AST memory statistics.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "absyntax/absyntax.hh"
+#include "absyntax_utils/absyntax_utils.hh"
+
+namespace {
+
+const matiec::ast_class_memory_stats_t* find_class(const matiec::ast_memory_stats_t& stats, const char* cname) {
+    for (const auto& cls : stats.classes) {
+        if (std::strcmp(cls.cname, cname) == 0) return &cls;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(AstMemoryStatsTest, CountsEachReachableNodeOnce) {
+    // CASE x OF 1, 2: y := x; END_CASE   (x is shared by two parents)
+    identifier_c x("x"), y("y");
+    integer_c one("1"), two("2");
+    case_list_c case_list(&one);
+    case_list.add_element(&two);
+    symbolic_variable_c lhs(&y);
+    symbolic_variable_c selector(&x);
+    assignment_statement_c assign(&lhs, &selector);
+    statement_list_c statements(&assign);
+    case_element_c element(&case_list, &statements);
+    case_element_list_c elements(&element);
+    case_statement_c case_stmt(&selector, &elements, nullptr);
+
+    matiec::ast_memory_stats_t stats = matiec::ast_memory_stats(&case_stmt);
+
+    EXPECT_EQ(stats.node_count, 12u);
+    const auto* idents = find_class(stats, "identifier_c");
+    ASSERT_NE(idents, nullptr);
+    EXPECT_EQ(idents->count, 2u);
+    EXPECT_GE(idents->bytes, 2 * sizeof(identifier_c));
+    EXPECT_GT(idents->annotation_bytes, 0u);
+    EXPECT_LT(idents->annotation_bytes, idents->bytes);
+
+    const auto* vars = find_class(stats, "symbolic_variable_c");
+    ASSERT_NE(vars, nullptr);
+    EXPECT_EQ(vars->count, 2u);
+
+    size_t total = 0;
+    for (const auto& cls : stats.classes) total += cls.bytes;
+    EXPECT_EQ(total, stats.bytes);
+
+    // Classes are sorted by size, largest first.
+    for (size_t i = 1; i < stats.classes.size(); i++) {
+        EXPECT_GE(stats.classes[i - 1].bytes, stats.classes[i].bytes);
+    }
+}
+
+TEST(AstMemoryStatsTest, AnnotationsAreAccounted) {
+    identifier_c ident("foo");
+    integer_c value("1");
+
+    const matiec::ast_memory_stats_t before = matiec::ast_memory_stats(&ident);
+    for (int i = 0; i < 16; i++) ident.candidate_datatypes.push_back(&value);
+    ident.anotations_map["a_rather_long_annotation_name_that_does_not_fit_inline"] = &value;
+    const matiec::ast_memory_stats_t after = matiec::ast_memory_stats(&ident);
+
+    EXPECT_GE(after.annotation_bytes, before.annotation_bytes + 16 * sizeof(symbol_c*));
+    EXPECT_EQ(after.bytes - before.bytes, after.annotation_bytes - before.annotation_bytes);
+}
+
+TEST(AstMemoryStatsTest, KeepsLargestListsOnly) {
+    integer_c one("1");
+    identifier_c a("a"), b("b"), c("c");
+    case_list_c small(&one);
+    case_list_c large(&a);
+    large.add_element(&b);
+    large.add_element(&c);
+    statement_list_c root(&small);
+    root.add_element(&large);
+
+    matiec::ast_memory_stats_t stats = matiec::ast_memory_stats(&root, nullptr, 2);
+    ASSERT_EQ(stats.largest_lists.size(), 2u);
+    EXPECT_EQ(stats.largest_lists[0].n, 3);
+    EXPECT_STREQ(stats.largest_lists[0].cname, "case_list_c");
+    EXPECT_EQ(stats.largest_lists[1].n, 2);
+    EXPECT_STREQ(stats.largest_lists[1].cname, "statement_list_c");
+
+    const std::string report = matiec::ast_memory_stats_report(stats);
+    EXPECT_NE(report.find("7 nodes"), std::string::npos) << report;
+    EXPECT_NE(report.find("identifier_c"), std::string::npos) << report;
+    EXPECT_NE(report.find("Largest lists:"), std::string::npos) << report;
+}
+
+TEST(AstMemoryStatsTest, NullRootsGiveEmptyStats) {
+    matiec::ast_memory_stats_t stats = matiec::ast_memory_stats(nullptr);
+    EXPECT_EQ(stats.node_count, 0u);
+    EXPECT_TRUE(stats.classes.empty());
+    EXPECT_TRUE(stats.largest_lists.empty());
+}
+
+TEST(AstMemoryStatsTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
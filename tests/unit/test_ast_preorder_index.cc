@@ -0,0 +1,92 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the flattened preorder AST index.
+ */
+
+#include <gtest/gtest.h>
+
+#include "absyntax/ast_preorder_index.hh"
+#include "absyntax_utils/absyntax_utils.hh"
+
+namespace {
+
+using matiec::ast_class_tag_t;
+using matiec::ast_preorder_index_c;
+
+} // namespace
+
+TEST(AstPreorderIndexTest, TagsMatchConcreteClass) {
+    identifier_c ident("foo");
+    case_list_c list;
+
+    EXPECT_EQ(matiec::ast_class_tag(&ident), ast_class_tag_t::identifier_c);
+    EXPECT_EQ(matiec::ast_class_tag(&list), ast_class_tag_t::case_list_c);
+    EXPECT_EQ(matiec::ast_class_tag(nullptr), ast_class_tag_t::count_);
+}
+
+TEST(AstPreorderIndexTest, EntriesFollowIteratorVisitorOrder) {
+    // CASE x OF 1: y := 2; END_CASE
+    identifier_c x("x"), y("y");
+    integer_c one("1"), two("2");
+    case_list_c case_list(&one);
+    symbolic_variable_c lhs(&y);
+    assignment_statement_c assign(&lhs, &two);
+    statement_list_c statements(&assign);
+    case_element_c element(&case_list, &statements);
+    case_element_list_c elements(&element);
+    symbolic_variable_c selector(&x);
+    case_statement_c case_stmt(&selector, &elements, nullptr);
+
+    ast_preorder_index_c index(&case_stmt);
+
+    const symbol_c* expected[] = {&case_stmt, &selector, &x, &elements, &element, &case_list, &one,
+                                  &statements, &assign, &lhs, &y, &two};
+    ASSERT_EQ(index.size(), sizeof(expected) / sizeof(expected[0]));
+    for (size_t i = 0; i < index.size(); i++) {
+        EXPECT_EQ(index[i].node, expected[i]) << "at position " << i;
+    }
+
+    // root spans the whole array, leaves span only themselves
+    EXPECT_EQ(index[0].parent, ast_preorder_index_c::no_parent);
+    EXPECT_EQ(index[0].subtree_end, static_cast<int32_t>(index.size()));
+    EXPECT_EQ(index[2].subtree_end, 3);
+    // case_element_c subtree: case_list, 1, statements, assign, lhs, y, 2
+    EXPECT_EQ(index[4].subtree_end, 12);
+    EXPECT_EQ(index[5].parent, 4);
+    EXPECT_EQ(index[7].parent, 4);
+
+    ASSERT_EQ(index.positions_of(ast_class_tag_t::symbolic_variable_c).size(), 2u);
+    EXPECT_EQ(index.positions_of(ast_class_tag_t::symbolic_variable_c)[0], 1);
+    EXPECT_EQ(index.positions_of(ast_class_tag_t::symbolic_variable_c)[1], 9);
+
+    int case_count = 0;
+    index.for_each<case_statement_c>(ast_class_tag_t::case_statement_c, [&](case_statement_c* symbol) {
+        EXPECT_EQ(symbol, &case_stmt);
+        case_count++;
+    });
+    EXPECT_EQ(case_count, 1);
+}
+
+TEST(AstPreorderIndexTest, SharedNodesAreIndexedOnce) {
+    identifier_c shared("shared");
+    case_list_c list(&shared);
+    list.add_element(&shared);
+
+    ast_preorder_index_c index(&list);
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_EQ(index[0].subtree_end, 2);
+}
+
+TEST(AstPreorderIndexTest, NullRootGivesEmptyIndex) {
+    ast_preorder_index_c index(nullptr);
+    EXPECT_TRUE(index.empty());
+    EXPECT_TRUE(index.positions_of(ast_class_tag_t::identifier_c).empty());
+}
+
+TEST(AstPreorderIndexTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
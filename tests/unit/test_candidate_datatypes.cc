@@ -0,0 +1,104 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the candidate datatype lists used by the stage3 datatype analysis.
+ */
+
+#include <gtest/gtest.h>
+
+#include "absyntax_utils/absyntax_utils.hh"
+#include "stage3/datatype_functions.hh"
+
+TEST(CandidateDatatypesTest, MaskTracksElementaryClasses) {
+    candidate_datatypes_c list;
+    EXPECT_EQ(list.elementary_mask(), 0u);
+
+    int int_bit = candidate_datatypes_c::elementary_bit(&get_datatype_info_c::int_type_name);
+    int safeint_bit = candidate_datatypes_c::elementary_bit(&get_datatype_info_c::safeint_type_name);
+    ASSERT_GE(int_bit, 0);
+    ASSERT_GE(safeint_bit, 0);
+    EXPECT_NE(int_bit, safeint_bit);
+
+    structure_element_declaration_list_c a_struct;
+    EXPECT_EQ(candidate_datatypes_c::elementary_bit(&a_struct), -1);
+    EXPECT_EQ(candidate_datatypes_c::elementary_bit(nullptr), -1);
+
+    list.push_back(&get_datatype_info_c::int_type_name);
+    list.push_back(&a_struct);
+    list.push_back(&get_datatype_info_c::safeint_type_name);
+    EXPECT_TRUE(list.has_elementary(int_bit));
+    EXPECT_TRUE(list.has_elementary(safeint_bit));
+    EXPECT_EQ(list.non_elementary_count(), 1u);
+
+    // insertion order is kept
+    ASSERT_EQ(list.size(), 3u);
+    EXPECT_EQ(list[1], &a_struct);
+
+    list.erase(list.begin());
+    EXPECT_FALSE(list.has_elementary(int_bit));
+    list.erase(list.begin());
+    EXPECT_EQ(list.non_elementary_count(), 0u);
+    list.clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(list.elementary_mask(), 0u);
+}
+
+TEST(CandidateDatatypesTest, EraseKeepsBitOfRepeatedClass) {
+    int_type_name_c other_int;
+    candidate_datatypes_c list;
+    list.push_back(&get_datatype_info_c::int_type_name);
+    list.push_back(&other_int);
+    list.erase(list.begin());
+    EXPECT_TRUE(list.has_elementary(candidate_datatypes_c::elementary_bit(&other_int)));
+}
+
+TEST(CandidateDatatypesTest, SearchUsesClassOfElementaryTypes) {
+    symbol_c symbol;
+    symbol.candidate_datatypes.push_back(&get_datatype_info_c::sint_type_name);
+    symbol.candidate_datatypes.push_back(&get_datatype_info_c::int_type_name);
+
+    int_type_name_c other_int;
+    EXPECT_EQ(search_in_candidate_datatype_list(&other_int, symbol.candidate_datatypes), 1);
+    EXPECT_EQ(search_in_candidate_datatype_list(&get_datatype_info_c::dint_type_name, symbol.candidate_datatypes), -1);
+    EXPECT_EQ(search_in_candidate_datatype_list(nullptr, symbol.candidate_datatypes), -1);
+
+    // a generic ANY candidate matches any datatype
+    generic_type_any_c any_type;
+    symbol.candidate_datatypes.push_back(&any_type);
+    EXPECT_EQ(search_in_candidate_datatype_list(&get_datatype_info_c::dint_type_name, symbol.candidate_datatypes), 2);
+
+    EXPECT_TRUE(remove_from_candidate_datatype_list(&get_datatype_info_c::sint_type_name, symbol.candidate_datatypes));
+    EXPECT_EQ(symbol.candidate_datatypes.size(), 2u);
+}
+
+TEST(CandidateDatatypesTest, IntersectKeepsOrderOfFirstList) {
+    symbol_c list1, list2;
+    list1.candidate_datatypes.push_back(&get_datatype_info_c::lint_type_name);
+    list1.candidate_datatypes.push_back(&get_datatype_info_c::sint_type_name);
+    list1.candidate_datatypes.push_back(&get_datatype_info_c::int_type_name);
+    list1.candidate_datatypes.push_back(&get_datatype_info_c::word_type_name);
+    list2.candidate_datatypes.push_back(&get_datatype_info_c::word_type_name);
+    list2.candidate_datatypes.push_back(&get_datatype_info_c::lint_type_name);
+    list2.candidate_datatypes.push_back(&get_datatype_info_c::int_type_name);
+
+    intersect_candidate_datatype_list(&list1, &list2);
+    ASSERT_EQ(list1.candidate_datatypes.size(), 3u);
+    EXPECT_EQ(list1.candidate_datatypes[0], &get_datatype_info_c::lint_type_name);
+    EXPECT_EQ(list1.candidate_datatypes[1], &get_datatype_info_c::int_type_name);
+    EXPECT_EQ(list1.candidate_datatypes[2], &get_datatype_info_c::word_type_name);
+    EXPECT_EQ(search_in_candidate_datatype_list(&get_datatype_info_c::sint_type_name, list1.candidate_datatypes), -1);
+
+    // with a generic ANY in the second list, nothing gets removed
+    generic_type_any_c any_type;
+    symbol_c any_list;
+    any_list.candidate_datatypes.push_back(&any_type);
+    intersect_candidate_datatype_list(&list1, &any_list);
+    EXPECT_EQ(list1.candidate_datatypes.size(), 3u);
+}
+
+TEST(CandidateDatatypesTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
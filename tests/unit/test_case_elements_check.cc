@@ -0,0 +1,135 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the detection of overlapping CASE options by
+ *  case_elements_check_c.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+#include "stage3/case_elements_check.hh"
+
+namespace {
+
+class CaseElementsCheckTest : public ::testing::Test {
+protected:
+    // an integer constant, as left by constant folding
+    symbol_c* value(int64_t v) {
+        symbol_c* symbol = keep(new integer_c(std::to_string(v).c_str()));
+        symbol->const_value.m_int64.set(v);
+        if (v >= 0) symbol->const_value.m_uint64.set(v);
+        return symbol;
+    }
+
+    symbol_c* range(int64_t lower, int64_t upper) { return keep(new subrange_c(value(lower), value(upper))); }
+
+    // CASE x OF <element>: ; <element>: ; ... [ELSE <else_list>] END_CASE, each element on its own line
+    case_statement_c* case_statement(std::vector<symbol_c*> elements, symbol_c* else_list = nullptr) {
+        case_element_list_c* case_elements = keep(new case_element_list_c());
+        for (size_t i = 0; i < elements.size(); i++) {
+            elements[i]->first_line = elements[i]->last_line = i + 1;
+            elements[i]->first_order = elements[i]->last_order = i + 1;
+            case_list_c* case_list = keep(new case_list_c());
+            case_list->add_element(elements[i]);
+            case_elements->add_element(keep(new case_element_c(case_list, nullptr)));
+        }
+        return keep(new case_statement_c(keep(new identifier_c("X")), case_elements, else_list));
+    }
+
+    // the warnings of the visitor
+    std::string check(std::vector<symbol_c*> elements) {
+        return warnings_of([&](case_elements_check_c& case_elements_check) {
+            case_statement(elements)->accept(case_elements_check);
+        });
+    }
+
+    template<typename function_t>
+    static std::string warnings_of(function_t run) {
+        case_elements_check_c case_elements_check(nullptr);
+        testing::internal::CaptureStderr();
+        run(case_elements_check);
+        return testing::internal::GetCapturedStderr();
+    }
+
+    static std::string warning(int line1, int line2, const char* message) {
+        return "(null):" + std::to_string(line1) + "-0.." + std::to_string(line2) + "-0: warning: " + message + "\n";
+    }
+
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+private:
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
+TEST_F(CaseElementsCheckTest, ReportsOverlapsInOptionOrder) {
+    const char* ranges = "Elements in CASE options have overlapping ranges.";
+    const char* within = "Element in CASE option falls within range of another element.";
+    const char* duplicate = "Duplicate element found in CASE options.";
+    std::string output = check({value(1), range(0, 8), value(15), range(10, 20), value(1), value(-2), range(-3, -1),
+                                value(30), range(25, 22), range(19, 25)});
+    EXPECT_EQ(output, warning(1, 2, within) + warning(1, 5, duplicate) + warning(3, 4, within) + warning(4, 10, ranges) +
+                          warning(6, 7, within) + warning(9, 10, ranges));
+}
+
+TEST_F(CaseElementsCheckTest, NoWarningsForDistinctOptions) {
+    std::vector<symbol_c*> elements;
+    for (int i = 0; i < 2000; i++) elements.push_back((i % 2) ? value(3 * i) : range(3 * i, 3 * i + 1));
+    elements.push_back(keep(new identifier_c("RED")));
+    elements.push_back(keep(new identifier_c("GREEN")));
+    EXPECT_EQ(check(elements), "");
+}
+
+TEST_F(CaseElementsCheckTest, DuplicateIdentifiers) {
+    EXPECT_EQ(check({keep(new identifier_c("RED")), value(1), keep(new identifier_c("red"))}),
+              warning(1, 3, "Duplicate element found in CASE options."));
+}
+
+TEST_F(CaseElementsCheckTest, IndexAlsoReachesCaseInsideElse) {
+    // CASE X OF 1: ; ELSE CASE X OF 2: ; 2: ; END_CASE; END_CASE
+    statement_list_c* else_list = keep(new statement_list_c());
+    else_list->add_element(case_statement({value(2), value(2)}));
+    case_statement_c* outer = case_statement({value(1)}, else_list);
+
+    // the visitor never looks into the ELSE branch of a CASE
+    EXPECT_EQ(warnings_of([&](case_elements_check_c& check) { outer->accept(check); }), "");
+    EXPECT_EQ(warnings_of([&](case_elements_check_c& check) { check.check(outer); }),
+              warning(1, 2, "Duplicate element found in CASE options."));
+}
+
+TEST_F(CaseElementsCheckTest, LibraryIndexIsSharedByItsElements) {
+    library_c library;
+    std::vector<symbol_c*> pous;
+    for (int64_t v : {3, 4}) {
+        statement_list_c* body = keep(new statement_list_c());
+        body->add_element(case_statement({value(v), value(v)}));
+        pous.push_back(keep(new function_declaration_c(keep(new identifier_c("F")), nullptr, nullptr, body)));
+        library.add_element(pous.back());
+    }
+
+    case_elements_check_c::enter_library(&library);
+    // each element only reports its own CASE statements
+    std::string first = warnings_of([&](case_elements_check_c& check) { check.check(pous[0]); });
+    std::string second = warnings_of([&](case_elements_check_c& check) { check.check(pous[1]); });
+    case_elements_check_c::leave_library();
+
+    EXPECT_EQ(first, warning(1, 2, "Duplicate element found in CASE options."));
+    EXPECT_EQ(second, first);
+}
+
+TEST_F(CaseElementsCheckTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
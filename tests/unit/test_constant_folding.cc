@@ -4,25 +4,77 @@
  *  Unit tests for typed constant folding annotations.
  */
 
+#include <memory>
 #include <variant>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "absyntax_utils/absyntax_utils.hh"
 #include "matiec/types/typed_const_value.hpp"
+#include "stage3/constant_folding.hh"
 #include "stage3/modern_semantic_annotations.hh"
 
+namespace {
+
+// An IL instruction list, with the prev/next links filled in by hand
+// (as flow_control_analysis_c would have done).
+class IlConstantFoldingTest : public ::testing::Test {
+protected:
+    il_instruction_c* add(symbol_c* operation) {
+        il_instruction_c* instruction = keep(new il_instruction_c(nullptr, operation));
+        if (list_.n > 0) link(dynamic_cast<il_instruction_c*>(list_.get_element(list_.n - 1)), instruction);
+        list_.add_element(instruction);
+        return instruction;
+    }
+
+    il_instruction_c* load(const char* value) {
+        return add(keep(new il_simple_operation_c(keep(new LD_operator_c()), keep(new integer_c(value)))));
+    }
+    il_instruction_c* store() {
+        return add(keep(new il_simple_operation_c(keep(new ST_operator_c()),
+                                                  keep(new symbolic_variable_c(keep(new identifier_c("X")))))));
+    }
+    il_instruction_c* jump(symbol_c* jump_operator, il_instruction_c* destination) {
+        il_instruction_c* instruction = add(keep(new il_jump_operation_c(jump_operator, keep(new identifier_c("L")))));
+        link(instruction, destination);
+        return instruction;
+    }
+
+    static void link(il_instruction_c* prev, il_instruction_c* next) {
+        next->prev_il_instruction.push_back(prev);
+        prev->next_il_instruction.push_back(next);
+    }
+
+    void fold() {
+        constant_folding_c constant_folding;
+        list_.accept(constant_folding);
+    }
+
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+    instruction_list_c list_;
+
+private:
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
 TEST(ConstantFoldingTest, TypedConstValueUsesLegacyInt) {
     symbol_c symbol;
     symbol.datatype = &get_datatype_info_c::int_type_name;
     symbol.const_value.m_int64.set(42);
 
-    matiec::stage3::populate_modern_annotations(&symbol);
-
-    EXPECT_EQ(symbol.const_value_modern.status, matiec::types::ConstValueStatus::Value);
-    EXPECT_EQ(std::get<int64_t>(symbol.const_value_modern.value), 42);
-    ASSERT_NE(symbol.const_value_modern.type, nullptr);
-    EXPECT_EQ(symbol.const_value_modern.type->name(), "INT");
+    EXPECT_EQ(symbol.get_const_value_modern().status, matiec::types::ConstValueStatus::Value);
+    EXPECT_EQ(std::get<int64_t>(symbol.get_const_value_modern().value), 42);
+    const auto* type = matiec::stage3::modern_type_registry().type(symbol.get_const_value_modern().type);
+    ASSERT_NE(type, nullptr);
+    EXPECT_EQ(type->name(), "INT");
 }
 
 TEST(ConstantFoldingTest, TypedConstValueTracksOverflow) {
@@ -30,9 +82,40 @@ TEST(ConstantFoldingTest, TypedConstValueTracksOverflow) {
     symbol.datatype = &get_datatype_info_c::dint_type_name;
     symbol.const_value.m_int64.set_overflow();
 
-    matiec::stage3::populate_modern_annotations(&symbol);
+    EXPECT_EQ(symbol.get_const_value_modern().status, matiec::types::ConstValueStatus::Overflow);
+}
+
+TEST_F(IlConstantFoldingTest, BackwardJumpKeepsTheSameValue) {
+    //     LD 5
+    // L:  ST X
+    //     JMP L
+    load("5");
+    il_instruction_c* destination = store();
+    il_instruction_c* jmp = jump(keep(new JMP_operator_c()), destination);
+    fold();
+
+    EXPECT_TRUE(destination->const_value.m_int64.is_valid());
+    EXPECT_EQ(destination->const_value.m_int64.get(), 5);
+    EXPECT_TRUE(jmp->const_value.m_int64.is_valid());
+    EXPECT_EQ(jmp->const_value.m_uint64.get(), 5u);
+}
+
+TEST_F(IlConstantFoldingTest, BackwardJumpWithAnotherValue) {
+    //     LD 5
+    // L:  ST X
+    //     LD 6
+    //     JMPC L
+    //     ST X
+    load("5");
+    il_instruction_c* destination = store();
+    load("6");
+    jump(keep(new JMPC_operator_c()), destination);
+    il_instruction_c* last = store();
+    fold();
 
-    EXPECT_EQ(symbol.const_value_modern.status, matiec::types::ConstValueStatus::Overflow);
+    EXPECT_TRUE(destination->const_value.m_int64.is_nonconst());
+    EXPECT_TRUE(last->const_value.m_int64.is_valid());
+    EXPECT_EQ(last->const_value.m_int64.get(), 6);
 }
 
 TEST(ConstantFoldingTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
@@ -0,0 +1,104 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the constant propagation of the ST statements.
+ *
+ *  The constant propagation of variables (DO_CONSTANT_PROPAGATION__) is disabled
+ *  in the compiler, so this test is built with its own copy of constant_folding.cc,
+ *  with the algorithm enabled (see tests/CMakeLists.txt).
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "absyntax_utils/absyntax_utils.hh"
+#include "stage3/constant_folding.hh"
+
+static_assert(DO_CONSTANT_PROPAGATION__, "test_constant_propagation must be built with DO_CONSTANT_PROPAGATION__ defined to 1");
+
+namespace {
+
+// The body of FUNCTION F, ending with "Z := X;", so the value of X after the statements can be checked.
+class ConstantPropagationTest : public ::testing::Test {
+protected:
+    symbol_c* variable(const char* name) {
+        return keep(new symbolic_variable_c(keep(new identifier_c(name))));
+    }
+    symbol_c* assign(const char* name, const char* value) {
+        return keep(new assignment_statement_c(variable(name), keep(new integer_c(value))));
+    }
+    statement_list_c* statements(std::vector<symbol_c*> list) {
+        statement_list_c* statement_list = keep(new statement_list_c());
+        for (symbol_c* statement : list) statement_list->add_element(statement);
+        return statement_list;
+    }
+    // IF C THEN <then_list> [ELSE <else_list>] END_IF;
+    symbol_c* if_statement(statement_list_c* then_list, statement_list_c* else_list) {
+        return keep(new if_statement_c(variable("C"), then_list, keep(new elseif_statement_list_c()), else_list));
+    }
+
+    // The value of X after running the statements, as seen by "Z := X;".
+    const_value_c::const_value__<int64_t> value_of_x(std::vector<symbol_c*> list) {
+        assignment_statement_c* read_x = keep(new assignment_statement_c(variable("Z"), variable("X")));
+        list.push_back(read_x);
+        function_declaration_c* function = keep(new function_declaration_c(
+            keep(new identifier_c("F")), nullptr, keep(new var_declarations_list_c()), statements(list)));
+
+        constant_propagation_c constant_propagation(function);
+        function->accept(constant_propagation);
+        return read_x->l_exp->const_value.m_int64;
+    }
+
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+private:
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
+TEST_F(ConstantPropagationTest, AssignedValueIsPropagated) {
+    auto value = value_of_x({assign("X", "7")});
+    ASSERT_TRUE(value.is_valid());
+    EXPECT_EQ(value.get(), 7);
+}
+
+TEST_F(ConstantPropagationTest, BranchesAssigningTheSameValueKeepIt) {
+    auto value = value_of_x({if_statement(statements({assign("X", "1")}), statements({assign("X", "1")}))});
+    ASSERT_TRUE(value.is_valid());
+    EXPECT_EQ(value.get(), 1);
+}
+
+TEST_F(ConstantPropagationTest, BranchesAssigningDistinctValuesAreNotConstant) {
+    auto value = value_of_x({if_statement(statements({assign("X", "1")}), statements({assign("X", "2")}))});
+    EXPECT_TRUE(value.is_nonconst());
+}
+
+TEST_F(ConstantPropagationTest, IfWithoutElseJoinsTheIncomingValue) {
+    auto changed = value_of_x({assign("X", "1"), if_statement(statements({assign("X", "2")}), nullptr)});
+    EXPECT_TRUE(changed.is_nonconst());
+
+    // the variables not assigned to in the branch keep their value
+    auto kept = value_of_x({assign("X", "1"), if_statement(statements({assign("Y", "2")}), nullptr)});
+    ASSERT_TRUE(kept.is_valid());
+    EXPECT_EQ(kept.get(), 1);
+}
+
+TEST_F(ConstantPropagationTest, LoopBodyIsJoinedWithTheIncomingValue) {
+    symbol_c* loop = keep(new while_statement_c(variable("C"), statements({assign("X", "2")})));
+    auto value = value_of_x({assign("X", "1"), loop});
+    EXPECT_TRUE(value.is_nonconst());
+}
+
+TEST(ConstantPropagationLinkTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
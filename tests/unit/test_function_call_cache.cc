@@ -0,0 +1,124 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the memoized overload resolution of function invocations.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+#include "stage3/function_call_cache.hh"
+
+namespace {
+
+class FunctionCallCacheTest : public ::testing::Test {
+protected:
+    // <name>(<value>, ...), each value having the given candidate datatypes.
+    function_invocation_c* nonformal_call(const char* name, std::vector<std::vector<symbol_c*>> values) {
+        param_assignment_list_c* list = keep(new param_assignment_list_c());
+        for (const std::vector<symbol_c*>& datatypes : values) list->add_element(value(datatypes));
+        return keep(new function_invocation_c(keep(new identifier_c(name)), nullptr, list));
+    }
+
+    // <name>(<param> := <value>, ...), or => for output parameters.
+    function_invocation_c* formal_call(const char* name, std::vector<std::pair<const char*, bool>> params,
+                                       symbol_c* datatype) {
+        param_assignment_list_c* list = keep(new param_assignment_list_c());
+        for (const std::pair<const char*, bool>& param : params) {
+            symbol_c* param_name = keep(new identifier_c(param.first));
+            if (param.second)
+                list->add_element(keep(new output_variable_param_assignment_c(nullptr, param_name, value({datatype}))));
+            else
+                list->add_element(keep(new input_variable_param_assignment_c(param_name, value({datatype}))));
+        }
+        return keep(new function_invocation_c(keep(new identifier_c(name)), list, nullptr));
+    }
+
+    static std::string signature(function_invocation_c* call) {
+        generic_function_call_t fcall_data = {
+            call->function_name, call->nonformal_param_list, call->formal_param_list,
+            generic_function_call_t::POU_function, call->candidate_functions,
+            call->called_function_declaration, call->extensible_param_count};
+        return function_call_cache_c::signature(call, fcall_data);
+    }
+
+    int_type_name_c int_type_;
+    real_type_name_c real_type_;
+
+private:
+    symbol_c* value(const std::vector<symbol_c*>& datatypes) {
+        symbol_c* result = keep(new integer_c("1"));
+        for (symbol_c* datatype : datatypes) result->candidate_datatypes.push_back(datatype);
+        return result;
+    }
+
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
+TEST_F(FunctionCallCacheTest, SameCallShapeHasTheSameSignature) {
+    EXPECT_EQ(signature(nonformal_call("ADD", {{&int_type_}, {&int_type_}})),
+              signature(nonformal_call("add", {{&int_type_}, {&int_type_}})));
+    EXPECT_EQ(signature(formal_call("LIMIT", {{"MN", false}, {"in", false}}, &int_type_)),
+              signature(formal_call("limit", {{"mn", false}, {"IN", false}}, &int_type_)));
+}
+
+TEST_F(FunctionCallCacheTest, SignatureCoversNameShapeAndDatatypes) {
+    std::vector<std::string> signatures = {
+        signature(nonformal_call("ADD", {{&int_type_}, {&int_type_}})),
+        signature(nonformal_call("MUL", {{&int_type_}, {&int_type_}})),
+        signature(nonformal_call("ADD", {{&int_type_}, {&real_type_}})),
+        signature(nonformal_call("ADD", {{&int_type_}, {&int_type_, &real_type_}})),
+        signature(nonformal_call("ADD", {{&int_type_, &real_type_}, {&int_type_}})),
+        signature(nonformal_call("ADD", {{&int_type_}, {&int_type_}, {&int_type_}})),
+        signature(formal_call("ADD", {{"IN1", false}, {"IN2", false}}, &int_type_)),
+        signature(formal_call("ADD", {{"IN2", false}, {"IN1", false}}, &int_type_)),
+        signature(formal_call("ADD", {{"IN1", false}, {"IN2", true}}, &int_type_)),
+    };
+    for (size_t i = 0; i < signatures.size(); i++)
+        for (size_t j = i + 1; j < signatures.size(); j++)
+            EXPECT_NE(signatures[i], signatures[j]) << i << " vs " << j;
+}
+
+TEST_F(FunctionCallCacheTest, OnlyCachesWhileEnabled) {
+    function_call_cache_c cache;
+    function_declaration_c add_int(nullptr, nullptr, nullptr, nullptr);
+    function_call_cache_c::overloads_t overloads;
+
+    cache.insert("ADD", {&add_int});
+    EXPECT_FALSE(cache.lookup("ADD", overloads));
+
+    cache.enable();
+    EXPECT_TRUE(cache.enabled());
+    cache.insert("ADD", {&add_int});
+    cache.insert("SUB", {});
+    ASSERT_TRUE(cache.lookup("ADD", overloads));
+    EXPECT_EQ(overloads, (function_call_cache_c::overloads_t{&add_int}));
+    ASSERT_TRUE(cache.lookup("SUB", overloads));
+    EXPECT_TRUE(overloads.empty());
+    EXPECT_EQ(cache.size(), 2u);
+
+    // the cached declarations must not outlive the library being analysed
+    cache.disable();
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_FALSE(cache.lookup("ADD", overloads));
+}
+
+TEST_F(FunctionCallCacheTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
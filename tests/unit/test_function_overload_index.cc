@@ -0,0 +1,151 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the function overload index.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+
+namespace {
+
+// Builds FUNCTION <name> : <ret> VAR_INPUT <params> : <type>; END_VAR END_FUNCTION
+// (or an extensible IN 1.. parameter), keeping all nodes alive for the test.
+class function_builder_c {
+public:
+    function_declaration_c* make(const char* name, symbol_c* type, int param_count, bool extensible = false) {
+        var1_list_c* names = keep(new var1_list_c());
+        if (extensible) {
+            names->add_element(keep(new extensible_input_parameter_c(keep(new identifier_c("IN")),
+                                                                     keep(new integer_c("1")))));
+        } else {
+            static const char* param_names[] = {"IN1", "IN2", "IN3"};
+            for (int i = 0; i < param_count; i++) names->add_element(keep(new identifier_c(param_names[i])));
+        }
+        var1_init_decl_c* decl = keep(new var1_init_decl_c(names, keep(new simple_spec_init_c(type, nullptr))));
+        input_declaration_list_c* decl_list = keep(new input_declaration_list_c());
+        decl_list->add_element(decl);
+        var_declarations_list_c* var_decls = keep(new var_declarations_list_c());
+        var_decls->add_element(keep(new input_declarations_c(nullptr, decl_list, nullptr)));
+        return keep(new function_declaration_c(keep(new identifier_c(name)), type, var_decls, nullptr));
+    }
+
+private:
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+class FunctionOverloadIndexTest : public ::testing::Test {
+protected:
+    void TearDown() override { absyntax_utils_reset(); }
+
+    std::vector<function_declaration_c*> candidates(const char* name, symbol_c* first_value, int nf_count) {
+        identifier_c function_name(name);
+        std::vector<function_declaration_c*> result;
+        function_overload_index.nonformal_candidates(&function_name, first_value, nf_count, result);
+        return result;
+    }
+
+    function_builder_c builder_;
+    int_type_name_c int_type_;
+    real_type_name_c real_type_;
+    generic_type_any_c any_type_;
+};
+
+} // namespace
+
+TEST_F(FunctionOverloadIndexTest, SelectsOverloadsByFirstParamDatatype) {
+    function_declaration_c* add_int = builder_.make("ADD", &int_type_, 2);
+    function_declaration_c* add_real = builder_.make("ADD", &real_type_, 2);
+    function_declaration_c* add_any = builder_.make("add", &any_type_, 2);
+    library_c library;
+    library.add_element(add_int);
+    library.add_element(add_real);
+    library.add_element(add_any);
+    absyntax_utils_init(&library);
+
+    integer_c value("1");
+    value.candidate_datatypes.push_back(&int_type_);
+    std::vector<function_declaration_c*> result = candidates("Add", &value, 2);
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0], add_int);
+    EXPECT_EQ(result[1], add_any);
+
+    // Overloads keep the function_symtable order, whatever the order of the candidate datatypes.
+    value.candidate_datatypes.clear();
+    value.candidate_datatypes.push_back(&real_type_);
+    value.candidate_datatypes.push_back(&int_type_);
+    result = candidates("ADD", &value, 2);
+    ASSERT_EQ(result.size(), 3u);
+    EXPECT_EQ(result[0], add_int);
+    EXPECT_EQ(result[1], add_real);
+    EXPECT_EQ(result[2], add_any);
+}
+
+TEST_F(FunctionOverloadIndexTest, AnyValueOrNoParametersSelectsEveryOverload) {
+    function_declaration_c* f_int = builder_.make("F", &int_type_, 1);
+    function_declaration_c* f_real = builder_.make("F", &real_type_, 1);
+    library_c library;
+    library.add_element(f_int);
+    library.add_element(f_real);
+    absyntax_utils_init(&library);
+
+    integer_c value("1");
+    value.candidate_datatypes.push_back(&any_type_);
+    EXPECT_EQ(candidates("F", &value, 1).size(), 2u);
+    EXPECT_EQ(candidates("F", nullptr, 0).size(), 2u);
+
+    // a value with no valid candidate datatypes cannot match any overload
+    integer_c untyped("2");
+    EXPECT_TRUE(candidates("F", &untyped, 1).empty());
+}
+
+TEST_F(FunctionOverloadIndexTest, FiltersOnArity) {
+    function_declaration_c* two = builder_.make("MUX", &int_type_, 2);
+    function_declaration_c* three = builder_.make("MUX", &int_type_, 3);
+    function_declaration_c* ext = builder_.make("MUX", &int_type_, 0, true);
+    library_c library;
+    library.add_element(two);
+    library.add_element(three);
+    library.add_element(ext);
+    absyntax_utils_init(&library);
+
+    integer_c value("1");
+    value.candidate_datatypes.push_back(&int_type_);
+    EXPECT_EQ(candidates("MUX", &value, 2).size(), 3u);
+
+    std::vector<function_declaration_c*> result = candidates("MUX", &value, 3);
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0], three);
+    EXPECT_EQ(result[1], ext);
+
+    result = candidates("MUX", &value, 7);
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0], ext);
+}
+
+TEST_F(FunctionOverloadIndexTest, ResetClearsTheIndex) {
+    library_c library;
+    library.add_element(builder_.make("G", &int_type_, 1));
+    absyntax_utils_init(&library);
+    EXPECT_EQ(candidates("G", nullptr, 0).size(), 1u);
+
+    absyntax_utils_reset();
+    EXPECT_TRUE(candidates("G", nullptr, 0).empty());
+}
+
+TEST_F(FunctionOverloadIndexTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
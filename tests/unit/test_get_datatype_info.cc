@@ -0,0 +1,176 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the datatype category predicates of get_datatype_info_c.
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+
+namespace {
+
+typedef bool (*predicate_t)(symbol_c*);
+
+struct elementary_t {
+    symbol_c* type;
+    std::string name; // without the SAFE prefix
+    bool safe;
+};
+
+// the (non safe, safe, compatible) variants of a predicate, and the types it holds for
+struct predicate_family_t {
+    const char* family;
+    predicate_t plain;
+    predicate_t safe;
+    predicate_t compatible;
+    std::set<std::string> names;
+};
+
+std::vector<elementary_t> elementary_types() {
+    typedef get_datatype_info_c info;
+    return {
+        {&info::bool_type_name, "BOOL", false},   {&info::safebool_type_name, "BOOL", true},
+        {&info::byte_type_name, "BYTE", false},   {&info::safebyte_type_name, "BYTE", true},
+        {&info::word_type_name, "WORD", false},   {&info::safeword_type_name, "WORD", true},
+        {&info::dword_type_name, "DWORD", false}, {&info::safedword_type_name, "DWORD", true},
+        {&info::lword_type_name, "LWORD", false}, {&info::safelword_type_name, "LWORD", true},
+        {&info::sint_type_name, "SINT", false},   {&info::safesint_type_name, "SINT", true},
+        {&info::int_type_name, "INT", false},     {&info::safeint_type_name, "INT", true},
+        {&info::dint_type_name, "DINT", false},   {&info::safedint_type_name, "DINT", true},
+        {&info::lint_type_name, "LINT", false},   {&info::safelint_type_name, "LINT", true},
+        {&info::usint_type_name, "USINT", false}, {&info::safeusint_type_name, "USINT", true},
+        {&info::uint_type_name, "UINT", false},   {&info::safeuint_type_name, "UINT", true},
+        {&info::udint_type_name, "UDINT", false}, {&info::safeudint_type_name, "UDINT", true},
+        {&info::ulint_type_name, "ULINT", false}, {&info::safeulint_type_name, "ULINT", true},
+        {&info::real_type_name, "REAL", false},   {&info::safereal_type_name, "REAL", true},
+        {&info::lreal_type_name, "LREAL", false}, {&info::safelreal_type_name, "LREAL", true},
+        {&info::time_type_name, "TIME", false},   {&info::safetime_type_name, "TIME", true},
+        {&info::date_type_name, "DATE", false},   {&info::safedate_type_name, "DATE", true},
+        {&info::tod_type_name, "TOD", false},     {&info::safetod_type_name, "TOD", true},
+        {&info::dt_type_name, "DT", false},       {&info::safedt_type_name, "DT", true},
+        {&info::string_type_name, "STRING", false}, {&info::safestring_type_name, "STRING", true},
+        {&info::wstring_type_name, "WSTRING", false}, {&info::safewstring_type_name, "WSTRING", true},
+    };
+}
+
+std::vector<predicate_family_t> predicate_families() {
+    typedef get_datatype_info_c info;
+    const std::set<std::string> signed_int = {"SINT", "INT", "DINT", "LINT"};
+    const std::set<std::string> unsigned_int = {"USINT", "UINT", "UDINT", "ULINT"};
+    const std::set<std::string> real = {"REAL", "LREAL"};
+    const std::set<std::string> nbit = {"BYTE", "WORD", "DWORD", "LWORD"};
+    const std::set<std::string> date = {"DATE", "TOD", "DT"};
+    const std::set<std::string> string = {"STRING", "WSTRING"};
+    auto join = [](std::vector<std::set<std::string>> sets) {
+        std::set<std::string> result;
+        for (const std::set<std::string>& set : sets) result.insert(set.begin(), set.end());
+        return result;
+    };
+    const std::set<std::string> any_int = join({signed_int, unsigned_int});
+    const std::set<std::string> any_num = join({any_int, real});
+    const std::set<std::string> any_bit = join({nbit, {"BOOL"}});
+    const std::set<std::string> magnitude = join({any_num, {"TIME"}});
+    return {
+        {"ELEMENTARY", info::is_ANY_ELEMENTARY, info::is_ANY_SAFEELEMENTARY, info::is_ANY_ELEMENTARY_compatible,
+         join({magnitude, any_bit, date, string})},
+        {"MAGNITUDE", info::is_ANY_MAGNITUDE, info::is_ANY_SAFEMAGNITUDE, info::is_ANY_MAGNITUDE_compatible, magnitude},
+        {"signed_MAGNITUDE", info::is_ANY_signed_MAGNITUDE, info::is_ANY_signed_SAFEMAGNITUDE,
+         info::is_ANY_signed_MAGNITUDE_compatible, join({signed_int, real, {"TIME"}})},
+        {"NUM", info::is_ANY_NUM, info::is_ANY_SAFENUM, info::is_ANY_NUM_compatible, any_num},
+        {"signed_NUM", info::is_ANY_signed_NUM, info::is_ANY_signed_SAFENUM, info::is_ANY_signed_NUM_compatible,
+         join({signed_int, real})},
+        {"INT", info::is_ANY_INT, info::is_ANY_SAFEINT, info::is_ANY_INT_compatible, any_int},
+        {"signed_INT", info::is_ANY_signed_INT, info::is_ANY_signed_SAFEINT, info::is_ANY_signed_INT_compatible, signed_int},
+        {"unsigned_INT", info::is_ANY_unsigned_INT, info::is_ANY_unsigned_SAFEINT, info::is_ANY_unsigned_INT_compatible,
+         unsigned_int},
+        {"REAL", info::is_ANY_REAL, info::is_ANY_SAFEREAL, info::is_ANY_REAL_compatible, real},
+        {"nBIT", info::is_ANY_nBIT, info::is_ANY_SAFEnBIT, info::is_ANY_nBIT_compatible, nbit},
+        {"BOOL", info::is_BOOL, info::is_SAFEBOOL, info::is_BOOL_compatible, {"BOOL"}},
+        {"BIT", info::is_ANY_BIT, info::is_ANY_SAFEBIT, info::is_ANY_BIT_compatible, any_bit},
+        {"DATE", info::is_ANY_DATE, info::is_ANY_SAFEDATE, info::is_ANY_DATE_compatible, date},
+        {"TIME", info::is_TIME, info::is_SAFETIME, info::is_TIME_compatible, {"TIME"}},
+        {"STRING", info::is_ANY_STRING, info::is_ANY_SAFESTRING, info::is_ANY_STRING_compatible, string},
+    };
+}
+
+} // namespace
+
+TEST(GetDatatypeInfoTest, ElementaryTypeCategories) {
+    for (const predicate_family_t& family : predicate_families()) {
+        for (const elementary_t& type : elementary_types()) {
+            const bool member = (family.names.count(type.name) > 0);
+            const std::string what = std::string(family.family) + " / " + (type.safe ? "SAFE" : "") + type.name;
+            EXPECT_EQ(family.plain(type.type), member && !type.safe) << what;
+            EXPECT_EQ(family.safe(type.type), member && type.safe) << what;
+            EXPECT_EQ(family.compatible(type.type), member) << what;
+        }
+        EXPECT_FALSE(family.compatible(nullptr)) << family.family;
+        EXPECT_FALSE(family.compatible(&get_datatype_info_c::invalid_type_name)) << family.family;
+    }
+}
+
+TEST(GetDatatypeInfoTest, NonElementaryTypes) {
+    void_type_name_c void_type;
+    integer_c integer("1");
+    real_c real("1.0");
+    generic_type_any_c any;
+    array_specification_c array(nullptr, &get_datatype_info_c::int_type_name);
+    structure_element_declaration_list_c structure;
+    enumerated_value_list_c enumeration;
+    subrange_specification_c subrange(&get_datatype_info_c::int_type_name, nullptr);
+    ref_spec_c ref(&get_datatype_info_c::int_type_name);
+    function_block_declaration_c fb(nullptr, nullptr, nullptr);
+    initial_step_c initial_step(nullptr, nullptr);
+    step_c step(nullptr, nullptr);
+
+    EXPECT_TRUE(get_datatype_info_c::is_VOID(&void_type));
+    EXPECT_FALSE(get_datatype_info_c::is_ANY_ELEMENTARY_compatible(&void_type));
+    EXPECT_TRUE(get_datatype_info_c::is_ANY_INT_literal(&integer));
+    EXPECT_FALSE(get_datatype_info_c::is_ANY_INT_literal(&real));
+    EXPECT_TRUE(get_datatype_info_c::is_ANY_REAL_literal(&real));
+    EXPECT_TRUE(get_datatype_info_c::is_ANY_REAL_literal(nullptr));
+    EXPECT_FALSE(get_datatype_info_c::is_ANY_INT(&integer));
+    EXPECT_TRUE(get_datatype_info_c::is_ANY_generic_type(&any));
+    EXPECT_TRUE(get_datatype_info_c::is_array(&array));
+    EXPECT_TRUE(get_datatype_info_c::is_structure(&structure));
+    EXPECT_TRUE(get_datatype_info_c::is_enumerated(&enumeration));
+    EXPECT_TRUE(get_datatype_info_c::is_subrange(&subrange));
+    EXPECT_TRUE(get_datatype_info_c::is_ref_to(&ref));
+    EXPECT_TRUE(get_datatype_info_c::is_function_block(&fb));
+    EXPECT_TRUE(get_datatype_info_c::is_sfc_initstep(&initial_step));
+    EXPECT_TRUE(get_datatype_info_c::is_sfc_step(&initial_step));
+    EXPECT_TRUE(get_datatype_info_c::is_sfc_step(&step));
+    EXPECT_FALSE(get_datatype_info_c::is_sfc_initstep(&step));
+    EXPECT_FALSE(get_datatype_info_c::is_array(&structure));
+    EXPECT_FALSE(get_datatype_info_c::is_structure(&get_datatype_info_c::int_type_name));
+    EXPECT_FALSE(get_datatype_info_c::is_type_valid(&get_datatype_info_c::invalid_type_name));
+    EXPECT_FALSE(get_datatype_info_c::is_type_valid(nullptr));
+}
+
+TEST(GetDatatypeInfoTest, TypeEquality) {
+    int_type_name_c another_int;
+    array_specification_c array(nullptr, &get_datatype_info_c::int_type_name);
+    ref_spec_c ref(&get_datatype_info_c::int_type_name);
+    ref_spec_c another_ref(&another_int);
+
+    EXPECT_TRUE(get_datatype_info_c::is_type_equal(&get_datatype_info_c::int_type_name, &another_int));
+    EXPECT_FALSE(get_datatype_info_c::is_type_equal(&get_datatype_info_c::int_type_name, &get_datatype_info_c::safeint_type_name));
+    EXPECT_TRUE(get_datatype_info_c::is_type_equal(&array, &array));
+    EXPECT_TRUE(get_datatype_info_c::is_type_equal(&ref, &ref));
+    EXPECT_TRUE(get_datatype_info_c::is_type_equal(&ref, &another_ref));
+    EXPECT_FALSE(get_datatype_info_c::is_type_equal(&ref, &array));
+    EXPECT_FALSE(get_datatype_info_c::is_type_equal(&get_datatype_info_c::invalid_type_name, &get_datatype_info_c::invalid_type_name));
+    EXPECT_FALSE(get_datatype_info_c::is_type_equal(nullptr, nullptr));
+}
+
+TEST(GetDatatypeInfoTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <filesystem>
 #include <string>
+#include <vector>
 
 namespace fs = std::filesystem;
 using namespace matiec::test;
@@ -100,6 +101,7 @@ TEST(MatiecOptionsTest, InitSetsDefaults) {
     EXPECT_FALSE(opts.disable_implicit_en_eno);
     EXPECT_FALSE(opts.conversion_functions);
     EXPECT_FALSE(opts.full_token_location);
+    EXPECT_EQ(opts.max_errors, 0);
 }
 
 TEST(MatiecOptionsTest, InitHandlesNullPointer) {
@@ -339,6 +341,107 @@ TEST_F(MatiecApiTest, SupportsMultipleCompilesInOneProcess) {
     }
 }
 
+// =============================================================================
+// AST memory statistics tests
+// =============================================================================
+
+TEST_F(MatiecApiTest, AstStatsReportsNodeClassesWithoutGeneratingCode) {
+    TempDir temp;
+    auto file = temp.path() / "stats.st";
+    ASSERT_TRUE(writeFile(file, samples::MINIMAL_PROGRAM));
+    std::string output_dir_str = temp.path().string();
+    opts_.output_dir = output_dir_str.c_str();
+
+    char* report = nullptr;
+    std::string file_str = file.string();
+    auto result = matiec_ast_stats_file(file_str.c_str(), &opts_, &result_, &report);
+
+    EXPECT_EQ(result, MATIEC_OK) << "Error: " << (result_.error_message ? result_.error_message : "none");
+    ASSERT_NE(report, nullptr);
+    EXPECT_THAT(report, ::testing::HasSubstr("AST memory:"));
+    EXPECT_THAT(report, ::testing::HasSubstr("program_declaration_c"));
+    matiec_string_free(report);
+
+    EXPECT_FALSE(fs::exists(temp.path() / "POUS.c"));
+}
+
+TEST_F(MatiecApiTest, AstStatsRejectsNullReport) {
+    TempDir temp;
+    auto file = temp.path() / "stats.st";
+    ASSERT_TRUE(writeFile(file, samples::MINIMAL_PROGRAM));
+
+    std::string file_str = file.string();
+    EXPECT_EQ(matiec_ast_stats_file(file_str.c_str(), &opts_, &result_, nullptr), MATIEC_ERROR_INVALID_ARG);
+}
+
+// =============================================================================
+// Check-only tests
+// =============================================================================
+
+TEST_F(MatiecApiTest, CheckReportsErrorsWithoutGeneratingCode) {
+    TempDir temp;
+    std::string output_dir_str = temp.path().string();
+    opts_.output_dir = output_dir_str.c_str();
+
+    auto result = matiec_check_string(samples::MINIMAL_PROGRAM, 0, "test.st", nullptr, &opts_, &result_);
+    EXPECT_EQ(result, MATIEC_OK) << "Error: " << (result_.error_message ? result_.error_message : "none");
+    EXPECT_EQ(result_.output_file_count, 0);
+    matiec_result_free(&result_);
+
+    result = matiec_check_string(samples::TYPE_ERROR, 0, "test.st", nullptr, &opts_, &result_);
+    EXPECT_EQ(result, MATIEC_ERROR_SEMANTIC);
+    EXPECT_GT(result_.error_line, 0);
+
+    EXPECT_FALSE(fs::exists(temp.path() / "POUS.c"));
+}
+
+TEST_F(MatiecApiTest, CheckOnlyAnalysesTheNamedPou) {
+    // the program calls a function with an error in its body
+    const std::string source = std::string(R"(
+FUNCTION broken : INT
+VAR_INPUT
+    x : INT;
+END_VAR
+VAR
+    y : STRING;
+END_VAR
+    broken := y;
+END_FUNCTION
+)") + R"(
+PROGRAM caller
+VAR
+    z : INT;
+END_VAR
+    z := broken(x := 1);
+END_PROGRAM
+)";
+
+    std::vector<std::string> errors;
+    matiec_set_error_callback([](const char*, int, int, const char* message, void* user_data) {
+        static_cast<std::vector<std::string>*>(user_data)->push_back(message);
+    }, &errors);
+
+    EXPECT_EQ(matiec_check_string(source.c_str(), 0, "test.st", "CALLER", &opts_, &result_), MATIEC_OK)
+        << "Error: " << (result_.error_message ? result_.error_message : "none");
+    EXPECT_TRUE(errors.empty());
+    matiec_result_free(&result_);
+
+    EXPECT_EQ(matiec_check_string(source.c_str(), 0, "test.st", "broken", &opts_, &result_), MATIEC_ERROR_SEMANTIC);
+    EXPECT_FALSE(errors.empty());
+    matiec_result_free(&result_);
+
+    // a POU that is not declared (any more): check everything
+    errors.clear();
+    EXPECT_EQ(matiec_check_string(source.c_str(), 0, "test.st", "renamed", &opts_, &result_), MATIEC_ERROR_SEMANTIC);
+    EXPECT_FALSE(errors.empty());
+
+    matiec_set_error_callback(nullptr, nullptr);
+}
+
+TEST_F(MatiecApiTest, CheckFileRejectsNullResult) {
+    EXPECT_EQ(matiec_check_file("test.st", nullptr, &opts_, nullptr), MATIEC_ERROR_INVALID_ARG);
+}
+
 // =============================================================================
 // Result cleanup tests
 // =============================================================================
@@ -0,0 +1,173 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the scoped symbol table with shared copies.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "util/persistent_symtable.hh"
+
+namespace {
+
+typedef persistent_symtable_c<int> table_t;
+
+int value_of(const table_t& table, const char* name) {
+    const int* value = table.find_value(name);
+    return (value != nullptr) ? *value : -1;
+}
+
+// meet used by the join tests: equal values are kept, distinct values become 0
+int meet(int v1, int v2) {
+    return (v1 == v2) ? v1 : 0;
+}
+
+} // namespace
+
+TEST(PersistentSymtableTest, LookupIgnoresCase) {
+    table_t table;
+    table["Counter"] = 3;
+
+    EXPECT_EQ(table.count("COUNTER"), 1);
+    EXPECT_EQ(value_of(table, "counter"), 3);
+    EXPECT_EQ(table.count("other"), 0);
+    EXPECT_EQ(table.find_value("other"), nullptr);
+}
+
+TEST(PersistentSymtableTest, CopiesDoNotSeeEachOthersWrites) {
+    table_t original;
+    original["a"] = 1;
+    original["b"] = 2;
+
+    table_t copy = original;
+    copy["a"] = 10;
+    copy["c"] = 30;
+    original["b"] = 20;
+
+    EXPECT_EQ(value_of(original, "a"), 1);
+    EXPECT_EQ(value_of(original, "b"), 20);
+    EXPECT_EQ(original.count("c"), 0);
+
+    EXPECT_EQ(value_of(copy, "a"), 10);
+    EXPECT_EQ(value_of(copy, "b"), 2);
+    EXPECT_EQ(value_of(copy, "c"), 30);
+}
+
+TEST(PersistentSymtableTest, ForksDoNotSeeEachOthersWrites) {
+    table_t original;
+    original["a"] = 1;
+    original["b"] = 2;
+
+    table_t fork = original.fork();
+    fork["a"] = 10;
+    fork["c"] = 30;
+    original["b"] = 20;
+
+    EXPECT_EQ(value_of(original, "a"), 1);
+    EXPECT_EQ(value_of(original, "b"), 20);
+    EXPECT_EQ(original.count("c"), 0);
+
+    EXPECT_EQ(value_of(fork, "a"), 10);
+    EXPECT_EQ(value_of(fork, "b"), 2);
+    EXPECT_EQ(value_of(fork, "c"), 30);
+}
+
+TEST(PersistentSymtableTest, ManyForksKeepValues) {
+    // Sequential forks (e.g. a long list of IF statements) must not lose or mix up entries.
+    table_t table;
+    for (int i = 0; i < 200; i++) {
+        table_t fork = table.fork();
+        table["v" + std::to_string(i)] = i;
+        table["shared"] = i;
+        EXPECT_EQ(fork.count("v" + std::to_string(i)), 0);
+    }
+    for (int i = 0; i < 200; i++) {
+        EXPECT_EQ(value_of(table, ("v" + std::to_string(i)).c_str()), i);
+    }
+    EXPECT_EQ(value_of(table, "shared"), 199);
+}
+
+TEST(PersistentSymtableTest, ScopesFollowSymtableRules) {
+    table_t table;
+    table["x"] = 1;
+    table.push();
+    table["y"] = 2;           // new entries go to the outer most scope, as in symtable_c
+    EXPECT_EQ(table.count("y"), 1);
+
+    table_t copy = table;
+    EXPECT_EQ(table.pop(), 0);
+    EXPECT_EQ(value_of(table, "x"), 1);
+    EXPECT_EQ(copy.count("x"), 1);
+    EXPECT_EQ(table.pop(), 1);
+    EXPECT_EQ(table.count("x"), 0);
+    EXPECT_EQ(value_of(copy, "x"), 1);
+}
+
+TEST(PersistentSymtableTest, LeftJoinOfBranches) {
+    table_t incoming;
+    incoming["same"] = 1;
+    incoming["then_only"] = 2;
+    incoming["both"] = 3;
+    incoming["untouched"] = 4;
+
+    table_t then_branch = incoming.fork();
+    then_branch["then_only"] = 20;
+    then_branch["both"] = 30;
+    then_branch["same"] = 1;
+    then_branch["new_in_then"] = 50;
+
+    table_t else_branch = incoming.fork();
+    else_branch["both"] = 31;
+    else_branch["new_in_else"] = 60;
+
+    table_t joined = table_t::left_join(then_branch, else_branch, meet);
+    EXPECT_EQ(value_of(joined, "same"), 1);
+    EXPECT_EQ(value_of(joined, "then_only"), 0);
+    EXPECT_EQ(value_of(joined, "both"), 0);
+    EXPECT_EQ(value_of(joined, "untouched"), 4);
+    EXPECT_EQ(value_of(joined, "new_in_then"), 50);
+    EXPECT_EQ(joined.count("new_in_else"), 0);   // left join: only the entries of the first table
+
+    // the joined tables are left unchanged
+    EXPECT_EQ(value_of(then_branch, "both"), 30);
+    EXPECT_EQ(value_of(else_branch, "both"), 31);
+}
+
+TEST(PersistentSymtableTest, LeftJoinOnlyVisitsEntriesWrittenSinceTheFork) {
+    table_t incoming;
+    incoming["changed"] = 1;
+    incoming["untouched"] = 2;
+
+    table_t then_branch = incoming.fork();
+    table_t else_branch = incoming.fork();
+    // forking the branches again must not merge their writes into the (small) layer they share
+    then_branch["changed"] = 10;
+    then_branch["added"] = 30;
+    table_t nested_then = then_branch.fork();
+    else_branch["changed"] = 11;
+    table_t nested_else = else_branch.fork();
+
+    int visited = 0;
+    table_t joined = table_t::left_join(then_branch, else_branch, [&](int v1, int v2) {
+        visited++;
+        return meet(v1, v2);
+    });
+    EXPECT_EQ(visited, 1);
+    EXPECT_EQ(value_of(joined, "changed"), 0);
+    EXPECT_EQ(value_of(joined, "untouched"), 2);
+    EXPECT_EQ(value_of(joined, "added"), 30);
+}
+
+TEST(PersistentSymtableTest, LeftJoinOfUnrelatedTables) {
+    table_t t1, t2;
+    t1["a"] = 1;
+    t1["b"] = 2;
+    t2["a"] = 1;
+    t2["b"] = 5;
+
+    table_t joined = table_t::left_join(t1, t2, meet);
+    EXPECT_EQ(value_of(joined, "a"), 1);
+    EXPECT_EQ(value_of(joined, "b"), 0);
+}
@@ -0,0 +1,176 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the base types cached on type identifiers by
+ *  search_base_type_c::cache_basetypes().
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+
+namespace {
+
+class SearchBaseTypeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        absyntax_utils_reset();
+
+        // TYPE
+        //   INT1 : INT;  INT2 : INT1 := 2;
+        //   SUB1 : INT (4..10);  SUB2 : SUB1 := 5;  SUB3 : SUB2;
+        //   COLOURS : (RED, GREEN);  COLOURS2 : COLOURS;
+        //   BROKEN : MISSING;
+        // END_TYPE
+        type_declaration_list_c* types = keep(new type_declaration_list_c());
+        int1_spec_ = keep(new simple_spec_init_c(&int_type_, nullptr));
+        types->add_element(keep(new simple_type_declaration_c(id("INT1"), int1_spec_)));
+        alias(types, "INT2", id("int1"));
+        subrange_spec_ = keep(new subrange_specification_c(&int_type_, keep(new subrange_c(keep(new integer_c("4")), keep(new integer_c("10"))))));
+        sub1_init_ = keep(new subrange_spec_init_c(subrange_spec_, nullptr));
+        types->add_element(keep(new subrange_type_declaration_c(id("SUB1"), sub1_init_)));
+        alias(types, "SUB2", id("sub1"));
+        alias(types, "SUB3", id("SUB2"));
+        enumerated_value_list_c* values = keep(new enumerated_value_list_c());
+        values->add_element(keep(new identifier_c("RED")));
+        values->add_element(keep(new identifier_c("GREEN")));
+        colours_decl_ = keep(new enumerated_type_declaration_c(id("COLOURS"), keep(new enumerated_spec_init_c(values, nullptr))));
+        types->add_element(colours_decl_);
+        alias(types, "COLOURS2", id("colours"));
+        missing_ = id("MISSING");
+        alias(types, "BROKEN", missing_);
+
+        // TYPE U_int2 : int2; U_SUB3 : SUB3; U_colours2 : colours2; U_FB1 : FB1; END_TYPE
+        type_declaration_list_c* uses = keep(new type_declaration_list_c());
+        for (const char* name : {"int2", "SUB3", "colours2"}) {
+            ids_.push_back(id(name));
+            alias(uses, (std::string("U_") + name).c_str(), ids_.back());
+        }
+        ids_.push_back(keep(new poutype_identifier_c("FB1")));
+        alias(uses, "U_FB1", ids_.back());
+
+        library_.add_element(keep(new data_type_declaration_c(types)));
+        library_.add_element(keep(new data_type_declaration_c(uses)));
+        library_.add_element(keep(new function_block_declaration_c(keep(new identifier_c("FB1")), keep(new var_declarations_list_c()), nullptr)));
+    }
+
+    void TearDown() override { absyntax_utils_reset(); }
+
+    struct result_t {
+        symbol_c* basetype_decl;
+        symbol_c* basetype_id;
+        symbol_c* equivtype_decl;
+
+        bool operator==(const result_t& other) const {
+            return (basetype_decl == other.basetype_decl) && (basetype_id == other.basetype_id) &&
+                   (equivtype_decl == other.equivtype_decl);
+        }
+    };
+
+    // drop the cached base type, so the next search walks the declarations
+    static void uncache(token_c* symbol) {
+        if (derived_datatype_identifier_c* identifier = dynamic_cast<derived_datatype_identifier_c*>(symbol))
+            identifier->basetype_decl = nullptr;
+        if (poutype_identifier_c* identifier = dynamic_cast<poutype_identifier_c*>(symbol))
+            identifier->basetype_decl = nullptr;
+    }
+
+    static result_t search(symbol_c* symbol) {
+        return {search_base_type_c::get_basetype_decl(symbol), search_base_type_c::get_basetype_id(symbol),
+                search_base_type_c::get_equivtype_decl(symbol)};
+    }
+
+    derived_datatype_identifier_c* id(const char* name) { return keep(new derived_datatype_identifier_c(name)); }
+
+    int_type_name_c int_type_;
+    real_type_name_c real_type_;
+    integer_c one_{"1"};
+    integer_c two_{"2"};
+    simple_spec_init_c* int1_spec_ = nullptr;
+    subrange_specification_c* subrange_spec_ = nullptr;
+    subrange_spec_init_c* sub1_init_ = nullptr;
+    enumerated_type_declaration_c* colours_decl_ = nullptr;
+    derived_datatype_identifier_c* missing_ = nullptr;
+    std::vector<token_c*> ids_;
+    library_c library_;
+
+    void alias(type_declaration_list_c* types, const char* name, symbol_c* type) {
+        types->add_element(keep(new simple_type_declaration_c(id(name), keep(new simple_spec_init_c(type, nullptr)))));
+    }
+
+private:
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
+TEST_F(SearchBaseTypeTest, CachedBaseTypesMatchTheWalk) {
+    absyntax_utils_init(&library_);
+    std::vector<result_t> cached;
+    for (token_c* identifier : ids_) cached.push_back(search(identifier));
+
+    for (token_c* identifier : ids_) uncache(identifier);
+    for (size_t i = 0; i < ids_.size(); i++) EXPECT_EQ(search(ids_[i]), cached[i]) << ids_[i]->value;
+
+    EXPECT_EQ(cached[0].basetype_decl, &int_type_);
+    EXPECT_EQ(cached[0].equivtype_decl, &int_type_);
+    EXPECT_EQ(cached[1].basetype_decl, &int_type_);
+    EXPECT_EQ(cached[1].equivtype_decl, sub1_init_);
+    EXPECT_EQ(cached[2].basetype_decl, colours_decl_);
+    EXPECT_EQ(cached[3].basetype_decl, library_.get_element(2));
+}
+
+TEST_F(SearchBaseTypeTest, EquivalentTypeOfSubranges) {
+    absyntax_utils_init(&library_);
+    // U_SUB3 : SUB3 has the subrange of SUB1 as its equivalent type...
+    symbol_c* u_sub3_init = dynamic_cast<simple_type_declaration_c*>(dynamic_cast<list_c*>(
+        dynamic_cast<data_type_declaration_c*>(library_.get_element(1))->type_declaration_list)->get_element(1))->simple_spec_init;
+    EXPECT_EQ(search_base_type_c::get_equivtype_decl(u_sub3_init), sub1_init_);
+    // ...whereas an anonymous SUB3 (1..2) is its own equivalent type
+    subrange_c range(&one_, &two_);
+    subrange_specification_c specification(ids_[1], &range);
+    subrange_spec_init_c anonymous(&specification, nullptr);
+    EXPECT_EQ(search_base_type_c::get_equivtype_decl(&anonymous), &anonymous);
+
+    // the same, once SUB3 is no longer cached
+    uncache(ids_[1]);
+    EXPECT_EQ(search_base_type_c::get_equivtype_decl(u_sub3_init), sub1_init_);
+    EXPECT_EQ(search_base_type_c::get_equivtype_decl(&anonymous), &anonymous);
+}
+
+TEST_F(SearchBaseTypeTest, UndeclaredTypesAreLeftUncached) {
+    // BROKEN : MISSING must not stop the other identifiers from being cached
+    absyntax_utils_init(&library_);
+    EXPECT_EQ(missing_->decl, nullptr);
+    EXPECT_EQ(missing_->basetype_decl, nullptr);
+    EXPECT_EQ(dynamic_cast<derived_datatype_identifier_c*>(ids_[0])->basetype_decl, &int_type_);
+}
+
+TEST_F(SearchBaseTypeTest, ReinitialisingDropsTheCachedBaseTypes) {
+    absyntax_utils_init(&library_);
+    EXPECT_EQ(search_base_type_c::get_basetype_decl(ids_[0]), &int_type_);
+
+    // TYPE INT1 : REAL; END_TYPE
+    int1_spec_->simple_specification = &real_type_;
+    absyntax_utils_reset();
+    absyntax_utils_init(&library_);
+    EXPECT_EQ(search_base_type_c::get_basetype_decl(ids_[0]), &real_type_);
+    int1_spec_->simple_specification = &int_type_;
+}
+
+TEST_F(SearchBaseTypeTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
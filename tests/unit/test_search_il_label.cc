@@ -0,0 +1,93 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the label index of search_il_label_c, and the jumps
+ *  linked by flow_control_analysis_c using it.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+#include "stage3/flow_control_analysis.hh"
+
+namespace {
+
+class SearchIlLabelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        //        LD  1
+        // L1:    ST  X
+        // l2:    JMP l1
+        // L1:    JMP L2     (a duplicate label, the first one wins)
+        //        JMPC MISSING
+        load_ = add(nullptr, keep(new il_simple_operation_c(keep(new LD_operator_c()), keep(new integer_c("1")))));
+        l1_ = add("L1", keep(new il_simple_operation_c(keep(new ST_operator_c()),
+                                                       keep(new symbolic_variable_c(keep(new identifier_c("X")))))));
+        l2_ = add("l2", jump(keep(new JMP_operator_c()), "l1"));
+        duplicate_ = add("L1", jump(keep(new JMP_operator_c()), "L2"));
+        missing_ = add(nullptr, jump(keep(new JMPC_operator_c()), "MISSING"));
+        fb_ = keep(new function_block_declaration_c(keep(new identifier_c("FB1")), keep(new var_declarations_list_c()), &list_));
+    }
+
+    il_instruction_c* add(const char* label, symbol_c* operation) {
+        il_instruction_c* instruction =
+            keep(new il_instruction_c((nullptr == label) ? nullptr : keep(new identifier_c(label)), operation));
+        list_.add_element(instruction);
+        return instruction;
+    }
+
+    symbol_c* jump(symbol_c* jump_operator, const char* label) {
+        return keep(new il_jump_operation_c(jump_operator, keep(new identifier_c(label))));
+    }
+
+    il_instruction_c* load_ = nullptr;
+    il_instruction_c* l1_ = nullptr;
+    il_instruction_c* l2_ = nullptr;
+    il_instruction_c* duplicate_ = nullptr;
+    il_instruction_c* missing_ = nullptr;
+    function_block_declaration_c* fb_ = nullptr;
+    instruction_list_c list_;
+
+private:
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
+TEST_F(SearchIlLabelTest, FindsLabelsCaseInsensitively) {
+    search_il_label_c search(fb_);
+    identifier_c l1("l1");
+    EXPECT_EQ(search.find_label(&l1), l1_);
+    EXPECT_EQ(search.find_label("L2"), l2_);
+    EXPECT_EQ(search.find_label("MISSING"), nullptr);
+    EXPECT_EQ(search.find_label((symbol_c*)nullptr), nullptr);
+}
+
+TEST_F(SearchIlLabelTest, LinksJumpsToTheirLabels) {
+    flow_control_analysis_c flow_control_analysis(nullptr);
+    fb_->accept(flow_control_analysis);
+
+    // the instruction in the previous line comes first, followed by the jumps
+    EXPECT_EQ(l1_->prev_il_instruction, (std::vector<symbol_c*>{load_, l2_}));
+    EXPECT_EQ(l2_->prev_il_instruction, (std::vector<symbol_c*>{l1_, duplicate_}));
+    EXPECT_EQ(duplicate_->prev_il_instruction, (std::vector<symbol_c*>{}));
+    EXPECT_EQ(missing_->prev_il_instruction, (std::vector<symbol_c*>{}));
+    EXPECT_EQ(l2_->next_il_instruction, (std::vector<symbol_c*>{l1_}));
+    EXPECT_EQ(missing_->next_il_instruction, (std::vector<symbol_c*>{}));
+}
+
+TEST_F(SearchIlLabelTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
@@ -0,0 +1,138 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the index of the variable declarations of each scope
+ *  used by search_var_instance_decl_c.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+
+namespace {
+
+class SearchVarInstanceDeclTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        absyntax_utils_reset();
+
+        // FUNCTION_BLOCK FB1
+        //   VAR_INPUT IN1, IN2 : INT; END_VAR
+        //   VAR CONSTANT K : REAL; END_VAR
+        //   VAR_EXTERNAL G : INT; END_VAR
+        //   VAR IN2 : REAL; END_VAR   (a duplicate, the first declaration wins)
+        // END_FUNCTION_BLOCK
+        in_spec_ = keep(new simple_spec_init_c(&int_type_, nullptr));
+        k_spec_ = keep(new simple_spec_init_c(&real_type_, nullptr));
+        input_declaration_list_c* inputs = keep(new input_declaration_list_c());
+        inputs->add_element(keep(new var1_init_decl_c(names({"IN1", "IN2"}), in_spec_)));
+        var_init_decl_list_c* constants = keep(new var_init_decl_list_c());
+        constants->add_element(keep(new var1_init_decl_c(names({"K"}), k_spec_)));
+        external_declaration_list_c* externals = keep(new external_declaration_list_c());
+        externals->add_element(keep(new external_declaration_c(keep(new identifier_c("G")), &int_type_)));
+        var_init_decl_list_c* duplicates = keep(new var_init_decl_list_c());
+        duplicates->add_element(keep(new var1_init_decl_c(names({"IN2"}), k_spec_)));
+
+        var_declarations_list_c* fb_vars = keep(new var_declarations_list_c());
+        fb_vars->add_element(keep(new input_declarations_c(nullptr, inputs, nullptr)));
+        fb_vars->add_element(keep(new var_declarations_c(keep(new constant_option_c()), constants)));
+        fb_vars->add_element(keep(new external_var_declarations_c(nullptr, externals)));
+        fb_vars->add_element(keep(new var_declarations_c(nullptr, duplicates)));
+        fb_ = keep(new function_block_declaration_c(keep(new identifier_c("FB1")), fb_vars, nullptr));
+
+        // CONFIGURATION C1 VAR_GLOBAL G : INT; END_VAR ... END_CONFIGURATION
+        global_var_list_c* global_names = keep(new global_var_list_c());
+        global_names->add_element(keep(new identifier_c("G")));
+        global_var_decl_list_c* globals = keep(new global_var_decl_list_c());
+        globals->add_element(keep(new global_var_decl_c(global_names, in_spec_)));
+        configuration_ = keep(new configuration_declaration_c(
+            keep(new identifier_c("C1")), keep(new global_var_declarations_c(nullptr, globals)), nullptr, nullptr, nullptr));
+
+        library_.add_element(fb_);
+        library_.add_element(configuration_);
+    }
+
+    void TearDown() override { absyntax_utils_reset(); }
+
+    struct result_t {
+        symbol_c* decl;
+        search_var_instance_decl_c::vt_t vartype;
+        search_var_instance_decl_c::opt_t option;
+
+        bool operator==(const result_t& other) const {
+            return (decl == other.decl) && (vartype == other.vartype) && (option == other.option);
+        }
+    };
+
+    static result_t search(symbol_c* scope, const char* name) {
+        identifier_c variable(name);
+        search_var_instance_decl_c search_decl(scope);
+        return {search_decl.get_decl(&variable), search_decl.get_vartype(&variable), search_decl.get_option(&variable)};
+    }
+
+    int_type_name_c int_type_;
+    real_type_name_c real_type_;
+    simple_spec_init_c* in_spec_ = nullptr;
+    simple_spec_init_c* k_spec_ = nullptr;
+    function_block_declaration_c* fb_ = nullptr;
+    configuration_declaration_c* configuration_ = nullptr;
+    library_c library_;
+
+private:
+    var1_list_c* names(std::vector<const char*> list) {
+        var1_list_c* result = keep(new var1_list_c());
+        for (const char* name : list) result->add_element(keep(new identifier_c(name)));
+        return result;
+    }
+
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
+TEST_F(SearchVarInstanceDeclTest, IndexFindsWhatTheWalkFinds) {
+    const std::vector<std::pair<symbol_c*, const char*>> queries = {
+        {fb_, "IN1"}, {fb_, "in2"}, {fb_, "K"}, {fb_, "g"}, {fb_, "MISSING"}, {fb_, "FB1"},
+        {configuration_, "G"}, {configuration_, "K"},
+    };
+
+    // before absyntax_utils_init() the declarations are walked...
+    std::vector<result_t> walked;
+    for (const auto& query : queries) walked.push_back(search(query.first, query.second));
+
+    // ...and afterwards looked up in the index
+    absyntax_utils_init(&library_);
+    for (size_t i = 0; i < queries.size(); i++)
+        EXPECT_EQ(search(queries[i].first, queries[i].second), walked[i]) << queries[i].second;
+
+    EXPECT_EQ(search(fb_, "in2"), (result_t{in_spec_, search_var_instance_decl_c::input_vt, search_var_instance_decl_c::none_opt}));
+    EXPECT_EQ(search(fb_, "K"), (result_t{k_spec_, search_var_instance_decl_c::private_vt, search_var_instance_decl_c::constant_opt}));
+    EXPECT_EQ(search(fb_, "G"), (result_t{&int_type_, search_var_instance_decl_c::external_vt, search_var_instance_decl_c::none_opt}));
+    EXPECT_EQ(search(fb_, "MISSING"), (result_t{nullptr, search_var_instance_decl_c::none_vt, search_var_instance_decl_c::none_opt}));
+    EXPECT_EQ(search(configuration_, "G"), (result_t{in_spec_, search_var_instance_decl_c::global_vt, search_var_instance_decl_c::none_opt}));
+}
+
+TEST_F(SearchVarInstanceDeclTest, ResetDropsTheIndex) {
+    absyntax_utils_init(&library_);
+    absyntax_utils_reset();
+    // the walk is used once again (and finds the same declarations)
+    EXPECT_EQ(search(fb_, "K").decl, k_spec_);
+    EXPECT_EQ(search(fb_, "MISSING").decl, nullptr);
+}
+
+TEST_F(SearchVarInstanceDeclTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
@@ -0,0 +1,125 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the resolution (and caching) of the fields of structured
+ *  variables by search_varfb_instance_type_c.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+
+namespace {
+
+class SearchVarfbInstanceTypeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        absyntax_utils_reset();
+
+        // TYPE S : STRUCT A : INT; B : REAL; END_STRUCT; END_TYPE
+        a_spec_ = keep(new simple_spec_init_c(&int_type_, nullptr));
+        b_spec_ = keep(new simple_spec_init_c(&real_type_, nullptr));
+        structure_element_declaration_list_c* elements = keep(new structure_element_declaration_list_c());
+        a_decl_ = keep(new structure_element_declaration_c(keep(new identifier_c("A")), a_spec_));
+        elements->add_element(a_decl_);
+        elements->add_element(keep(new structure_element_declaration_c(keep(new identifier_c("B")), b_spec_)));
+        type_declaration_list_c* types = keep(new type_declaration_list_c());
+        types->add_element(keep(new structure_type_declaration_c(keep(new derived_datatype_identifier_c("S")), elements)));
+
+        // FUNCTION_BLOCK FB1 VAR_INPUT IN : INT; END_VAR END_FUNCTION_BLOCK
+        fb1_ = make_fb("FB1", "IN", keep(new simple_spec_init_c(&int_type_, nullptr)));
+        // FUNCTION_BLOCK FB2 VAR V : S; END_VAR VAR T : FB1; END_VAR END_FUNCTION_BLOCK
+        fb2_ = make_fb("FB2", "V", keep(new simple_spec_init_c(keep(new derived_datatype_identifier_c("s")), nullptr)));
+        function_block_declaration_c* t_decl = make_fb("", "T", keep(new simple_spec_init_c(keep(new poutype_identifier_c("fb1")), nullptr)));
+        dynamic_cast<list_c*>(fb2_->var_declarations)->add_element(dynamic_cast<list_c*>(t_decl->var_declarations)->get_element(0));
+
+        library_.add_element(keep(new data_type_declaration_c(types)));
+        library_.add_element(fb1_);
+        library_.add_element(fb2_);
+    }
+
+    void TearDown() override { absyntax_utils_reset(); }
+
+    // <record>.<field>
+    symbol_c* field(const char* record, const char* field_name) {
+        return keep(new structured_variable_c(keep(new symbolic_variable_c(keep(new identifier_c(record)))),
+                                              keep(new identifier_c(field_name))));
+    }
+
+    int_type_name_c int_type_;
+    real_type_name_c real_type_;
+    simple_spec_init_c* a_spec_ = nullptr;
+    simple_spec_init_c* b_spec_ = nullptr;
+    structure_element_declaration_c* a_decl_ = nullptr;
+    function_block_declaration_c* fb1_ = nullptr;
+    function_block_declaration_c* fb2_ = nullptr;
+    library_c library_;
+
+private:
+    function_block_declaration_c* make_fb(const char* name, const char* var_name, symbol_c* spec) {
+        var1_list_c* names = keep(new var1_list_c());
+        names->add_element(keep(new identifier_c(var_name)));
+        var_init_decl_list_c* decls = keep(new var_init_decl_list_c());
+        decls->add_element(keep(new var1_init_decl_c(names, spec)));
+        var_declarations_list_c* vars = keep(new var_declarations_list_c());
+        vars->add_element(keep(new var_declarations_c(nullptr, decls)));
+        return keep(new function_block_declaration_c(keep(new identifier_c(name)), vars, nullptr));
+    }
+
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
+TEST_F(SearchVarfbInstanceTypeTest, ResolvesStructureFieldsRepeatedly) {
+    absyntax_utils_init(&library_);
+    search_varfb_instance_type_c search(fb2_);
+    // the second (cached) resolution of each field must give the same result as the first
+    for (int round = 0; round < 2; round++) {
+        EXPECT_EQ(search.get_type_id(field("V", "A")), a_spec_);
+        EXPECT_EQ(search.get_basetype_decl(field("v", "b")), &real_type_);
+        EXPECT_EQ(search.get_type_id(field("V", "MISSING")), nullptr);
+    }
+    // another search object, for another scope, shares the resolved fields
+    search_varfb_instance_type_c other(fb2_);
+    EXPECT_EQ(other.get_type_id(field("V", "B")), b_spec_);
+}
+
+TEST_F(SearchVarfbInstanceTypeTest, ResolvesFunctionBlockFields) {
+    absyntax_utils_init(&library_);
+    search_varfb_instance_type_c search(fb2_);
+    for (int round = 0; round < 2; round++) {
+        EXPECT_EQ(search.get_basetype_decl(field("t", "in")), &int_type_);
+        EXPECT_EQ(search.get_type_id(field("T", "IN2")), nullptr);
+    }
+}
+
+TEST_F(SearchVarfbInstanceTypeTest, ReinitialisingDropsTheResolvedFields) {
+    absyntax_utils_init(&library_);
+    search_varfb_instance_type_c search(fb2_);
+    EXPECT_EQ(search.get_type_id(field("V", "A")), a_spec_);
+
+    // the same structure declaration, now with another type for A
+    simple_spec_init_c new_a_spec(&real_type_, nullptr);
+    a_decl_->spec_init = &new_a_spec;
+    absyntax_utils_reset();
+    absyntax_utils_init(&library_);
+    EXPECT_EQ(search_varfb_instance_type_c(fb2_).get_type_id(field("V", "A")), &new_a_spec);
+    a_decl_->spec_init = a_spec_;
+}
+
+TEST_F(SearchVarfbInstanceTypeTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
@@ -13,10 +13,13 @@
 
 namespace {
 
-bool has_type(const std::vector<std::shared_ptr<const matiec::types::Type>>& types,
-              std::string_view name) {
-    return std::any_of(types.begin(), types.end(), [&](const auto& type) {
-        return type && type->name() == name;
+const matiec::types::Type* modern_type(matiec::types::TypeId id) {
+    return matiec::stage3::modern_type_registry().type(id);
+}
+
+bool has_type(const std::vector<matiec::types::TypeId>& types, std::string_view name) {
+    return std::any_of(types.begin(), types.end(), [&](matiec::types::TypeId id) {
+        return modern_type(id) && modern_type(id)->name() == name;
     });
 }
 
@@ -29,14 +32,49 @@ TEST(SemanticCandidatesTest, FiltersIncompatibleCandidates) {
     symbol.candidate_datatypes.push_back(&get_datatype_info_c::bool_type_name);
     symbol.datatype = &get_datatype_info_c::dint_type_name;
 
-    matiec::stage3::populate_modern_annotations(&symbol);
+    ASSERT_NE(modern_type(symbol.get_datatype_modern()), nullptr);
+    EXPECT_EQ(modern_type(symbol.get_datatype_modern())->name(), "DINT");
+
+    EXPECT_TRUE(has_type(symbol.get_candidate_types_modern(), "INT"));
+    EXPECT_TRUE(has_type(symbol.get_candidate_types_modern(), "DINT"));
+    EXPECT_FALSE(has_type(symbol.get_candidate_types_modern(), "BOOL"));
+}
+
+TEST(SemanticCandidatesTest, TypesAreStoredAsInternedIds) {
+    symbol_c symbol;
+    symbol.candidate_datatypes.push_back(&get_datatype_info_c::tod_type_name);
+    symbol.candidate_datatypes.push_back(&get_datatype_info_c::tod_type_name);
+    symbol.datatype = &get_datatype_info_c::tod_type_name;
+
+    // TOD is the same type as TIME_OF_DAY, and is listed only once
+    const auto& registry = matiec::stage3::modern_type_registry();
+    EXPECT_EQ(symbol.get_datatype_modern(), registry.findTypeId("time_of_day"));
+    ASSERT_EQ(symbol.get_candidate_types_modern().size(), 1u);
+    EXPECT_EQ(symbol.get_candidate_types_modern()[0], symbol.get_datatype_modern());
+
+    symbol.datatype = nullptr;
+    symbol.reset_modern_annotations();
+    EXPECT_EQ(symbol.get_datatype_modern(), matiec::types::kNoType);
+}
+
+TEST(SemanticCandidatesTest, AnnotationsAreDerivedOnFirstQuery) {
+    symbol_c symbol;
+    symbol.candidate_datatypes.push_back(&get_datatype_info_c::int_type_name);
+    symbol.datatype = &get_datatype_info_c::int_type_name;
+    symbol.const_value.m_int64.set(7);
+    EXPECT_FALSE(symbol.has_modern_annotations());
 
-    ASSERT_NE(symbol.datatype_modern, nullptr);
-    EXPECT_EQ(symbol.datatype_modern->name(), "DINT");
+    const auto int_id = matiec::stage3::modern_type_registry().findTypeId("INT");
+    EXPECT_EQ(symbol.get_datatype_modern(), int_id);
+    EXPECT_TRUE(symbol.has_modern_annotations());
+    ASSERT_EQ(symbol.get_candidate_types_modern().size(), 1u);
+    EXPECT_EQ(symbol.get_const_value_modern().type, int_id);
 
-    EXPECT_TRUE(has_type(symbol.candidate_types, "INT"));
-    EXPECT_TRUE(has_type(symbol.candidate_types, "DINT"));
-    EXPECT_FALSE(has_type(symbol.candidate_types, "BOOL"));
+    // cached until reset
+    symbol.datatype = &get_datatype_info_c::bool_type_name;
+    EXPECT_EQ(symbol.get_datatype_modern(), int_id);
+    symbol.reset_modern_annotations();
+    EXPECT_EQ(symbol.get_datatype_modern(), matiec::stage3::modern_type_registry().findTypeId("BOOL"));
 }
 
 TEST(SemanticCandidatesTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
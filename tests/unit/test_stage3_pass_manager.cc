@@ -0,0 +1,203 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the stage3 pass manager.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+#include "stage3/pass_manager.hh"
+#include "stage3/stage3_diagnostics.hh"
+
+namespace {
+
+using matiec::stage3::pass_manager_c;
+using matiec::stage3::pass_t;
+
+std::mutex log_mutex;
+std::vector<std::string> run_log;
+symbol_c* failing_element = nullptr;
+symbol_c* entered_library = nullptr;
+
+// Each test pass logs "<pass>:<element>" and reports one error on the element it visits.
+template<char pass_name>
+int test_pass(symbol_c* symbol) {
+    std::string entry = std::string(1, pass_name) + ":" + std::to_string(symbol->first_line);
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        run_log.push_back(entry);
+    }
+    if ((pass_name == 'B') && (symbol == failing_element)) throw std::runtime_error(entry);
+    matiec::stage3::report_error(matiec::ErrorCategory::Semantic, symbol, symbol, entry);
+    return 1;
+}
+
+void enter_library(symbol_c* library) {entered_library = library;}
+void leave_library(void) {run_log.push_back("leave");}
+
+pass_t make_pass(const char* name, int (*run)(symbol_c*), std::vector<std::string> depends_on, bool per_pou) {
+    pass_t pass = {name, run, depends_on};
+    pass.per_pou = per_pou;
+    return pass;
+}
+
+class PassManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        matiec::resetGlobalErrorReporter();
+        run_log.clear();
+        failing_element = nullptr;
+        entered_library = nullptr;
+        for (int i = 0; i < 4; i++) {
+            symbol_c* pou = (i == 2) ? static_cast<symbol_c*>(new configuration_declaration_c(nullptr, nullptr, nullptr, nullptr, nullptr))
+                                     : static_cast<symbol_c*>(new function_block_declaration_c(nullptr, nullptr, nullptr));
+            pou->first_line = i;
+            library_.add_element(pou);
+        }
+    }
+
+    void TearDown() override {
+        for (int i = 0; i < library_.n; i++) delete library_.get_element(i);
+        matiec::resetGlobalErrorReporter();
+    }
+
+    std::vector<std::string> reported() const {
+        std::vector<std::string> messages;
+        for (const matiec::CompilerError& error : matiec::globalErrorReporter().errors())
+            messages.push_back(error.message());
+        return messages;
+    }
+
+    library_c library_;
+};
+
+} // namespace
+
+TEST_F(PassManagerTest, FusesIndependentPerPouPasses) {
+    pass_manager_c passes;
+    passes.add(make_pass("A", test_pass<'A'>, {}, true));
+    passes.add(make_pass("B", test_pass<'B'>, {"A"}, true));
+    passes.add(make_pass("C", test_pass<'C'>, {"A"}, true));
+    passes.add(make_pass("D", test_pass<'D'>, {}, false));
+    passes.add(make_pass("E", test_pass<'E'>, {"D"}, true));
+
+    std::vector<std::vector<size_t>> traversals = passes.traversals();
+    ASSERT_EQ(traversals.size(), 4u);
+    EXPECT_EQ(traversals[0], (std::vector<size_t>{0}));
+    EXPECT_EQ(traversals[1], (std::vector<size_t>{1, 2}));
+    EXPECT_EQ(traversals[2], (std::vector<size_t>{3}));
+    EXPECT_EQ(traversals[3], (std::vector<size_t>{4}));
+}
+
+TEST_F(PassManagerTest, MissingDependencyIsAnInternalError) {
+    pass_manager_c passes;
+    EXPECT_ANY_THROW(passes.add(make_pass("A", test_pass<'A'>, {"B"}, true)));
+}
+
+TEST_F(PassManagerTest, FusedPassesReportInSequentialOrder) {
+    pass_manager_c passes;
+    passes.add(make_pass("B", test_pass<'B'>, {}, true));
+    passes.add(make_pass("C", test_pass<'C'>, {}, true));
+
+    for (unsigned int jobs : {1u, 3u}) {
+        matiec::resetGlobalErrorReporter();
+        run_log.clear();
+        EXPECT_EQ(passes.run(&library_, jobs), 8);
+        EXPECT_EQ(run_log.size(), 8u);
+        EXPECT_EQ(reported(), (std::vector<std::string>{"B:0", "B:1", "B:2", "B:3", "C:0", "C:1", "C:2", "C:3"}));
+    }
+
+    // each element goes through both passes before the next one (the configuration, element 2, last)
+    run_log.clear();
+    passes.run(&library_, 1);
+    EXPECT_EQ(run_log, (std::vector<std::string>{"B:0", "C:0", "B:1", "C:1", "B:3", "C:3", "B:2", "C:2"}));
+}
+
+TEST_F(PassManagerTest, FailureOnlyReportsWhatTheSequentialAnalysisWould) {
+    pass_manager_c passes;
+    passes.add(make_pass("A", test_pass<'A'>, {}, true));
+    passes.add(make_pass("B", test_pass<'B'>, {}, true));
+    passes.add(make_pass("C", test_pass<'C'>, {}, true));
+    failing_element = library_.get_element(1);
+
+    for (unsigned int jobs : {1u, 2u}) {
+        matiec::resetGlobalErrorReporter();
+        EXPECT_THROW(passes.run(&library_, jobs), std::runtime_error);
+        EXPECT_EQ(reported(), (std::vector<std::string>{"A:0", "A:1", "A:2", "A:3", "B:0"}));
+    }
+}
+
+TEST_F(PassManagerTest, TreeWithoutLibraryRunsEveryPassOnTheRoot) {
+    pass_manager_c passes;
+    passes.add(make_pass("B", test_pass<'B'>, {}, true));
+    passes.add(make_pass("C", test_pass<'C'>, {}, true));
+    symbol_c root;
+    root.first_line = 7;
+    EXPECT_EQ(passes.run(&root, 4), 2);
+    EXPECT_EQ(run_log, (std::vector<std::string>{"B:7", "C:7"}));
+}
+
+TEST_F(PassManagerTest, SelectedElementsAreAnalysedSeparately) {
+    pass_manager_c passes;
+    pass_t pass = make_pass("D", test_pass<'D'>, {}, false);
+    pass.enter_library = enter_library;
+    pass.leave_library = leave_library;
+    passes.add(pass);
+    passes.add(make_pass("A", test_pass<'A'>, {"D"}, true));
+
+    std::vector<symbol_c*> elements = {library_.get_element(3), library_.get_element(1)};
+    EXPECT_EQ(passes.run(&library_, elements, 1), 4);
+    // the pass that is not per POU runs on each of the elements, in the order given
+    EXPECT_EQ(run_log, (std::vector<std::string>{"D:3", "D:1", "leave", "A:3", "A:1"}));
+    EXPECT_EQ(reported(), (std::vector<std::string>{"D:3", "D:1", "A:3", "A:1"}));
+    EXPECT_EQ(entered_library, &library_);
+}
+
+TEST_F(PassManagerTest, ErrorBudgetStopsTheRemainingPasses) {
+    pass_manager_c passes;
+    passes.add(make_pass("A", test_pass<'A'>, {}, true));
+    passes.add(make_pass("B", test_pass<'B'>, {"A"}, true));
+    passes.add(make_pass("D", test_pass<'D'>, {"B"}, false));
+
+    for (unsigned int jobs : {1u, 3u}) {
+        matiec::resetGlobalErrorReporter();
+        matiec::globalErrorReporter().setMaxErrors(3);
+        run_log.clear();
+        // the errors of the first pass on the last element are neither reported nor counted
+        EXPECT_EQ(passes.run(&library_, jobs), 3);
+        EXPECT_EQ(reported(), (std::vector<std::string>{"A:0", "A:1", "A:2"}));
+        // passes B and D are not run at all
+        EXPECT_EQ(run_log.size(), 4u);
+    }
+}
+
+TEST_F(PassManagerTest, ErrorBudgetStopsAnalysingTheRemainingElements) {
+    pass_manager_c passes;
+    passes.add(make_pass("A", test_pass<'A'>, {}, true));
+    passes.add(make_pass("B", test_pass<'B'>, {}, true));  // fused with A
+
+    for (unsigned int jobs : {1u, 3u}) {
+        matiec::resetGlobalErrorReporter();
+        matiec::globalErrorReporter().setMaxErrors(2);
+        run_log.clear();
+        EXPECT_EQ(passes.run(&library_, jobs), 2);
+        EXPECT_EQ(reported(), (std::vector<std::string>{"A:0", "A:1"}));
+        // once the errors of the elements before them reach the maximum, the elements are not analysed
+        if (jobs == 1) {
+            EXPECT_EQ(run_log, (std::vector<std::string>{"A:0", "B:0", "A:1"}));
+        }
+    }
+}
+
+TEST_F(PassManagerTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
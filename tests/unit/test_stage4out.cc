@@ -0,0 +1,146 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the buffered output of stage 4 (including the files that are only
+ *  written when they change, and the dependency file), and for the buffering of
+ *  the stage 4 errors found while generating the POUs in parallel.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "test_utils.hh"
+#include "stage4/stage4.hh"
+
+using namespace matiec::test;
+
+namespace {
+
+// write to <dir>/OUT.c, and return what ends up in the file
+template<typename F>
+std::string generate(const TempDir& dir, F&& print) {
+    {
+        stage4out_c s4o(dir.path().string().c_str(), "OUT", "c");
+        print(s4o);
+    }
+    return readFile(dir.path() / "OUT.c").value_or("<missing>");
+}
+
+} // namespace
+
+TEST(Stage4OutTest, FormatsNumbersAsTheStreamsDid) {
+    TempDir dir;
+    std::string text = generate(dir, [](stage4out_c& s4o) {
+        s4o.print(-42); s4o.print(" ");
+        s4o.print(4294967295u); s4o.print(" ");
+        s4o.print(-9223372036854775807LL - 1); s4o.print(" ");
+        s4o.print_long_long_integer(18446744073709551615ULL); s4o.print(" ");
+        s4o.print_long_integer(7, false); s4o.print(" ");
+        s4o.print((real64_t)2.5); s4o.print(" ");
+        s4o.print((real64_t)1.0 / 3); s4o.print(" ");
+        s4o.print((real64_t)1e20);
+    });
+    EXPECT_EQ(text, "-42 4294967295 -9223372036854775808 18446744073709551615ULL 7 2.5 0.333333 1e+20");
+}
+
+TEST(Stage4OutTest, ConvertsIdentifiersAndLocations) {
+    TempDir dir;
+    std::string text = generate(dir, [](stage4out_c& s4o) {
+        s4o.printupper("my_Var1.x"); s4o.print(" ");
+        s4o.printlocation("ix0.1"); s4o.print(" ");
+        s4o.printlocation_comasep("qw2.3.4");
+    });
+    EXPECT_EQ(text, "MY_VAR1.X __IX0_1 Q,W,2,3,4");
+}
+
+TEST(Stage4OutTest, OutputLargerThanTheBuffer) {
+    TempDir dir;
+    const std::string big(3 * 1024 * 1024 + 17, 'a');
+    std::string text = generate(dir, [&](stage4out_c& s4o) {
+        s4o.print("<");
+        s4o.printupper(big);
+        s4o.print(big);
+        s4o.disable_output();
+        s4o.print("hidden");
+        s4o.enable_output();
+        s4o.print(">");
+    });
+    EXPECT_EQ(text, "<" + std::string(big.size(), 'A') + big + ">");
+}
+
+TEST(Stage4OutTest, UnchangedFilesAreNotRewritten) {
+    TempDir dir;
+    const std::filesystem::path path = dir.path() / "OUT.c";
+    ASSERT_EQ(generate(dir, [](stage4out_c& s4o) { s4o.print("int x;\n"); }), "int x;\n");
+
+    // pretend the file was generated long ago
+    const std::filesystem::file_time_type old_time = std::filesystem::last_write_time(path) - std::chrono::hours(24);
+    std::filesystem::last_write_time(path, old_time);
+    EXPECT_EQ(generate(dir, [](stage4out_c& s4o) { s4o.print("int x;\n"); }), "int x;\n");
+    EXPECT_EQ(std::filesystem::last_write_time(path), old_time);
+
+    // a longer, a different, and a shorter file are all written
+    EXPECT_EQ(generate(dir, [](stage4out_c& s4o) { s4o.print("int x;\nint y;\n"); }), "int x;\nint y;\n");
+    EXPECT_NE(std::filesystem::last_write_time(path), old_time);
+    EXPECT_EQ(generate(dir, [](stage4out_c& s4o) { s4o.print("int x;\nint z;\n"); }), "int x;\nint z;\n");
+    EXPECT_EQ(generate(dir, [](stage4out_c& s4o) { s4o.print("int x;"); }), "int x;");
+    EXPECT_EQ(generate(dir, [](stage4out_c&) {}), "");
+}
+
+TEST(Stage4OutTest, AnnouncedFilesAreTheDependencyTargets) {
+    TempDir dir;
+    const std::string build = dir.path().string();
+    stage4out_c::clear_announced_files();
+    { stage4out_c s4o(build.c_str(), "POUS", "c"); }
+    stage4out_c::announce(build.c_str(), "MY POU", "h");
+    ASSERT_EQ(stage4out_c::announced_files().size(), 2u);
+    EXPECT_EQ(stage4out_c::announced_files()[0], build + "/POUS.c");
+    EXPECT_EQ(stage4out_c::announced_files()[1], build + "/MY POU.h");
+
+    const std::string dep_file = (dir.path() / "plc.d").string();
+    ASSERT_EQ(stage4_write_dependency_file(dep_file.c_str(), stage4out_c::announced_files(), {"lib/ieclib.txt", "my plc.st"}), 0);
+    EXPECT_EQ(readFile(dep_file).value_or("<missing>"),
+              build + "/POUS.c " + build + "/MY\\ POU.h: \\\n"
+              " lib/ieclib.txt \\\n"
+              " my\\ plc.st\n"
+              "\n"
+              "lib/ieclib.txt:\n"
+              "\n"
+              "my\\ plc.st:\n");
+    stage4out_c::clear_announced_files();
+}
+
+TEST(Stage4OutTest, BufferedErrorsAreReportedOnFlush) {
+    matiec::resetGlobalErrorReporter();
+    stage4_error_buffer_c buffer;
+    {
+        scoped_stage4_error_buffer_c scope(&buffer);
+        stage4err("generate_c", NULL, NULL, "first %d", 1);
+        stage4err(NULL, NULL, NULL, "second");
+    }
+    EXPECT_EQ(matiec::globalErrorReporter().errorCount(), 0);
+
+    buffer.flush();
+    const std::vector<matiec::CompilerError>& errors = matiec::globalErrorReporter().errors();
+    ASSERT_EQ(errors.size(), 2u);
+    EXPECT_EQ(errors[0].message(), "generate_c: first 1");
+    EXPECT_EQ(errors[1].message(), "second");
+
+    // once the scope is gone, the errors are reported right away
+    stage4err(NULL, NULL, NULL, "third");
+    EXPECT_EQ(matiec::globalErrorReporter().errorCount(), 3);
+    buffer.flush();
+    EXPECT_EQ(matiec::globalErrorReporter().errorCount(), 3);
+    matiec::resetGlobalErrorReporter();
+}
+
+TEST(Stage4OutTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
@@ -0,0 +1,153 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the compile time evaluation of calls to standard functions.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+#include "stage3/standard_function_evaluators.hh"
+
+namespace {
+
+class StandardFunctionEvaluatorsTest : public ::testing::Test {
+protected:
+    // FUNCTION <name> : <type> ... END_FUNCTION
+    function_declaration_c* function(const char* name, symbol_c* type) {
+        return keep(new function_declaration_c(keep(new identifier_c(name)), type, nullptr, nullptr));
+    }
+
+    symbol_c* int_value(int64_t value) {
+        symbol_c* symbol = keep(new integer_c("0"));
+        symbol->const_value.m_int64.set(value);
+        if (value >= 0) symbol->const_value.m_uint64.set(value);
+        symbol->const_value.m_real64.set(value);
+        return symbol;
+    }
+
+    symbol_c* real_value(double value) {
+        symbol_c* symbol = keep(new real_c("0.0"));
+        symbol->const_value.m_real64.set(value);
+        return symbol;
+    }
+
+    // a variable, whose value is not known at compile time
+    symbol_c* variable(const char* name) { return keep(new symbolic_variable_c(keep(new identifier_c(name)))); }
+
+    symbol_c* string_value(const char* value) { return keep(new single_byte_character_string_c(value)); }
+
+    // evaluate a call, with every parameter declared with the same type
+    bool evaluate(function_declaration_c* function, std::vector<symbol_c*> values, symbol_c* param_type) {
+        result_ = const_value_c();
+        return evaluate_standard_function(function, values, std::vector<symbol_c*>(values.size(), param_type), result_);
+    }
+
+    int_type_name_c int_type_;
+    dint_type_name_c dint_type_;
+    uint_type_name_c uint_type_;
+    byte_type_name_c byte_type_;
+    real_type_name_c real_type_;
+    lreal_type_name_c lreal_type_;
+    string_type_name_c string_type_;
+    const_value_c result_;
+
+private:
+    template<typename T>
+    T* keep(T* symbol) {
+        nodes_.emplace_back(symbol);
+        return symbol;
+    }
+
+    std::vector<std::unique_ptr<symbol_c>> nodes_;
+};
+
+} // namespace
+
+TEST_F(StandardFunctionEvaluatorsTest, NumericalFunctions) {
+    // SQRT(2.0) of the REAL overload is computed with float precision
+    ASSERT_TRUE(evaluate(function("SQRT", &real_type_), {real_value(2.0)}, &real_type_));
+    EXPECT_EQ(result_.m_real64.get(), (double)(float)1.41421356237309504880);
+    ASSERT_TRUE(evaluate(function("SQRT", &lreal_type_), {real_value(2.0)}, &lreal_type_));
+    EXPECT_DOUBLE_EQ(result_.m_real64.get(), 1.41421356237309504880);
+    EXPECT_FALSE(result_.m_int64.is_valid());
+
+    // FUNCTION EXPT : LREAL VAR_INPUT IN1 : LREAL; IN2 : INT; END_VAR
+    std::vector<symbol_c*> values = {real_value(10.0), int_value(3)};
+    ASSERT_TRUE(evaluate_standard_function(function("EXPT", &lreal_type_), values, {&lreal_type_, &int_type_}, result_));
+    EXPECT_DOUBLE_EQ(result_.m_real64.get(), 1000.0);
+
+    EXPECT_TRUE(evaluate(function("ABS", &int_type_), {int_value(-5)}, &int_type_));
+    EXPECT_EQ(result_.m_int64.get(), 5);
+    // SQRT(-1.0) is not a number
+    EXPECT_FALSE(evaluate(function("SQRT", &lreal_type_), {real_value(-1.0)}, &lreal_type_));
+}
+
+TEST_F(StandardFunctionEvaluatorsTest, TypeConversions) {
+    ASSERT_TRUE(evaluate(function("INT_TO_REAL", &real_type_), {int_value(100)}, &int_type_));
+    EXPECT_EQ(result_.m_real64.get(), 100.0);
+    // REAL to integer conversions round half to even
+    ASSERT_TRUE(evaluate(function("REAL_TO_INT", &int_type_), {real_value(2.5)}, &real_type_));
+    EXPECT_EQ(result_.m_int64.get(), 2);
+    ASSERT_TRUE(evaluate(function("REAL_TO_INT", &int_type_), {real_value(3.5)}, &real_type_));
+    EXPECT_EQ(result_.m_int64.get(), 4);
+    // ...and wrap around, as a C cast does
+    ASSERT_TRUE(evaluate(function("DINT_TO_INT", &int_type_), {int_value(70000)}, &dint_type_));
+    EXPECT_EQ(result_.m_int64.get(), 70000 - 65536);
+    ASSERT_TRUE(evaluate(function("TRUNC", &int_type_), {real_value(-2.7)}, &lreal_type_));
+    EXPECT_EQ(result_.m_int64.get(), -2);
+}
+
+TEST_F(StandardFunctionEvaluatorsTest, BitShifts) {
+    // FUNCTION SHL : BYTE VAR_INPUT IN : BYTE; N : UINT; END_VAR
+    std::vector<symbol_c*> types = {&byte_type_, &uint_type_};
+    ASSERT_TRUE(evaluate_standard_function(function("SHL", &byte_type_), {int_value(1), int_value(4)}, types, result_));
+    EXPECT_EQ(result_.m_uint64.get(), 16u);
+    ASSERT_TRUE(evaluate_standard_function(function("ROL", &byte_type_), {int_value(0x81), int_value(1)}, types, result_));
+    EXPECT_EQ(result_.m_uint64.get(), 0x03u);
+    // shifting by more bits than the value has is undefined behaviour in C
+    EXPECT_FALSE(evaluate_standard_function(function("SHL", &byte_type_), {int_value(1), int_value(8)}, types, result_));
+}
+
+TEST_F(StandardFunctionEvaluatorsTest, SelectionFunctions) {
+    ASSERT_TRUE(evaluate(function("MAX", &int_type_), {int_value(3), int_value(7), int_value(5)}, &int_type_));
+    EXPECT_EQ(result_.m_int64.get(), 7);
+    ASSERT_TRUE(evaluate(function("MIN_INT", &int_type_), {int_value(3), int_value(-7), int_value(5)}, &int_type_));
+    EXPECT_EQ(result_.m_int64.get(), -7);
+    ASSERT_TRUE(evaluate(function("LIMIT", &int_type_), {int_value(0), int_value(12), int_value(10)}, &int_type_));
+    EXPECT_EQ(result_.m_int64.get(), 10);
+    ASSERT_TRUE(evaluate(function("MUX", &int_type_), {int_value(1), int_value(10), int_value(20)}, &int_type_));
+    EXPECT_EQ(result_.m_int64.get(), 20);
+    // MUX with K out of range only sets ENO to FALSE at run time
+    EXPECT_FALSE(evaluate(function("MUX", &int_type_), {int_value(2), int_value(10), int_value(20)}, &int_type_));
+    // LIMIT has exactly 3 parameters
+    EXPECT_FALSE(evaluate(function("LIMIT", &int_type_), {int_value(0), int_value(12)}, &int_type_));
+}
+
+TEST_F(StandardFunctionEvaluatorsTest, StringLength) {
+    // FUNCTION LEN : INT VAR_INPUT IN : STRING; END_VAR
+    std::vector<symbol_c*> types = {&string_type_};
+    ASSERT_TRUE(evaluate_standard_function(function("LEN", &int_type_), {string_value("'abc'")}, types, result_));
+    EXPECT_EQ(result_.m_int64.get(), 3);
+    ASSERT_TRUE(evaluate_standard_function(function("LEN", &int_type_), {string_value("'a$'$41$N'")}, types, result_));
+    EXPECT_EQ(result_.m_int64.get(), 4);
+}
+
+TEST_F(StandardFunctionEvaluatorsTest, OtherFunctionsAreNotEvaluated) {
+    // user defined functions whose names look like the name of a standard function
+    EXPECT_FALSE(evaluate(function("MAX_SPEED", &int_type_), {int_value(3), int_value(7)}, &int_type_));
+    EXPECT_FALSE(evaluate(function("SPEED_TO_RPM", &int_type_), {int_value(3)}, &int_type_));
+    // non constant parameters
+    EXPECT_FALSE(evaluate(function("MAX", &int_type_), {int_value(3), variable("X")}, &int_type_));
+}
+
+TEST_F(StandardFunctionEvaluatorsTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
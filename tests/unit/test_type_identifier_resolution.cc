@@ -0,0 +1,78 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the resolution of type identifiers done by absyntax_utils_init().
+ */
+
+#include <gtest/gtest.h>
+
+#include "absyntax_utils/absyntax_utils.hh"
+
+namespace {
+
+class TypeIdentifierResolutionTest : public ::testing::Test {
+protected:
+    void TearDown() override { absyntax_utils_reset(); }
+};
+
+} // namespace
+
+TEST_F(TypeIdentifierResolutionTest, LinksIdentifiersToTheirDeclarations) {
+    // TYPE MYINT : INT; END_TYPE
+    int_type_name_c int_type;
+    derived_datatype_identifier_c myint_name("MYINT");
+    simple_spec_init_c myint_spec(&int_type, nullptr);
+    simple_type_declaration_c myint_decl(&myint_name, &myint_spec);
+    type_declaration_list_c type_list(&myint_decl);
+    data_type_declaration_c data_types(&type_list);
+
+    // FUNCTION_BLOCK FB1 END_FUNCTION_BLOCK
+    poutype_identifier_c fb_name("FB1");
+    var_declarations_list_c fb_vars;
+    function_block_declaration_c fb_decl(&fb_name, &fb_vars, nullptr);
+
+    // references to the above, as they would appear in variable declarations
+    derived_datatype_identifier_c myint_ref("myint");
+    poutype_identifier_c fb_ref("fb1");
+    poutype_identifier_c function_ref("SOME_FUNCTION");
+
+    library_c library;
+    library.add_element(&data_types);
+    library.add_element(&fb_decl);
+    library.add_element(&myint_ref);
+    library.add_element(&fb_ref);
+    library.add_element(&function_ref);
+
+    EXPECT_EQ(myint_ref.decl, nullptr);
+    absyntax_utils_init(&library);
+
+    EXPECT_EQ(myint_ref.decl, &myint_spec);
+    EXPECT_EQ(fb_ref.decl, &fb_decl);
+    EXPECT_EQ(function_ref.decl, nullptr);
+
+    EXPECT_EQ(search_base_type_c::get_basetype_decl(&myint_ref), &int_type);
+    EXPECT_EQ(search_base_type_c::get_basetype_decl(&fb_ref), &fb_decl);
+}
+
+TEST_F(TypeIdentifierResolutionTest, UnresolvedIdentifiersStillUseTheSymbolTables) {
+    int_type_name_c int_type;
+    derived_datatype_identifier_c myint_name("MYINT");
+    simple_spec_init_c myint_spec(&int_type, nullptr);
+    simple_type_declaration_c myint_decl(&myint_name, &myint_spec);
+    type_declaration_list_c type_list(&myint_decl);
+    data_type_declaration_c data_types(&type_list);
+    library_c library(&data_types);
+    absyntax_utils_init(&library);
+
+    // created after absyntax_utils_init(), e.g. by a later stage
+    derived_datatype_identifier_c late_ref("MyInt");
+    EXPECT_EQ(late_ref.decl, nullptr);
+    EXPECT_EQ(search_base_type_c::get_basetype_decl(&late_ref), &int_type);
+}
+
+TEST_F(TypeIdentifierResolutionTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}
@@ -20,6 +20,27 @@ TEST(TypeRegistryTest, LookupRegisteredType) {
     EXPECT_EQ(found->name(), "MyType");
 }
 
+TEST(TypeRegistryTest, TypesAreInterned) {
+    matiec::types::TypeRegistry registry;
+
+    const auto int_id = registry.findTypeId("Int");
+    ASSERT_NE(int_id, matiec::types::kNoType);
+    EXPECT_EQ(registry.type(int_id), registry.getInt().get());
+    EXPECT_EQ(registry.idOf(registry.getInt().get()), int_id);
+    // aliases share the id of the type they name
+    EXPECT_EQ(registry.findTypeId("tod"), registry.findTypeId("TIME_OF_DAY"));
+    EXPECT_EQ(registry.findTypeId("NOT_A_TYPE"), matiec::types::kNoType);
+    EXPECT_EQ(registry.type(matiec::types::kNoType), nullptr);
+
+    // interning the same type twice keeps its first id
+    auto custom = std::make_shared<matiec::types::StructType>(
+        "MyType", std::vector<matiec::types::StructType::Field>{});
+    const auto custom_id = registry.intern(custom);
+    EXPECT_EQ(registry.intern(custom), custom_id);
+    registry.registerType("MyType", custom);
+    EXPECT_EQ(registry.findTypeId("MYTYPE"), custom_id);
+}
+
 TEST(TypeRegistryTest, IntegerAssignability) {
     matiec::types::TypeRegistry registry;
 
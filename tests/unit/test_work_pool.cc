@@ -0,0 +1,110 @@
+/*
+ *  matiec - a compiler for the programming languages defined in IEC 61131-3
+ *
+ *  Unit tests for the worker pool used to analyse the POUs in parallel,
+ *  and for the buffering of the stage3 diagnostics.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "absyntax_utils/absyntax_utils.hh"
+#include "stage3/stage3_diagnostics.hh"
+#include "util/work_pool.hh"
+
+TEST(WorkPoolTest, RunsEveryTaskExactlyOnce) {
+    matiec::work_pool_c pool(4);
+    std::vector<std::atomic<int>> calls(500);
+    for (int round = 0; round < 3; round++) {
+        pool.run(calls.size(), [&](size_t i) { calls[i]++; });
+    }
+    for (const std::atomic<int>& count : calls) EXPECT_EQ(count.load(), 3);
+    EXPECT_EQ(pool.failed_task(), matiec::work_pool_c::no_failed_task);
+}
+
+TEST(WorkPoolTest, BackToBackRunsDoNotShareTasks) {
+    // workers waking up late for a completed run must not pick up the tasks of the next one
+    matiec::work_pool_c pool(4);
+    for (size_t round = 0; round < 2000; round++) {
+        const size_t count = 2 + round % 5;
+        std::vector<std::atomic<int>> calls(count);
+        pool.run(count, [&](size_t i) { calls[i]++; });
+        for (const std::atomic<int>& calls_of_task : calls) ASSERT_EQ(calls_of_task.load(), 1) << "round " << round;
+    }
+}
+
+TEST(WorkPoolTest, SingleJobRunsTasksInOrder) {
+    matiec::work_pool_c pool(1);
+    std::vector<size_t> order;
+    pool.run(5, [&](size_t i) { order.push_back(i); });
+    EXPECT_EQ(order, (std::vector<size_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(WorkPoolTest, RethrowsExceptionOfFirstFailingTask) {
+    for (unsigned int jobs : {1u, 4u}) {
+        matiec::work_pool_c pool(jobs);
+        std::atomic<int> completed{0};
+        try {
+            pool.run(100, [&](size_t i) {
+                if ((i == 30) || (i == 70)) throw std::runtime_error(std::to_string(i));
+                completed++;
+            });
+            FAIL() << "expected an exception";
+        } catch (const std::runtime_error& e) {
+            EXPECT_STREQ(e.what(), "30");
+        }
+        EXPECT_EQ(pool.failed_task(), 30u);
+        if (jobs > 1) {
+            EXPECT_EQ(completed.load(), 98);  // the other tasks still ran
+        }
+
+        // the pool remains usable
+        pool.run(10, [&](size_t) { completed++; });
+        EXPECT_EQ(pool.failed_task(), matiec::work_pool_c::no_failed_task);
+    }
+}
+
+TEST(WorkPoolTest, SharedPoolIsReusedForTheSameNumberOfJobs) {
+    matiec::work_pool_c& pool = matiec::work_pool_c::shared(3);
+    EXPECT_EQ(pool.jobs(), 3u);
+    EXPECT_EQ(&matiec::work_pool_c::shared(3), &pool);
+    EXPECT_EQ(matiec::work_pool_c::shared(0).jobs(), 1u);
+}
+
+TEST(WorkPoolTest, BufferedDiagnosticsAreReportedOnFlush) {
+    matiec::resetGlobalErrorReporter();
+    symbol_c first, second;
+    first.first_order = 1;
+    second.first_order = 2;
+
+    matiec::stage3::diagnostic_buffer_c buffer;
+    {
+        matiec::stage3::scoped_diagnostic_buffer_c scope(&buffer);
+        matiec::stage3::report_error(matiec::ErrorCategory::Semantic, &second, &second, "second");
+        matiec::stage3::report_warning(matiec::ErrorCategory::Semantic, &first, &first, "first");
+    }
+    EXPECT_EQ(matiec::stage3::current_diagnostic_buffer(), nullptr);
+    EXPECT_FALSE(buffer.empty());
+    EXPECT_EQ(matiec::globalErrorReporter().errorCount(), 0);
+
+    buffer.flush();
+    EXPECT_TRUE(buffer.empty());
+    const std::vector<matiec::CompilerError>& errors = matiec::globalErrorReporter().errors();
+    ASSERT_EQ(errors.size(), 2u);
+    EXPECT_EQ(errors[0].message(), "second");
+    EXPECT_EQ(errors[1].message(), "first");
+    EXPECT_EQ(matiec::globalErrorReporter().errorCount(), 1);
+    EXPECT_EQ(matiec::globalErrorReporter().warningCount(), 1);
+    matiec::resetGlobalErrorReporter();
+}
+
+TEST(WorkPoolTest, LinkerAnchorsRuntimeOptionsForStaticArchives) {
+    // Ensure libmatiec object defining error_exit/runtime_options is linked.
+    volatile bool anchor = runtime_options.relaxed_datatype_model;
+    (void)anchor;
+    SUCCEED();
+}